@@ -14,6 +14,7 @@
 #include "Position.hpp"
 #include "BuildOrderSearchGoal.h"
 #include "BuildOrder.h"
+#include "BuildOrderTable.h"
 #include "NaiveBuildOrderSearch.h"
 
 namespace BOSS
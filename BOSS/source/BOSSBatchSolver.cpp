@@ -0,0 +1,208 @@
+#include "BOSSBatchSolver.h"
+
+#include <algorithm>
+
+#if !defined(EMSCRIPTEN)
+    #include <atomic>
+    #include <mutex>
+    #include <thread>
+#endif
+
+using namespace BOSS;
+
+BOSSBatchSolver::BOSSBatchSolver(const std::vector<std::string> & jobFiles, const double timeLimitMS, const size_t numThreads)
+    : _timeLimitMS(timeLimitMS)
+    , _numThreads(numThreads)
+{
+    for (size_t i(0); i < jobFiles.size(); ++i)
+    {
+        readJobs(jobFiles[i]);
+    }
+}
+
+void BOSSBatchSolver::readJobs(const std::string & filename)
+{
+    std::ifstream fin(filename.c_str());
+    BOSS_ASSERT(fin.is_open(), "Could not open jobs file: %s", filename.c_str());
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(fin, line))
+    {
+        ++lineNumber;
+        if (line.find('{') == std::string::npos)
+        {
+            continue;
+        }
+
+        rapidjson::Document document;
+        JSONTools::ParseJSONString(document, line);
+
+        BOSS_ASSERT(document.HasMember("state") && document["state"].IsObject(), "Job %s:%d has no 'state'", filename.c_str(), lineNumber);
+        BOSS_ASSERT(document.HasMember("goal") && document["goal"].IsObject(), "Job %s:%d has no 'goal'", filename.c_str(), lineNumber);
+
+        Job job;
+        std::stringstream name;
+        name << filename << ":" << lineNumber;
+        job.name = document.HasMember("name") && document["name"].IsString() ? document["name"].GetString() : name.str();
+        job.state = JSONTools::GetGameState(document["state"]);
+        job.goal = JSONTools::GetBuildOrderSearchGoal(document["goal"]);
+        job.timeLimitMS = document.HasMember("timeLimitMS") && document["timeLimitMS"].IsInt() ? document["timeLimitMS"].GetInt() : _timeLimitMS;
+
+        BOSS_ASSERT(job.state.getRace() == Races::GetRaceID(document["goal"]["race"].GetString()), "Job %s has a goal for another race", job.name.c_str());
+
+        _jobs.push_back(job);
+    }
+}
+
+void BOSSBatchSolver::solve(Job & job) const
+{
+    Timer timer;
+    timer.start();
+
+    try
+    {
+        DFBB_BuildOrderSmartSearch search(job.state.getRace());
+        search.setState(job.state);
+        search.setGoal(job.goal);
+        search.setTimeLimit((int)job.timeLimitMS);
+        search.search();
+
+        const DFBB_BuildOrderSearchResults & results = search.getResults();
+        job.buildOrder = results.buildOrder;
+        job.optimal = results.solved;
+
+        // solved without a solution means nothing beat the naive build order
+        if (job.buildOrder.empty())
+        {
+            NaiveBuildOrderSearch naive(job.state, job.goal);
+            job.buildOrder = naive.solve();
+            job.optimal = results.solved && !results.solutionFound;
+        }
+
+        if (!job.buildOrder.empty() && job.buildOrder.isLegalFromState(job.state))
+        {
+            job.makespan = job.buildOrder.getCompletionTime(job.state) - job.state.getCurrentFrame();
+            job.solved = true;
+        }
+    }
+    catch (const BOSSException & e)
+    {
+        job.error = e.what();
+    }
+
+    job.searchMS = timer.getElapsedTimeInMilliSec();
+}
+
+void BOSSBatchSolver::printJob(const Job & job) const
+{
+    std::cout << job.name << " " << (job.solved ? (job.optimal ? "optimal" : "best found") : "unsolved")
+              << " makespan " << job.makespan << " bo " << job.buildOrder.size() << " " << job.searchMS << "ms";
+
+    if (!job.error.empty())
+    {
+        std::cout << " error: " << job.error;
+    }
+
+    std::cout << "\n";
+}
+
+// The first job of each race runs alone, so that the function-local statics in the search
+// are initialized before any threads start; VS2013 does not make their initialization thread safe.
+// The naive search runs only when DFBB finds nothing, so it is also run once here for its statics.
+void BOSSBatchSolver::run()
+{
+    std::cout << "\nSolving " << _jobs.size() << " build order jobs\n\n";
+
+    std::vector<bool> done(_jobs.size(), false);
+    for (RaceID r(0); r < Races::NUM_RACES; ++r)
+    {
+        for (size_t j(0); j < _jobs.size(); ++j)
+        {
+            if (_jobs[j].state.getRace() == r)
+            {
+                solve(_jobs[j]);
+                printJob(_jobs[j]);
+                done[j] = true;
+
+                try
+                {
+                    NaiveBuildOrderSearch(_jobs[j].state, _jobs[j].goal).solve();
+                }
+                catch (const BOSSException &)
+                {
+                    // the job itself reported any error
+                }
+                break;
+            }
+        }
+    }
+
+#if !defined(EMSCRIPTEN)
+    std::atomic<size_t> nextJob(0);
+    std::mutex printMutex;
+
+    std::vector<std::thread> threads;
+    const size_t numThreads = std::max<size_t>(1, _numThreads ? _numThreads : std::thread::hardware_concurrency());
+    for (size_t t(0); t < numThreads; ++t)
+    {
+        threads.push_back(std::thread([this, &done, &nextJob, &printMutex]()
+        {
+            for (size_t j = nextJob++; j < _jobs.size(); j = nextJob++)
+            {
+                if (done[j])
+                {
+                    continue;
+                }
+
+                solve(_jobs[j]);
+
+                std::lock_guard<std::mutex> lock(printMutex);
+                printJob(_jobs[j]);
+            }
+        }));
+    }
+
+    for (size_t t(0); t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+#else
+    for (size_t j(0); j < _jobs.size(); ++j)
+    {
+        if (done[j])
+        {
+            continue;
+        }
+
+        solve(_jobs[j]);
+        printJob(_jobs[j]);
+    }
+#endif
+
+    size_t solved = 0;
+    size_t optimal = 0;
+    for (size_t j(0); j < _jobs.size(); ++j)
+    {
+        solved += _jobs[j].solved ? 1 : 0;
+        optimal += _jobs[j].solved && _jobs[j].optimal ? 1 : 0;
+    }
+
+    std::cout << "\nSolved " << solved << " of " << _jobs.size() << " jobs, " << optimal << " optimal\n";
+}
+
+bool BOSSBatchSolver::writeTable(const std::string & filename) const
+{
+    BuildOrderTable table;
+    for (size_t j(0); j < _jobs.size(); ++j)
+    {
+        if (_jobs[j].solved)
+        {
+            table.add(_jobs[j].state, _jobs[j].goal, _jobs[j].buildOrder, _jobs[j].makespan, _jobs[j].optimal);
+        }
+    }
+
+    const bool written = table.save(filename);
+    std::cout << (written ? "Wrote " : "Could not write ") << table.size() << " build orders to " << filename << "\n";
+    return written;
+}
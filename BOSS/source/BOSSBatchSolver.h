@@ -0,0 +1,54 @@
+#pragma once
+
+#include "BOSS.h"
+#include "JSONTools.h"
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/document.h"
+
+namespace BOSS
+{
+
+// Solves many build order searches offline, in parallel, and saves the build orders as a
+// BuildOrderTable for the bot to load at startup.
+//
+// A jobs file has one job per line, in the same form as the cases the bot records:
+//   { "name" : "...", "state" : state, "goal" : goal, "timeLimitMS" : 60000 }
+// The race comes from the state. A search that times out keeps its best build order so far,
+// marked as not optimal; a search with no build order at all falls back to the naive one.
+class BOSSBatchSolver
+{
+    class Job
+    {
+    public:
+        std::string             name;
+        GameState               state;
+        BuildOrderSearchGoal    goal;
+        double                  timeLimitMS;
+
+        bool                    solved;
+        bool                    optimal;
+        FrameCountType          makespan;
+        BuildOrder              buildOrder;
+        double                  searchMS;
+        std::string             error;
+
+        Job() : timeLimitMS(0), solved(false), optimal(false), makespan(0), searchMS(0) { }
+    };
+
+    std::vector<Job>            _jobs;
+    double                      _timeLimitMS;
+    size_t                      _numThreads;
+
+    void                        readJobs(const std::string & filename);
+    void                        solve(Job & job) const;
+    void                        printJob(const Job & job) const;
+
+public:
+
+    BOSSBatchSolver(const std::vector<std::string> & jobFiles, const double timeLimitMS, const size_t numThreads);
+
+    void run();
+    bool writeTable(const std::string & filename) const;
+};
+
+}
@@ -0,0 +1,474 @@
+#include "BOSSBenchmark.h"
+
+#include <memory>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+using namespace BOSS;
+
+namespace
+{
+    // Quote and escape a string for the JSON output, the same way the bot escapes the names
+    // in its case file. This version of rapidjson only writes an object or array at the root,
+    // so write a one element array and take off the brackets.
+    std::string QuoteJSON(const std::string & s)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartArray();
+        writer.String(s.c_str(), rapidjson::SizeType(s.size()));
+        writer.EndArray();
+
+        const std::string quoted(buffer.GetString());
+        return quoted.substr(1, quoted.size() - 2);
+    }
+}
+
+BOSSBenchmark::BOSSBenchmark(const std::vector<std::string> & corpusFiles, const std::string & outputFile)
+    : _searchTimeLimitMS(1000)
+    , _combatFrameLimit(4 * 60 * 24)
+    , _outputFile(outputFile)
+{
+    _searchTypes.push_back("DFBB");
+    _searchTypes.push_back("Naive");
+    _searchTypes.push_back("Integral");
+    _searchTypes.push_back("Bucket");
+    _searchTypes.push_back("BestResponse");
+
+    for (size_t i(0); i < corpusFiles.size(); ++i)
+    {
+        readCorpus(corpusFiles[i]);
+    }
+}
+
+// As an experiment in the BOSS config: "Corpus" is a file name or an array of them, and
+// "Output" is the results file. "SearchTypes" overrides the corpus.
+BOSSBenchmark::BOSSBenchmark(const std::string & name, const rapidjson::Value & val)
+    : _searchTimeLimitMS(1000)
+    , _combatFrameLimit(4 * 60 * 24)
+    , _outputFile(name + "_results.json")
+{
+    _searchTypes.push_back("DFBB");
+    _searchTypes.push_back("Naive");
+    _searchTypes.push_back("Integral");
+    _searchTypes.push_back("Bucket");
+    _searchTypes.push_back("BestResponse");
+
+    BOSS_ASSERT(val.HasMember("Corpus"), "Benchmark must have a 'Corpus' file or array of files");
+    const rapidjson::Value & corpus = val["Corpus"];
+    if (corpus.IsArray())
+    {
+        for (size_t i(0); i < corpus.Size(); ++i)
+        {
+            BOSS_ASSERT(corpus[i].IsString(), "Corpus element is not a string");
+            readCorpus(corpus[i].GetString());
+        }
+    }
+    else
+    {
+        BOSS_ASSERT(corpus.IsString(), "Corpus should be a string or an array of strings");
+        readCorpus(corpus.GetString());
+    }
+
+    if (val.HasMember("Output"))
+    {
+        BOSS_ASSERT(val["Output"].IsString(), "Output should be a string");
+        _outputFile = val["Output"].GetString();
+    }
+
+    if (val.HasMember("SearchTypes"))
+    {
+        BOSS_ASSERT(val["SearchTypes"].IsArray(), "SearchTypes should be an array");
+        _searchTypes.clear();
+        for (size_t i(0); i < val["SearchTypes"].Size(); ++i)
+        {
+            BOSS_ASSERT(val["SearchTypes"][i].IsString(), "SearchTypes element is not a string");
+            _searchTypes.push_back(val["SearchTypes"][i].GetString());
+        }
+    }
+}
+
+// A versioned corpus document, or else captured cases one per line.
+void BOSSBenchmark::readCorpus(const std::string & filename)
+{
+    const std::string json = JSONTools::ReadJsonFile(filename);
+
+    rapidjson::Document document;
+    document.Parse<0>(json.c_str());
+
+    if (!document.HasParseError() && document.IsObject() && document.HasMember("Cases"))
+    {
+        BOSS_ASSERT(document.HasMember("Version") && document["Version"].IsInt(), "Corpus %s has no 'Version' int", filename.c_str());
+
+        _corpusNames.push_back(document.HasMember("Name") && document["Name"].IsString() ? document["Name"].GetString() : filename);
+        _corpusVersions.push_back(document["Version"].GetInt());
+
+        if (document.HasMember("SearchTimeLimitMS") && document["SearchTimeLimitMS"].IsInt())
+        {
+            _searchTimeLimitMS = document["SearchTimeLimitMS"].GetInt();
+        }
+
+        if (document.HasMember("CombatFrameLimit") && document["CombatFrameLimit"].IsInt())
+        {
+            _combatFrameLimit = document["CombatFrameLimit"].GetInt();
+        }
+
+        if (document.HasMember("SearchTypes") && document["SearchTypes"].IsArray())
+        {
+            _searchTypes.clear();
+            for (size_t i(0); i < document["SearchTypes"].Size(); ++i)
+            {
+                BOSS_ASSERT(document["SearchTypes"][i].IsString(), "SearchTypes element is not a string");
+                _searchTypes.push_back(document["SearchTypes"][i].GetString());
+            }
+        }
+
+        const rapidjson::Value & cases = document["Cases"];
+        BOSS_ASSERT(cases.IsArray(), "Corpus 'Cases' is not an array");
+        for (size_t i(0); i < cases.Size(); ++i)
+        {
+            std::stringstream name;
+            name << _corpusNames.back() << "#" << i;
+            _cases.push_back(readCase(cases[i], name.str()));
+        }
+
+        return;
+    }
+
+    // captured cases have no version
+    _corpusNames.push_back(filename);
+    _corpusVersions.push_back(0);
+
+    std::ifstream fin(filename.c_str());
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(fin, line))
+    {
+        ++lineNumber;
+        if (line.find('{') == std::string::npos)
+        {
+            continue;
+        }
+
+        rapidjson::Document caseDocument;
+        JSONTools::ParseJSONString(caseDocument, line);
+
+        std::stringstream name;
+        name << filename << ":" << lineNumber;
+        _cases.push_back(readCase(caseDocument, name.str()));
+    }
+}
+
+BOSSBenchmark::Case BOSSBenchmark::readCase(const rapidjson::Value & val, const std::string & defaultName) const
+{
+    BOSS_ASSERT(val.IsObject(), "Benchmark case %s is not an object", defaultName.c_str());
+    BOSS_ASSERT(val.HasMember("state") && val["state"].IsObject(), "Benchmark case %s has no 'state'", defaultName.c_str());
+    BOSS_ASSERT(val.HasMember("goal") && val["goal"].IsObject(), "Benchmark case %s has no 'goal'", defaultName.c_str());
+
+    Case c;
+    c.name = val.HasMember("name") && val["name"].IsString() ? val["name"].GetString() : defaultName;
+    c.state = JSONTools::GetGameState(val["state"]);
+    c.goal = JSONTools::GetBuildOrderSearchGoal(val["goal"]);
+    c.timeLimitMS = _searchTimeLimitMS;
+
+    if (val.HasMember("timeLimitMS") && val["timeLimitMS"].IsInt())
+    {
+        c.timeLimitMS = val["timeLimitMS"].GetInt();
+    }
+
+    if (val.HasMember("enemyState") && val.HasMember("enemyBuildOrder"))
+    {
+        c.hasEnemy = true;
+        c.enemyState = JSONTools::GetGameState(val["enemyState"]);
+        c.enemyBuildOrder = JSONTools::GetBuildOrder(val["enemyBuildOrder"]);
+    }
+
+    return c;
+}
+
+void BOSSBenchmark::run()
+{
+    std::cout << "\nBenchmark: " << _cases.size() << " cases, " << _searchTypes.size() << " search types\n\n";
+
+    for (size_t c(0); c < _cases.size(); ++c)
+    {
+        for (size_t s(0); s < _searchTypes.size(); ++s)
+        {
+            const std::string & searchType = _searchTypes[s];
+            Result result;
+
+            if (searchType.compare("DFBB") == 0)
+            {
+                result = runDFBB(_cases[c]);
+            }
+            else if (searchType.compare("Naive") == 0)
+            {
+                result = runNaive(_cases[c]);
+            }
+            else
+            {
+                result = runCombatSearch(_cases[c], searchType);
+            }
+
+            if (result.ran)
+            {
+                printResult(result);
+                _results.push_back(result);
+            }
+        }
+    }
+
+    writeResults();
+}
+
+BOSSBenchmark::Result BOSSBenchmark::runDFBB(const Case & c) const
+{
+    Result result;
+    result.caseName = c.name;
+    result.searchType = "DFBB";
+    result.ran = true;
+
+    Timer wallTimer;
+    wallTimer.start();
+
+    try
+    {
+        DFBB_BuildOrderSmartSearch search(c.state.getRace());
+        search.setState(c.state);
+        search.setGoal(c.goal);
+        search.setTimeLimit((int)c.timeLimitMS);
+        search.search();
+
+        const DFBB_BuildOrderSearchResults & results = search.getResults();
+        result.solved = results.solved;
+        result.timedOut = results.timedOut;
+        result.nodes = results.nodesExpanded;
+        result.searchMS = results.timeElapsed;
+        setMakespan(result, c.state, results.buildOrder);
+    }
+    catch (const BOSSException & e)
+    {
+        result.error = e.what();
+    }
+
+    result.wallMS = wallTimer.getElapsedTimeInMilliSec();
+    return result;
+}
+
+// The naive search expands no nodes; it is here as the makespan to beat.
+BOSSBenchmark::Result BOSSBenchmark::runNaive(const Case & c) const
+{
+    Result result;
+    result.caseName = c.name;
+    result.searchType = "Naive";
+    result.ran = true;
+
+    Timer wallTimer;
+    wallTimer.start();
+
+    try
+    {
+        NaiveBuildOrderSearch search(c.state, c.goal);
+        const BuildOrder buildOrder = search.solve();
+        result.searchMS = wallTimer.getElapsedTimeInMilliSec();
+        result.solved = true;
+        setMakespan(result, c.state, buildOrder);
+    }
+    catch (const BOSSException & e)
+    {
+        result.error = e.what();
+    }
+
+    result.wallMS = wallTimer.getElapsedTimeInMilliSec();
+    return result;
+}
+
+// The combat searches choose from every action of the race, limited by the goal's maximums.
+BOSSBenchmark::Result BOSSBenchmark::runCombatSearch(const Case & c, const std::string & searchType) const
+{
+    Result result;
+    result.caseName = c.name;
+    result.searchType = searchType;
+
+    if (searchType.compare("BestResponse") == 0 && !c.hasEnemy)
+    {
+        return result;
+    }
+
+    result.ran = true;
+
+    Timer wallTimer;
+    wallTimer.start();
+
+    try
+    {
+        CombatSearchParameters params;
+        params.setInitialState(c.state);
+        params.setFrameTimeLimit(c.state.getCurrentFrame() + _combatFrameLimit);
+        params.setSearchTimeLimit(c.timeLimitMS);
+
+        ActionSet relevantActions;
+        const std::vector<ActionType> & allActions = ActionTypes::GetAllActionTypes(c.state.getRace());
+        for (size_t a(0); a < allActions.size(); ++a)
+        {
+            relevantActions.add(allActions[a]);
+            if (c.goal.getGoalMax(allActions[a]) > 0)
+            {
+                params.setMaxActions(allActions[a], c.goal.getGoalMax(allActions[a]));
+            }
+        }
+        params.setRelevantActions(relevantActions);
+
+        std::shared_ptr<CombatSearch> combatSearch;
+        if (searchType.compare("Integral") == 0)
+        {
+            combatSearch = std::shared_ptr<CombatSearch>(new CombatSearch_Integral(params));
+        }
+        else if (searchType.compare("Bucket") == 0)
+        {
+            combatSearch = std::shared_ptr<CombatSearch>(new CombatSearch_Bucket(params));
+        }
+        else if (searchType.compare("BestResponse") == 0)
+        {
+            params.setEnemyInitialState(c.enemyState);
+            params.setEnemyBuildOrder(c.enemyBuildOrder);
+            combatSearch = std::shared_ptr<CombatSearch>(new CombatSearch_BestResponse(params));
+        }
+        else
+        {
+            BOSS_ASSERT(false, "Benchmark search type not found: %s", searchType.c_str());
+        }
+
+        combatSearch->search();
+
+        const CombatSearchResults & results = combatSearch->getResults();
+        result.solved = results.solved;
+        result.timedOut = results.timedOut;
+        result.nodes = results.nodesExpanded;
+        result.searchMS = results.timeElapsed;
+    }
+    catch (const BOSSException & e)
+    {
+        result.error = e.what();
+    }
+
+    result.wallMS = wallTimer.getElapsedTimeInMilliSec();
+    return result;
+}
+
+// An empty build order makes no claim about the makespan, unless the goal is already met.
+void BOSSBenchmark::setMakespan(Result & result, const GameState & state, const BuildOrder & buildOrder) const
+{
+    result.buildOrderSize = buildOrder.size();
+
+    if (buildOrder.empty())
+    {
+        if (result.solved)
+        {
+            result.makespan = 0;
+        }
+        return;
+    }
+
+    if (!buildOrder.isLegalFromState(state))
+    {
+        result.error = "build order is not legal from the start state";
+        return;
+    }
+
+    result.makespan = buildOrder.getCompletionTime(state) - state.getCurrentFrame();
+}
+
+void BOSSBenchmark::printResult(const Result & result) const
+{
+    const double nodesPerSec = result.searchMS > 0 ? 1000.0 * result.nodes / result.searchMS : 0;
+
+    std::cout << result.caseName << " [" << result.searchType << "] "
+              << (result.solved ? "solved" : (result.timedOut ? "timeout" : "unsolved"))
+              << " nodes " << result.nodes
+              << " @ " << (unsigned long long)nodesPerSec << " nodes/sec"
+              << " makespan " << result.makespan
+              << " bo " << result.buildOrderSize
+              << " wall " << result.wallMS << "ms";
+
+    if (!result.error.empty())
+    {
+        std::cout << " error: " << result.error;
+    }
+
+    std::cout << "\n";
+}
+
+void BOSSBenchmark::writeResults() const
+{
+    std::stringstream ss;
+    ss << "{\n  \"Corpus\" : [";
+    for (size_t i(0); i < _corpusNames.size(); ++i)
+    {
+        ss << (i ? ", " : "") << "{\"Name\" : " << QuoteJSON(_corpusNames[i]) << ", \"Version\" : " << _corpusVersions[i] << "}";
+    }
+    ss << "],\n  \"SearchTimeLimitMS\" : " << _searchTimeLimitMS;
+    ss << ",\n  \"CombatFrameLimit\" : " << _combatFrameLimit;
+
+    ss << ",\n  \"Results\" : [";
+    for (size_t i(0); i < _results.size(); ++i)
+    {
+        const Result & r = _results[i];
+        ss << (i ? ",\n" : "\n") << "    {";
+        ss << "\"case\" : " << QuoteJSON(r.caseName);
+        ss << ", \"search\" : " << QuoteJSON(r.searchType);
+        ss << ", \"solved\" : " << (r.solved ? "true" : "false");
+        ss << ", \"timedOut\" : " << (r.timedOut ? "true" : "false");
+        ss << ", \"nodes\" : " << r.nodes;
+        ss << ", \"nodesPerSec\" : " << (r.searchMS > 0 ? 1000.0 * r.nodes / r.searchMS : 0);
+        ss << ", \"makespan\" : " << r.makespan;
+        ss << ", \"buildOrderSize\" : " << r.buildOrderSize;
+        ss << ", \"searchMS\" : " << r.searchMS;
+        ss << ", \"wallMS\" : " << r.wallMS;
+        if (!r.error.empty())
+        {
+            ss << ", \"error\" : " << QuoteJSON(r.error);
+        }
+        ss << "}";
+    }
+
+    // per search type: how many solved, how many nodes in how long
+    ss << "\n  ],\n  \"Totals\" : [";
+    for (size_t s(0); s < _searchTypes.size(); ++s)
+    {
+        size_t runs = 0;
+        size_t solved = 0;
+        unsigned long long nodes = 0;
+        double searchMS = 0;
+        double wallMS = 0;
+        for (size_t i(0); i < _results.size(); ++i)
+        {
+            if (_results[i].searchType == _searchTypes[s])
+            {
+                ++runs;
+                solved += _results[i].solved ? 1 : 0;
+                nodes += _results[i].nodes;
+                searchMS += _results[i].searchMS;
+                wallMS += _results[i].wallMS;
+            }
+        }
+
+        ss << (s ? ",\n" : "\n") << "    {";
+        ss << "\"search\" : " << QuoteJSON(_searchTypes[s]);
+        ss << ", \"runs\" : " << runs;
+        ss << ", \"solved\" : " << solved;
+        ss << ", \"nodes\" : " << nodes;
+        ss << ", \"nodesPerSec\" : " << (searchMS > 0 ? 1000.0 * nodes / searchMS : 0);
+        ss << ", \"searchMS\" : " << searchMS;
+        ss << ", \"wallMS\" : " << wallMS;
+        ss << "}";
+    }
+    ss << "\n  ]\n}\n";
+
+    std::ofstream fout(_outputFile.c_str());
+    BOSS_ASSERT(fout.is_open(), "Could not write benchmark results: %s", _outputFile.c_str());
+    fout << ss.str();
+
+    std::cout << "\nWrote " << _outputFile << "\n";
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "BOSS.h"
+#include "JSONTools.h"
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/document.h"
+
+namespace BOSS
+{
+
+// Runs the searches over a fixed corpus of (start state, goal) cases and writes the
+// nodes/sec, nodes to solve, makespan and time of each run as JSON, so that a change
+// to the search can be measured against the same problems every time.
+//
+// A corpus file is either a versioned corpus document:
+//   { "Name" : "...", "Version" : 1, "SearchTimeLimitMS" : 3000, "CombatFrameLimit" : 5760,
+//     "SearchTypes" : ["DFBB", "Naive", "Integral", "Bucket", "BestResponse"],
+//     "Cases" : [ case, ... ] }
+// or a file of cases captured by the bot, one case per line.
+// A case is
+//   { "name" : "...", "state" : state, "goal" : goal,
+//     "enemyState" : state, "enemyBuildOrder" : [...], "timeLimitMS" : 1000 }
+// with state and goal in the JSONTools form. The enemy is only needed for BestResponse.
+// The combat searches maximize army value up to the frame limit, so they have no makespan.
+class BOSSBenchmark
+{
+    class Case
+    {
+    public:
+        std::string             name;
+        GameState               state;
+        BuildOrderSearchGoal    goal;
+        bool                    hasEnemy;
+        GameState               enemyState;
+        BuildOrder              enemyBuildOrder;
+        double                  timeLimitMS;
+
+        Case() : hasEnemy(false), timeLimitMS(0) { }
+    };
+
+    class Result
+    {
+    public:
+        std::string             caseName;
+        std::string             searchType;
+        bool                    ran;
+        bool                    solved;
+        bool                    timedOut;
+        unsigned long long      nodes;
+        double                  searchMS;
+        double                  wallMS;
+        int                     makespan;       // frames from the start state, -1 if there is none
+        size_t                  buildOrderSize;
+        std::string             error;
+
+        Result() : ran(false), solved(false), timedOut(false), nodes(0), searchMS(0), wallMS(0), makespan(-1), buildOrderSize(0) { }
+    };
+
+    std::vector<std::string>    _corpusNames;
+    std::vector<int>            _corpusVersions;
+    std::vector<std::string>    _searchTypes;
+    double                      _searchTimeLimitMS;
+    FrameCountType              _combatFrameLimit;
+    std::vector<Case>           _cases;
+    std::vector<Result>         _results;
+    std::string                 _outputFile;
+
+    void                        readCorpus(const std::string & filename);
+    Case                        readCase(const rapidjson::Value & val, const std::string & defaultName) const;
+
+    Result                      runDFBB(const Case & c) const;
+    Result                      runNaive(const Case & c) const;
+    Result                      runCombatSearch(const Case & c, const std::string & searchType) const;
+
+    void                        setMakespan(Result & result, const GameState & state, const BuildOrder & buildOrder) const;
+    void                        printResult(const Result & result) const;
+    void                        writeResults() const;
+
+public:
+
+    BOSSBenchmark(const std::vector<std::string> & corpusFiles, const std::string & outputFile);
+    BOSSBenchmark(const std::string & name, const rapidjson::Value & experimentVal);
+
+    void run();
+};
+}
@@ -2,6 +2,7 @@
 
 #include "CombatSearchExperiment.h"
 #include "BOSSPlotBuildOrders.h"
+#include "BOSSBenchmark.h"
 
 using namespace BOSS;
 
@@ -33,6 +34,10 @@ void Experiments::RunExperiments(const std::string & experimentFilename)
             {
                 RunBuildOrderPlot(name, val);
             }
+            else if (type == "Benchmark")
+            {
+                RunBenchmark(name, val);
+            }
             else
             {
                 BOSS_ASSERT(false, "Unknown Experiment Type: %s", type.c_str());
@@ -53,4 +58,10 @@ void Experiments::RunBuildOrderPlot(const std::string & name, const rapidjson::V
 {
     BOSSPlotBuildOrders plot(name, val);
     plot.doPlots();
+}
+
+void Experiments::RunBenchmark(const std::string & name, const rapidjson::Value & val)
+{
+    BOSSBenchmark benchmark(name, val);
+    benchmark.run();
 }
\ No newline at end of file
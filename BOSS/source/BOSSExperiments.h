@@ -14,6 +14,7 @@ namespace Experiments
 
     void RunCombatExperiment(const std::string & name, const rapidjson::Value & val);
     void RunBuildOrderPlot(const std::string & name, const rapidjson::Value & val);
+    void RunBenchmark(const std::string & name, const rapidjson::Value & val);
 }
 
 }
\ No newline at end of file
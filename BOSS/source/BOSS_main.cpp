@@ -1,6 +1,8 @@
 #include "BOSS.h"
 #include "BOSSParameters.h"
 #include "BOSSExperiments.h"
+#include "BOSSBenchmark.h"
+#include "BOSSBatchSolver.h"
 
 #include "CImg/CImg.h"
 
@@ -40,6 +42,60 @@ int main(int argc, char *argv[])
     // Initialize all the BOSS internal data
     BOSS::init();
 
+    // BOSS_main -benchmark corpus.json [more corpus files] [-o results.json]
+    if (argc > 1 && std::string(argv[1]) == "-benchmark")
+    {
+        std::vector<std::string> corpusFiles;
+        std::string outputFile = "benchmark_results.json";
+        for (int i(2); i < argc; ++i)
+        {
+            if (std::string(argv[i]) == "-o" && i + 1 < argc)
+            {
+                outputFile = argv[++i];
+            }
+            else
+            {
+                corpusFiles.push_back(argv[i]);
+            }
+        }
+
+        BOSS::BOSSBenchmark benchmark(corpusFiles, outputFile);
+        benchmark.run();
+        return 0;
+    }
+
+    // BOSS_main -solve jobs.txt [more job files] [-o table.bin] [-timelimit ms] [-threads n]
+    if (argc > 1 && std::string(argv[1]) == "-solve")
+    {
+        std::vector<std::string> jobFiles;
+        std::string outputFile = "BuildOrderTable.bin";
+        double timeLimitMS = 60000;
+        size_t numThreads = 0;
+        for (int i(2); i < argc; ++i)
+        {
+            if (std::string(argv[i]) == "-o" && i + 1 < argc)
+            {
+                outputFile = argv[++i];
+            }
+            else if (std::string(argv[i]) == "-timelimit" && i + 1 < argc)
+            {
+                timeLimitMS = atof(argv[++i]);
+            }
+            else if (std::string(argv[i]) == "-threads" && i + 1 < argc)
+            {
+                numThreads = (size_t)atoi(argv[++i]);
+            }
+            else
+            {
+                jobFiles.push_back(argv[i]);
+            }
+        }
+
+        BOSS::BOSSBatchSolver solver(jobFiles, timeLimitMS, numThreads);
+        solver.run();
+        return solver.writeTable(outputFile) ? 0 : 1;
+    }
+
     // Read in the config parameters that will be used for experiments
     BOSS::BOSSParameters::Instance().ParseParameters("BOSS_Config.txt");
     
@@ -147,4 +147,37 @@ bool BuildOrderSearchGoal::isAchievedBy(const GameState & state)
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+// The goal in the form JSONTools::GetBuildOrderSearchGoal reads.
+std::string BuildOrderSearchGoal::getJSONString() const
+{
+    std::stringstream ss;
+    ss << "{\"race\" : \"" << Races::GetRaceName(_race) << "\", \"goal\" : [";
+
+    bool first = true;
+    for (ActionID a(0); a<_goalUnits.size(); ++a)
+    {
+        if (_goalUnits[a] > 0)
+        {
+            ss << (first ? "" : ", ") << "[\"" << ActionTypes::GetActionType(_race, a).getName() << "\", " << _goalUnits[a] << "]";
+            first = false;
+        }
+    }
+
+    ss << "], \"goalMax\" : [";
+
+    first = true;
+    for (ActionID a(0); a<_goalUnitsMax.size(); ++a)
+    {
+        if (_goalUnitsMax[a] > 0)
+        {
+            ss << (first ? "" : ", ") << "[\"" << ActionTypes::GetActionType(_race, a).getName() << "\", " << _goalUnitsMax[a] << "]";
+            first = false;
+        }
+    }
+
+    ss << "]}";
+
+    return ss.str();
+}
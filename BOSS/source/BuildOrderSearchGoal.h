@@ -32,5 +32,6 @@ namespace BOSS {
     void setGoal(const ActionType& a, const UnitCountType num);
     void setGoalMax(const ActionType& a, const UnitCountType num);
     std::string toString() const;
+    std::string getJSONString() const;
   };
 }
@@ -0,0 +1,207 @@
+#include "BuildOrderTable.h"
+
+#include <algorithm>
+
+using namespace BOSS;
+
+namespace
+{
+    const char                  TableMagic[4] = { 'B', 'O', 'B', 'T' };
+    const unsigned int          TableVersion  = 1;
+
+    // FNV-1a
+    void HashValue(unsigned long long & hash, unsigned int value)
+    {
+        for (int i(0); i < 4; ++i)
+        {
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    template <class T>
+    void Write(std::ofstream & out, const T & value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <class T>
+    bool Read(std::ifstream & in, T & value)
+    {
+        return bool(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+    }
+
+    // both ways around, for the debug library's ordering checks
+    class KeyLess
+    {
+    public:
+        bool operator()(const BuildOrderTable::Entry & entry, const unsigned long long key) const { return entry.key < key; }
+        bool operator()(const unsigned long long key, const BuildOrderTable::Entry & entry) const { return key < entry.key; }
+        bool operator()(const BuildOrderTable::Entry & a, const BuildOrderTable::Entry & b) const { return a.key < b.key; }
+    };
+}
+
+BuildOrderTable::BuildOrderTable()
+{
+
+}
+
+unsigned long long BuildOrderTable::GetKey(const GameState & state, const BuildOrderSearchGoal & goal)
+{
+    static const ActionType & Zerg_Larva = ActionTypes::GetActionType("Zerg_Larva");
+
+    unsigned long long hash = 14695981039346656037ULL;
+    HashValue(hash, state.getRace());
+
+    const std::vector<ActionType> & allActions = ActionTypes::GetAllActionTypes(state.getRace());
+    for (ActionID a(0); a < allActions.size(); ++a)
+    {
+        // larva come and go by themselves
+        if (allActions[a] == Zerg_Larva)
+        {
+            continue;
+        }
+
+        HashValue(hash, state.getUnitData().getNumTotal(allActions[a]));
+        HashValue(hash, goal.getGoal(allActions[a]));
+        HashValue(hash, goal.getGoalMax(allActions[a]));
+    }
+
+    return hash;
+}
+
+void BuildOrderTable::add(const GameState & state, const BuildOrderSearchGoal & goal, const BuildOrder & buildOrder, const FrameCountType makespan, const bool optimal)
+{
+    Entry entry;
+    entry.key = GetKey(state, goal);
+    entry.makespan = makespan;
+    entry.race = state.getRace();
+    entry.optimal = optimal;
+    entry.buildOrder = buildOrder;
+
+    std::vector<Entry>::iterator it = std::lower_bound(_entries.begin(), _entries.end(), entry.key, KeyLess());
+    if (it != _entries.end() && it->key == entry.key)
+    {
+        if (makespan < it->makespan)
+        {
+            *it = entry;
+        }
+    }
+    else
+    {
+        _entries.insert(it, entry);
+    }
+}
+
+const BuildOrderTable::Entry * BuildOrderTable::find(const GameState & state, const BuildOrderSearchGoal & goal) const
+{
+    const unsigned long long key = GetKey(state, goal);
+
+    std::vector<Entry>::const_iterator it = std::lower_bound(_entries.begin(), _entries.end(), key, KeyLess());
+    if (it != _entries.end() && it->key == key && it->race == state.getRace())
+    {
+        return &(*it);
+    }
+
+    return NULL;
+}
+
+size_t BuildOrderTable::size() const
+{
+    return _entries.size();
+}
+
+// A table written against different action type data is rejected, since the action IDs would not match.
+bool BuildOrderTable::load(const std::string & filename)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (!in.is_open())
+    {
+        return false;
+    }
+
+    char magic[4];
+    unsigned int version, count;
+    if (!in.read(magic, 4) || !std::equal(magic, magic + 4, TableMagic) || !Read(in, version) || version != TableVersion)
+    {
+        return false;
+    }
+
+    for (RaceID r(0); r < Races::NUM_RACES; ++r)
+    {
+        unsigned int numActions;
+        if (!Read(in, numActions) || numActions != ActionTypes::GetAllActionTypes(r).size())
+        {
+            return false;
+        }
+    }
+
+    if (!Read(in, count))
+    {
+        return false;
+    }
+
+    std::vector<Entry> entries(count);
+    for (unsigned int i(0); i < count; ++i)
+    {
+        Entry & entry = entries[i];
+        int makespan;
+        unsigned char race, optimal;
+        unsigned short length;
+        if (!Read(in, entry.key) || !Read(in, makespan) || !Read(in, race) || !Read(in, optimal) || !Read(in, length) || race >= Races::NUM_RACES)
+        {
+            return false;
+        }
+
+        entry.makespan = makespan;
+        entry.race = race;
+        entry.optimal = optimal != 0;
+
+        const size_t numActions = ActionTypes::GetAllActionTypes(race).size();
+        for (unsigned short a(0); a < length; ++a)
+        {
+            ActionID id;
+            if (!Read(in, id) || id >= numActions)
+            {
+                return false;
+            }
+            entry.buildOrder.add(ActionTypes::GetActionType(race, id));
+        }
+    }
+
+    _entries.swap(entries);
+    return true;
+}
+
+bool BuildOrderTable::save(const std::string & filename) const
+{
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    out.write(TableMagic, 4);
+    Write(out, TableVersion);
+    for (RaceID r(0); r < Races::NUM_RACES; ++r)
+    {
+        Write(out, (unsigned int)ActionTypes::GetAllActionTypes(r).size());
+    }
+    Write(out, (unsigned int)_entries.size());
+
+    for (size_t i(0); i < _entries.size(); ++i)
+    {
+        const Entry & entry = _entries[i];
+        Write(out, entry.key);
+        Write(out, (int)entry.makespan);
+        Write(out, (unsigned char)entry.race);
+        Write(out, (unsigned char)(entry.optimal ? 1 : 0));
+        Write(out, (unsigned short)entry.buildOrder.size());
+        for (size_t a(0); a < entry.buildOrder.size(); ++a)
+        {
+            Write(out, entry.buildOrder[a].ID());
+        }
+    }
+
+    return bool(out);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Common.h"
+#include "GameState.h"
+#include "BuildOrder.h"
+#include "BuildOrderSearchGoal.h"
+
+namespace BOSS
+{
+
+// Build orders solved ahead of time, looked up by start state and goal.
+// The key is a hash of the race, the total count of each action in the state (finished or not),
+// and the goal. Resources and timings are not in the key, so a caller should check that a
+// build order it finds is legal from its own state.
+//
+// The binary file, in native byte order:
+//   "BOBT", uint32 version, uint32 action count for each race, uint32 entry count
+//   per entry: uint64 key, int32 makespan, uint8 race, uint8 optimal, uint16 length, uint8 action IDs
+class BuildOrderTable
+{
+public:
+
+    class Entry
+    {
+    public:
+        unsigned long long      key;
+        FrameCountType          makespan;
+        RaceID                  race;
+        bool                    optimal;        // the search finished, rather than timing out
+        BuildOrder              buildOrder;
+
+        Entry() : key(0), makespan(0), race(Races::None), optimal(false) { }
+    };
+
+private:
+
+    std::vector<Entry>          _entries;       // sorted by key
+
+public:
+
+    BuildOrderTable();
+
+    static unsigned long long   GetKey(const GameState & state, const BuildOrderSearchGoal & goal);
+
+    // keeps the shorter makespan if the key is already present
+    void                        add(const GameState & state, const BuildOrderSearchGoal & goal, const BuildOrder & buildOrder, const FrameCountType makespan, const bool optimal);
+    const Entry *               find(const GameState & state, const BuildOrderSearchGoal & goal) const;
+    size_t                      size() const;
+
+    bool                        load(const std::string & filename);
+    bool                        save(const std::string & filename) const;
+};
+
+}
@@ -9,7 +9,7 @@ CombatSearch_Bucket::CombatSearch_Bucket(const CombatSearchParameters p)
    
     BOSS_ASSERT(_params.getInitialState().getRace() != Races::None, "Combat search initial state is invalid");
 }
-void CombatSearch_Bucket::doSearch(const GameState & state, size_t depth)
+void CombatSearch_Bucket::recurse(const GameState & state, size_t depth)
 {
     if (timeLimitReached())
     {
@@ -38,7 +38,7 @@ void CombatSearch_Bucket::doSearch(const GameState & state, size_t depth)
         child.doAction(legalActions[a]);
         _buildOrder.add(legalActions[a]);
         
-        doSearch(child,depth+1);
+        recurse(child,depth+1);
 
         _buildOrder.pop_back();
     }
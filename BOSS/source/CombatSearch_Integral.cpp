@@ -9,7 +9,7 @@ CombatSearch_Integral::CombatSearch_Integral(const CombatSearchParameters p)
     BOSS_ASSERT(_params.getInitialState().getRace() != Races::None, "Combat search initial state is invalid");
 }
 
-void CombatSearch_Integral::doSearch(const GameState & state, size_t depth)
+void CombatSearch_Integral::recurse(const GameState & state, size_t depth)
 {
     if (timeLimitReached())
     {
@@ -35,7 +35,7 @@ void CombatSearch_Integral::doSearch(const GameState & state, size_t depth)
         _buildOrder.add(legalActions[index]);
         _integral.update(state, _buildOrder);
         
-        doSearch(child,depth+1);
+        recurse(child,depth+1);
 
         _buildOrder.pop_back();
         _integral.pop();
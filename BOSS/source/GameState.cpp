@@ -1091,6 +1091,37 @@ const std::string GameState::getActionsPerformedString() const
     return ss.str();
 }
 
+// The state in the form JSONTools::GetGameState reads. That form has no actions in progress,
+// so they are written as if they had finished.
+const std::string GameState::getJSONString() const
+{
+    static const ActionType & Zerg_Larva = ActionTypes::GetActionType("Zerg_Larva");
+
+    std::stringstream ss;
+    ss << "{\"race\" : \"" << Races::GetRaceName(getRace()) << "\", ";
+    ss << "\"minerals\" : " << _minerals / Constants::RESOURCE_SCALE << ", ";
+    ss << "\"gas\" : " << _gas / Constants::RESOURCE_SCALE << ", ";
+    ss << "\"units\" : [";
+
+    bool first = true;
+    const std::vector<ActionType> & allActions = ActionTypes::GetAllActionTypes(getRace());
+    for (ActionID i(0); i<allActions.size(); ++i)
+    {
+        const ActionType & action = allActions[i];
+        if (action == Zerg_Larva || _units.getNumTotal(action) == 0)
+        {
+            continue;
+        }
+
+        ss << (first ? "" : ", ") << "[\"" << action.getName() << "\", " << (int)_units.getNumTotal(action) << "]";
+        first = false;
+    }
+
+    ss << "]}";
+
+    return ss.str();
+}
+
 std::string GameState::whyIsNotLegal(const ActionType & action) const
 {
     std::stringstream ss;
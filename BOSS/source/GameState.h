@@ -98,6 +98,7 @@ namespace BOSS {
     const ResourceCountType getFinishTimeGas() const;
 
     const std::string toString() const;
+    const std::string getJSONString() const;
     const std::string getActionsPerformedString() const;
     const BuildingData& getBuildingData() const;
     const HatcheryData& getHatcheryData() const;
@@ -0,0 +1,411 @@
+// FAPBench: run the FAP combat simulator on recorded or generated engagements, without a game.
+//
+//   FAPBench [options] [scenario files]
+//     --repeat N      simulate each scenario N times for the timing (default 200)
+//     --frames N      frames to simulate, as CombatSimulation does (default 96)
+//     --synthetic     add generated scenarios of 10 to 400 units
+//     --expect FILE   compare the scores with an earlier run's output; exit 1 if any differ
+//     --fixed         use FAP's fixed point mode, which gives the same results everywhere
+//     --trace FILE    write a frame by frame trace of each scenario
+//     --replay FILE   simulate again and compare with the traces in FILE; exit 1 if any differ
+//
+// Scenario files are written by the bot when config option IO.CombatSimRecordFilename is set.
+//   scenario <name>
+//   upgrade <side> <UpgradeType name> <level>
+//   unit <side> <UnitType name> <x> <y> <hit points> <shields> [stim]
+//   end
+// Side 1 is the bot and side 2 the enemy. Lines starting with # are comments.
+//
+// The output is one line per scenario: name, units, frames simulated per run, time per simulated
+// frame, allocations per run, and the start and end scores. The scores are deterministic, so
+// they catch any change in the simulation's results.
+//
+// A trace is "trace <name>", then FAPTrace::write() output, then "end". Traces catch changes
+// that happen to leave the scores the same, and show the first frame where a run went astray.
+
+#include <BWAPI.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FAP.h"
+#include "Timer.hpp"
+
+using namespace KoalaRunBot;
+
+// Count allocations, to see what the simulation allocates per run.
+static int64_t allocations = 0;
+
+void* operator new(size_t size) {
+  ++allocations;
+  void* p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) throw() {
+  free(p);
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete[](void* p) throw() {
+  operator delete(p);
+}
+
+struct Scenario {
+  std::string name;
+  FAPPlayer players[2];
+  std::vector<FastApproximation::FAPUnit> units[2];
+};
+
+struct Result {
+  int units;
+  int frames;
+  double nsPerFrame;
+  double allocationsPerRun;
+  std::pair<int, int> startScores;
+  std::pair<int, int> endScores;
+};
+
+static BWAPI::UnitType FindUnitType(const std::string& name) {
+  for (BWAPI::UnitType type : BWAPI::UnitTypes::allUnitTypes()) {
+    if (type.getName() == name) {
+      return type;
+    }
+  }
+  return BWAPI::UnitTypes::Unknown;
+}
+
+static BWAPI::UpgradeType FindUpgradeType(const std::string& name) {
+  for (BWAPI::UpgradeType upgrade : BWAPI::UpgradeTypes::allUpgradeTypes()) {
+    if (upgrade.getName() == name) {
+      return upgrade;
+    }
+  }
+  return BWAPI::UpgradeTypes::Unknown;
+}
+
+// The units point at their scenario's players, so scenarios are not copied once they have units.
+static bool ReadScenarios(const std::string& filename, std::vector<Scenario*>& scenarios) {
+  std::ifstream in(filename);
+  if (!in) {
+    std::cerr << "can't read " << filename << std::endl;
+    return false;
+  }
+
+  Scenario* scenario = nullptr;
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(in, line)) {
+    ++lineNumber;
+    std::istringstream words(line);
+    std::string keyword;
+    if (!(words >> keyword) || keyword[0] == '#') {
+      continue;
+    }
+
+    bool ok = true;
+    if (keyword == "scenario") {
+      scenario = new Scenario;
+      ok = bool(words >> scenario->name);
+    }
+    else if (keyword == "end") {
+      ok = scenario != nullptr;
+      if (ok) {
+        scenarios.push_back(scenario);
+        scenario = nullptr;
+      }
+    }
+    else if (keyword == "upgrade" && scenario) {
+      int side, level;
+      std::string name;
+      ok = (words >> side >> name >> level) && (side == 1 || side == 2) &&
+        FindUpgradeType(name) != BWAPI::UpgradeTypes::Unknown;
+      if (ok) {
+        scenario->players[side - 1].setUpgradeLevel(FindUpgradeType(name), level);
+      }
+    }
+    else if (keyword == "unit" && scenario) {
+      int side, x, y, hp, shields;
+      std::string name, stim;
+      ok = (words >> side >> name >> x >> y >> hp >> shields) && (side == 1 || side == 2) &&
+        FindUnitType(name) != BWAPI::UnitTypes::Unknown;
+      if (ok) {
+        words >> stim;
+        scenario->units[side - 1].push_back(FastApproximation::FAPUnit(
+          scenario->players[side - 1], FindUnitType(name), x, y, hp, shields, stim == "stim"));
+      }
+    }
+    else {
+      ok = false;
+    }
+
+    if (!ok) {
+      std::cerr << filename << ":" << lineNumber << ": can't parse: " << line << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Deterministic on every platform: raw mt19937 output, not the standard distributions.
+static int Roll(std::mt19937& random, int n) {
+  return int(random() % unsigned(n));
+}
+
+// Two armies facing each other across a gap, from a mix of common combat units.
+static void AddSyntheticScenarios(std::vector<Scenario*>& scenarios) {
+  static const BWAPI::UnitType mix[2][6] = {
+    {
+      BWAPI::UnitTypes::Terran_Marine, BWAPI::UnitTypes::Terran_Medic, BWAPI::UnitTypes::Terran_Firebat,
+      BWAPI::UnitTypes::Terran_Vulture, BWAPI::UnitTypes::Terran_Goliath, BWAPI::UnitTypes::Terran_Siege_Tank_Tank_Mode
+    },
+    {
+      BWAPI::UnitTypes::Zerg_Zergling, BWAPI::UnitTypes::Zerg_Hydralisk, BWAPI::UnitTypes::Zerg_Mutalisk,
+      BWAPI::UnitTypes::Zerg_Lurker, BWAPI::UnitTypes::Zerg_Ultralisk, BWAPI::UnitTypes::Zerg_Sunken_Colony
+    }
+  };
+  static const int sizes[] = {10, 25, 50, 100, 200, 400};
+
+  std::mt19937 random(12345);
+  for (const int size : sizes) {
+    Scenario* scenario = new Scenario;
+    scenario->name = "synthetic_" + std::to_string(size);
+    scenario->players[0].setUpgradeLevel(BWAPI::UpgradeTypes::Terran_Infantry_Weapons, 1);
+    scenario->players[0].setUpgradeLevel(BWAPI::UpgradeTypes::U_238_Shells, 1);
+    scenario->players[1].setUpgradeLevel(BWAPI::UpgradeTypes::Zerg_Missile_Attacks, 1);
+    scenario->players[1].setUpgradeLevel(BWAPI::UpgradeTypes::Metabolic_Boost, 1);
+
+    for (int i = 0; i < size; ++i) {
+      const int side = i % 2;
+      const BWAPI::UnitType type = mix[side][Roll(random, 6)];
+      const int x = 1000 + (side ? 300 : -300) + Roll(random, 200) - 100;
+      const int y = 1000 + Roll(random, 400) - 200;
+      scenario->units[side].push_back(FastApproximation::FAPUnit(
+        scenario->players[side], type, x, y, type.maxHitPoints(), type.maxShields(), false));
+    }
+    scenarios.push_back(scenario);
+  }
+}
+
+static Result Run(const Scenario& scenario, const int repeat, const int frames, const bool fixed) {
+  Result result;
+  result.units = int(scenario.units[0].size() + scenario.units[1].size());
+  result.frames = 0;
+
+  FastApproximation sim;
+  sim.setFixedPoint(fixed);
+  double totalMicroseconds = 0.0;
+  int64_t totalFrames = 0;
+  int64_t totalAllocations = 0;
+
+  for (int i = 0; i < repeat; ++i) {
+    sim.clearState();
+    for (const auto& unit : scenario.units[0]) {
+      sim.addIfCombatUnitPlayer1(unit);
+    }
+    for (const auto& unit : scenario.units[1]) {
+      sim.addIfCombatUnitPlayer2(unit);
+    }
+    result.startScores = sim.playerScores();
+
+    const int64_t allocationsBefore = allocations;
+    BOSS::Timer timer;
+    timer.start();
+    result.frames = sim.simulate(frames);
+    timer.stop();
+    totalAllocations += allocations - allocationsBefore;
+
+    totalMicroseconds += timer.getElapsedTimeInMicroSec();
+    totalFrames += result.frames;
+    result.endScores = sim.playerScores();
+  }
+
+  result.nsPerFrame = totalFrames ? 1000.0 * totalMicroseconds / totalFrames : 0.0;
+  result.allocationsPerRun = repeat ? double(totalAllocations) / repeat : 0.0;
+  return result;
+}
+
+// One more run, traced. The trace is written after the timed runs so it doesn't slow them.
+static std::string Trace(const Scenario& scenario, const int frames, const bool fixed) {
+  const int units = int(scenario.units[0].size() + scenario.units[1].size());
+
+  // Room for every unit every frame, with some to spare for bunkers emptying out.
+  FAPTrace trace(frames, 2 * units * frames, 2 * units * frames);
+  FastApproximation sim;
+  sim.setFixedPoint(fixed);
+  sim.setTrace(&trace);
+  for (const auto& unit : scenario.units[0]) {
+    sim.addIfCombatUnitPlayer1(unit);
+  }
+  for (const auto& unit : scenario.units[1]) {
+    sim.addIfCombatUnitPlayer2(unit);
+  }
+  sim.simulate(frames);
+
+  std::ostringstream out;
+  out << "trace " << scenario.name << '\n';
+  trace.write(out);
+  out << "end\n";
+  return out.str();
+}
+
+// Name to the whole trace, as Trace() returns it.
+static std::map<std::string, std::string> ReadTraces(const std::string& filename) {
+  std::map<std::string, std::string> traces;
+  std::ifstream in(filename);
+  std::string line, name, text;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 6, "trace ") == 0) {
+      name = line.substr(6);
+      text.clear();
+    }
+    text += line + '\n';
+    if (line == "end" && !name.empty()) {
+      traces[name] = text;
+      name.clear();
+    }
+  }
+  return traces;
+}
+
+// The first line where two traces differ, counting from 1, or 0 if they are the same.
+static int FirstDifference(const std::string& a, const std::string& b) {
+  std::istringstream in1(a), in2(b);
+  std::string line1, line2;
+  for (int lineNumber = 1;; ++lineNumber) {
+    const bool more1 = bool(std::getline(in1, line1));
+    const bool more2 = bool(std::getline(in2, line2));
+    if (!more1 && !more2) {
+      return 0;
+    }
+    if (more1 != more2 || line1 != line2) {
+      return lineNumber;
+    }
+  }
+}
+
+// Name to "start1 start2 end1 end2" from an earlier run's output.
+static std::map<std::string, std::string> ReadExpected(const std::string& filename) {
+  std::map<std::string, std::string> expected;
+  std::ifstream in(filename);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream words(line);
+    std::string name, units, frames, ns, allocs, s1, s2, e1, e2;
+    if (words >> name >> units >> frames >> ns >> allocs >> s1 >> s2 >> e1 >> e2 && name[0] != '#') {
+      expected[name] = s1 + " " + s2 + " " + e1 + " " + e2;
+    }
+  }
+  return expected;
+}
+
+int main(int argc, char* argv[]) {
+  int repeat = 200;
+  int frames = 96;
+  bool synthetic = false;
+  bool fixed = false;
+  std::string traceFile;
+  std::string replayFile;
+  std::string expectFile;
+  std::vector<Scenario*> scenarios;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--repeat" && i + 1 < argc) {
+      repeat = std::max(1, atoi(argv[++i]));
+    }
+    else if (arg == "--frames" && i + 1 < argc) {
+      frames = atoi(argv[++i]);
+    }
+    else if (arg == "--synthetic") {
+      synthetic = true;
+    }
+    else if (arg == "--fixed") {
+      fixed = true;
+    }
+    else if (arg == "--trace" && i + 1 < argc) {
+      traceFile = argv[++i];
+    }
+    else if (arg == "--replay" && i + 1 < argc) {
+      replayFile = argv[++i];
+    }
+    else if (arg == "--expect" && i + 1 < argc) {
+      expectFile = argv[++i];
+    }
+    else if (!ReadScenarios(arg, scenarios)) {
+      return 2;
+    }
+  }
+  if (synthetic) {
+    AddSyntheticScenarios(scenarios);
+  }
+  if (scenarios.empty()) {
+    std::cerr << "usage: FAPBench [--repeat N] [--frames N] [--synthetic] [--expect FILE] [--fixed]" << std::endl
+      << "                [--trace FILE] [--replay FILE] [scenario files]" << std::endl;
+    return 2;
+  }
+
+  const std::map<std::string, std::string> expected =
+    expectFile.empty() ? std::map<std::string, std::string>() : ReadExpected(expectFile);
+  const std::map<std::string, std::string> replay =
+    replayFile.empty() ? std::map<std::string, std::string>() : ReadTraces(replayFile);
+  std::ofstream traceOut;
+  if (!traceFile.empty()) {
+    traceOut.open(traceFile);
+  }
+  int mismatches = 0;
+
+  printf("# scenario units frames ns/frame allocs/run start1 start2 end1 end2\n");
+  for (const Scenario* scenario : scenarios) {
+    const Result result = Run(*scenario, repeat, frames, fixed);
+    printf("%s %d %d %.0f %.1f %d %d %d %d\n",
+           scenario->name.c_str(), result.units, result.frames, result.nsPerFrame, result.allocationsPerRun,
+           result.startScores.first, result.startScores.second, result.endScores.first, result.endScores.second);
+
+    const auto it = expected.find(scenario->name);
+    if (it != expected.end()) {
+      std::ostringstream scores;
+      scores << result.startScores.first << " " << result.startScores.second << " "
+        << result.endScores.first << " " << result.endScores.second;
+      if (scores.str() != it->second) {
+        printf("# MISMATCH %s: expected %s\n", scenario->name.c_str(), it->second.c_str());
+        ++mismatches;
+      }
+    }
+
+    if (!traceFile.empty() || !replay.empty()) {
+      const std::string trace = Trace(*scenario, frames, fixed);
+      traceOut << trace;
+
+      const auto expectedTrace = replay.find(scenario->name);
+      if (expectedTrace != replay.end()) {
+        const int line = FirstDifference(expectedTrace->second, trace);
+        if (line) {
+          printf("# TRACE MISMATCH %s: first difference at line %d\n", scenario->name.c_str(), line);
+          ++mismatches;
+        }
+      }
+    }
+  }
+
+  for (Scenario* scenario : scenarios) {
+    delete scenario;
+  }
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,230 @@
+#include "AsyncWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <io.h>
+
+using namespace KoalaRunBot;
+
+AsyncWriter::AsyncWriter()
+	: shut_down_(false) {
+}
+
+// Normally Shutdown() has stopped the worker. If not, it can't be joined safely while the
+// DLL is being unloaded, so let it go. It owns its state and does not touch the writer.
+AsyncWriter::~AsyncWriter() {
+	if (thread_.joinable()) {
+		thread_.detach();
+	}
+}
+
+FILE* AsyncWriter::Open(const Job& job) {
+	const char* mode = job.overwrite_ ? (job.binary_ ? "wb" : "w") : (job.binary_ ? "ab" : "a");
+	return fopen(job.filename_.c_str(), mode);
+}
+
+// Write on the calling thread, the way the logger always did.
+void AsyncWriter::WriteNow(const Job& job) {
+	FILE* file = Open(job);
+	if (file) {
+		fwrite(job.data_.data(), 1, job.data_.size(), file);
+		fclose(file);
+	}
+}
+
+void AsyncWriter::Start() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	shut_down_ = false;
+}
+
+// Give the job to a worker. Return false if the worker has finished and takes no more jobs.
+// A bounded push waits for room. A job bigger than the whole queue goes in once the queue is empty.
+bool AsyncWriter::Push(Worker& worker, const Job& job, const bool bounded) {
+	std::unique_lock<std::mutex> lock(worker.mutex_);
+	if (bounded) {
+		worker.progress_.wait(lock, [&worker, &job]() {
+			return worker.finished_ || worker.queue_.empty() || worker.queued_bytes_ + job.data_.size() <= kMaxQueuedBytes;
+		});
+	}
+	if (worker.finished_) {
+		return false;
+	}
+	worker.queue_.push_back(job);
+	worker.queued_bytes_ += job.data_.size();
+	worker.work_ready_.notify_one();
+	return true;
+}
+
+// If a stopped worker that has not finished may have the file open, queue the job to it,
+// so that its writes and ours don't mix. Forget workers that have finished.
+// Called with mutex_ held.
+bool AsyncWriter::QueueToRetired(const Job& job) {
+	for (auto it = retired_.begin(); it != retired_.end();) {
+		Worker& worker = **it;
+		bool finished;
+		bool holds_file;
+		{
+			std::lock_guard<std::mutex> lock(worker.mutex_);
+			finished = worker.finished_;
+			holds_file = worker.filenames_.count(job.filename_) > 0;
+		}
+		if (finished) {
+			it = retired_.erase(it);
+			continue;
+		}
+		// Not bounded: a stuck worker must not stall the caller.
+		if (holds_file && Push(worker, job, false)) {
+			return true;
+		}
+		++it;
+	}
+	return false;
+}
+
+void AsyncWriter::Enqueue(const Job& job) {
+	std::shared_ptr<Worker> worker;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (QueueToRetired(job)) {
+			return;
+		}
+
+		if (shut_down_) {
+			// Under the lock, so no new worker can open the file meanwhile.
+			WriteNow(job);
+			return;
+		}
+
+		if (!worker_) {
+			worker_ = std::make_shared<Worker>();
+			thread_ = std::thread(&AsyncWriter::Run, worker_);
+		}
+		worker = worker_;
+
+		// Claim the file now, so that a Shutdown() before the push still routes later writes here.
+		std::lock_guard<std::mutex> worker_lock(worker->mutex_);
+		worker->filenames_.insert(job.filename_);
+	}
+
+	if (!Push(*worker, job, true)) {
+		WriteNow(job);
+	}
+}
+
+void AsyncWriter::Append(const std::string& filename, const std::string& data, const bool binary) {
+	Enqueue(Job(filename, data, false, binary));
+}
+
+void AsyncWriter::Overwrite(const std::string& filename, const std::string& data, const bool binary) {
+	Enqueue(Job(filename, data, true, binary));
+}
+
+void AsyncWriter::Run(std::shared_ptr<Worker> owner) {
+	Worker& worker = *owner;
+	std::unique_lock<std::mutex> lock(worker.mutex_);
+	for (;;) {
+		worker.work_ready_.wait(lock, [&worker]() { return !worker.queue_.empty() || worker.stopping_; });
+		if (worker.queue_.empty()) {
+			// Stopping. Close and sync the files, unless more jobs arrived meanwhile.
+			lock.unlock();
+			CloseAll(worker, true);
+			lock.lock();
+			if (worker.queue_.empty()) {
+				break;
+			}
+			continue;
+		}
+
+		std::vector<Job> batch(worker.queue_.begin(), worker.queue_.end());
+		worker.queue_.clear();
+		worker.queued_bytes_ = 0;
+		worker.progress_.notify_all();
+
+		lock.unlock();
+		WriteBatch(worker, batch);
+		lock.lock();
+	}
+
+	worker.finished_ = true;
+	worker.progress_.notify_all();
+}
+
+void AsyncWriter::WriteBatch(Worker& worker, const std::vector<Job>& batch) {
+	std::vector<FILE*> touched;
+
+	for (const Job& job : batch) {
+		auto it = worker.open_files_.find(job.filename_);
+		if (job.overwrite_ && it != worker.open_files_.end()) {
+			fclose(it->second);
+			worker.open_files_.erase(it);
+			it = worker.open_files_.end();
+		}
+		if (it == worker.open_files_.end()) {
+			FILE* file = Open(job);
+			if (!file) {
+				continue; // not much we can do about it
+			}
+			it = worker.open_files_.insert(std::make_pair(job.filename_, file)).first;
+		}
+		fwrite(job.data_.data(), 1, job.data_.size(), it->second);
+		touched.push_back(it->second);
+	}
+
+	// Hand the batch to the OS, so that other readers see it and a crash of the bot loses nothing.
+	// Syncing to the disk waits for Shutdown().
+	std::sort(touched.begin(), touched.end());
+	touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+	for (FILE* file : touched) {
+		fflush(file);
+	}
+}
+
+void AsyncWriter::CloseAll(Worker& worker, const bool sync) {
+	for (const auto& kv : worker.open_files_) {
+		fflush(kv.second);
+		if (sync) {
+			_commit(_fileno(kv.second));
+		}
+		fclose(kv.second);
+	}
+	worker.open_files_.clear();
+}
+
+bool AsyncWriter::Shutdown(const int timeout_ms) {
+	std::shared_ptr<Worker> worker;
+	std::thread thread;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		shut_down_ = true;
+		if (!worker_) {
+			return true;
+		}
+		worker.swap(worker_);
+		thread.swap(thread_);
+
+		// Until it finishes, writes to its files go to it.
+		retired_.push_back(worker);
+	}
+
+	bool done;
+	{
+		std::unique_lock<std::mutex> lock(worker->mutex_);
+		worker->stopping_ = true;
+		worker->work_ready_.notify_one();
+		done = worker->progress_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&worker]() { return worker->finished_; });
+	}
+
+	if (done) {
+		thread.join();
+	}
+	else {
+		thread.detach();
+	}
+	return done;
+}
+
+AsyncWriter& AsyncWriter::Instance() {
+	static AsyncWriter instance;
+	return instance;
+}
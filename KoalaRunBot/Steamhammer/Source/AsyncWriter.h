@@ -0,0 +1,93 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace KoalaRunBot {
+  // Writes files on a background thread, so the frame thread never waits on the disk.
+  // Writes to the same file happen in the order they were requested. The worker takes
+  // everything queued in one batch and keeps append files open between batches.
+  // Data is handed to the OS after each batch, but synced to disk only at Shutdown().
+  // The queue is bounded: a writer that gets too far ahead waits for the worker.
+  // Between Shutdown() and the next Start(), writes happen at once on the calling thread.
+  // A worker that outlives its Shutdown() timeout keeps its own state, and keeps the
+  // files it has touched: later writes to those files are queued to it, never written
+  // beside it.
+  class AsyncWriter {
+    struct Job {
+      std::string filename_;
+      std::string data_;
+      bool overwrite_; // truncate the file first, otherwise append
+      bool binary_;
+
+      Job(const std::string& filename, const std::string& data, bool overwrite, bool binary)
+        : filename_(filename)
+          , data_(data)
+          , overwrite_(overwrite)
+          , binary_(binary) { }
+    };
+
+    // Everything one worker thread uses. The thread owns a reference, so the state stays
+    // good if the worker is abandoned and the writer goes away first.
+    struct Worker {
+      std::mutex mutex_;
+      std::condition_variable work_ready_;
+      std::condition_variable progress_;
+      std::deque<Job> queue_;
+      size_t queued_bytes_;
+      bool stopping_;
+      bool finished_; // all files closed; takes no more jobs
+      std::set<std::string> filenames_; // every file queued to this worker
+
+      std::map<std::string, FILE*> open_files_; // used only by the worker thread
+
+      Worker()
+        : queued_bytes_(0)
+          , stopping_(false)
+          , finished_(false) { }
+    };
+
+    static const size_t kMaxQueuedBytes = 4 * 1024 * 1024;
+
+    std::mutex mutex_;
+    std::shared_ptr<Worker> worker_; // null until the first write after Start()
+    std::thread thread_;
+    std::vector<std::shared_ptr<Worker>> retired_; // told to stop, maybe not finished yet
+    bool shut_down_; // Shutdown() was called and Start() was not called since
+
+    AsyncWriter();
+    ~AsyncWriter();
+
+    void Enqueue(const Job& job);
+    bool QueueToRetired(const Job& job);
+
+    static bool Push(Worker& worker, const Job& job, bool bounded);
+    static void Run(std::shared_ptr<Worker> worker);
+    static void WriteBatch(Worker& worker, const std::vector<Job>& batch);
+    static void CloseAll(Worker& worker, bool sync);
+
+    static void WriteNow(const Job& job);
+    static FILE* Open(const Job& job);
+
+  public:
+    // Allow background writes again for a new game in the same process.
+    void Start();
+
+    void Append(const std::string& filename, const std::string& data, bool binary = false);
+    void Overwrite(const std::string& filename, const std::string& data, bool binary = false);
+
+    // Finish all queued writes, sync the files to disk and stop the worker.
+    // Give up after the timeout and return false; the worker keeps going on its own.
+    bool Shutdown(int timeout_ms);
+
+    static AsyncWriter& Instance();
+  };
+}
@@ -0,0 +1,76 @@
+#include "AttackPriorityMemo.h"
+
+#include <algorithm>
+
+using namespace KoalaRunBot;
+
+const int AttackPriorityMemo::kMaxAttackerTypes;
+const int AttackPriorityMemo::kUnknown;
+
+AttackPriorityMemo::AttackPriorityMemo()
+	: frame_(-1)
+	, n_targets_(0)
+{
+}
+
+void AttackPriorityMemo::StartFrame()
+{
+	const int frame = BWAPI::Broodwar->getFrameCount();
+	if (frame != frame_)
+	{
+		frame_ = frame;
+		n_targets_ = 0;
+		priorities_.clear();
+	}
+}
+
+// Return -1 if the table is full. That's not expected, since each micro manager controls few types.
+int AttackPriorityMemo::AttackerSlot(BWAPI::UnitType attacker)
+{
+	const auto it = std::find(attacker_types_.begin(), attacker_types_.end(), attacker);
+	if (it != attacker_types_.end())
+	{
+		return int(it - attacker_types_.begin());
+	}
+	if (attacker_types_.size() >= kMaxAttackerTypes)
+	{
+		return -1;
+	}
+	attacker_types_.push_back(attacker);
+	return int(attacker_types_.size()) - 1;
+}
+
+int AttackPriorityMemo::TargetSlot(BWAPI::Unit target)
+{
+	const int id = target->getID();
+	if (id >= int(target_slot_.size()))
+	{
+		target_slot_.resize(id + 1, 0);
+		target_frame_.resize(id + 1, -1);
+	}
+	if (target_frame_[id] != frame_)
+	{
+		target_frame_[id] = frame_;
+		target_slot_[id] = n_targets_++;
+		priorities_.resize(n_targets_ * kMaxAttackerTypes * 2, kUnknown);
+	}
+	return target_slot_[id];
+}
+
+int AttackPriorityMemo::Get(BWAPI::UnitType attacker, BWAPI::Unit target, bool state, const PriorityFunction& priority)
+{
+	StartFrame();
+
+	const int attackerSlot = AttackerSlot(attacker);
+	if (attackerSlot < 0)
+	{
+		return priority(attacker, target, state);
+	}
+
+	int& memo = priorities_[(TargetSlot(target) * kMaxAttackerTypes + attackerSlot) * 2 + (state ? 1 : 0)];
+	if (memo == kUnknown)
+	{
+		memo = priority(attacker, target, state);
+	}
+	return memo;
+}
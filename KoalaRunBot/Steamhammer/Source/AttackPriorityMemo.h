@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace KoalaRunBot {
+  // Remembers a micro manager's attack priorities for the frame, so that each one is computed
+  // once per (attacker type, target) instead of once per (attacker, target).
+  // A priority may also depend on one bit of the attacker's own state, like whether it is far
+  // outside the target's range. The caller works out the bit, and it is part of the key.
+  // The table is flat: target slot x attacker type slot x state. Targets get slots as they
+  // are first seen in a frame; attacker types keep their slots for the game.
+  class AttackPriorityMemo {
+  public:
+    typedef std::function<int(BWAPI::UnitType attacker, BWAPI::Unit target, bool state)> PriorityFunction;
+
+  private:
+    static const int kMaxAttackerTypes = 16;
+    static const int kUnknown = -1;
+
+    int frame_;
+    std::vector<BWAPI::UnitType> attacker_types_; // slot -> type
+    std::vector<int> target_slot_;                // unit id -> slot, valid if target_frame_ matches
+    std::vector<int> target_frame_;               // unit id -> frame the slot was given
+    int n_targets_;
+    std::vector<int> priorities_;                 // kUnknown if not computed yet
+
+    void StartFrame();
+    int AttackerSlot(BWAPI::UnitType attacker);
+    int TargetSlot(BWAPI::Unit target);
+
+  public:
+    AttackPriorityMemo();
+
+    int Get(BWAPI::UnitType attacker, BWAPI::Unit target, bool state, const PriorityFunction& priority);
+  };
+}
@@ -0,0 +1,145 @@
+#include "AttackTable.h"
+
+#include "UnitUtil.h"
+
+using namespace KoalaRunBot;
+
+namespace {
+	// The upgrades that change a weapon's range.
+	const BWAPI::UpgradeType kRangeUpgrades[] = {
+		BWAPI::UpgradeTypes::U_238_Shells,
+		BWAPI::UpgradeTypes::Charon_Boosters,
+		BWAPI::UpgradeTypes::Singularity_Charge,
+		BWAPI::UpgradeTypes::Grooved_Spines,
+	};
+}
+
+AttackTable::AttackTable()
+	: frame_(-1)
+{
+}
+
+int AttackTable::PlayerIndex(BWAPI::Player player)
+{
+	return player == BWAPI::Broodwar->self() ? 0 : 1;
+}
+
+void AttackTable::ReadUpgradeLevels(std::vector<int>& levels) const
+{
+	levels.clear();
+	for (BWAPI::Player player : { BWAPI::Broodwar->self(), BWAPI::Broodwar->enemy() })
+	{
+		for (const BWAPI::UpgradeType upgrade : kRangeUpgrades)
+		{
+			levels.push_back(player ? player->getUpgradeLevel(upgrade) : 0);
+		}
+	}
+}
+
+void AttackTable::Fill()
+{
+	const std::vector<BWAPI::Player> players = { BWAPI::Broodwar->self(), BWAPI::Broodwar->enemy() };
+
+	for (int p = 0; p < 2; ++p)
+	{
+		// Without an enemy (say, in a replay), it doesn't matter whose upgrades we use.
+		BWAPI::Player player = players[p] ? players[p] : BWAPI::Broodwar->self();
+
+		attacks_[p].assign(BWAPI::UnitTypes::Enum::MAX, TypeAttack());
+		for (const BWAPI::UnitType type : BWAPI::UnitTypes::allUnitTypes())
+		{
+			TypeAttack& attack = attacks_[p][type.getID()];
+			attack.can_attack_air_ = UnitUtil::TypeCanAttackAir(type);
+			attack.can_attack_ground_ = UnitUtil::TypeCanAttackGround(type);
+
+			// Reavers, carriers, and bunkers have "no weapon" but still have an attack range.
+			if (type == BWAPI::UnitTypes::Protoss_Reaver)
+			{
+				attack.air_range_ = 0;
+				attack.ground_range_ = 8 * 32;
+			}
+			else if (type == BWAPI::UnitTypes::Protoss_Carrier)
+			{
+				attack.air_range_ = 8 * 32;
+				attack.ground_range_ = 8 * 32;
+			}
+			else if (type == BWAPI::UnitTypes::Terran_Bunker)
+			{
+				const bool shells = p == 1 || player->getUpgradeLevel(BWAPI::UpgradeTypes::U_238_Shells) > 0;
+				attack.air_range_ = shells ? 6 * 32 : 5 * 32;
+				attack.ground_range_ = attack.air_range_;
+			}
+			else
+			{
+				const BWAPI::WeaponType air = UnitUtil::GetAirWeapon(type);
+				const BWAPI::WeaponType ground = UnitUtil::GetGroundWeapon(type);
+				attack.air_range_ = air == BWAPI::WeaponTypes::None ? 0 : player->weaponMaxRange(air);
+				attack.ground_range_ = ground == BWAPI::WeaponTypes::None ? 0 : player->weaponMaxRange(ground);
+			}
+		}
+	}
+}
+
+void AttackTable::Initialize()
+{
+	ReadUpgradeLevels(upgrade_levels_);
+	Fill();
+	frame_ = BWAPI::Broodwar->getFrameCount();
+}
+
+void AttackTable::Update()
+{
+	const int frame = BWAPI::Broodwar->getFrameCount();
+	if (frame == frame_)
+	{
+		return;
+	}
+	frame_ = frame;
+
+	std::vector<int> levels;
+	ReadUpgradeLevels(levels);
+	if (levels != upgrade_levels_ || attacks_[0].empty())
+	{
+		upgrade_levels_.swap(levels);
+		Fill();
+	}
+}
+
+bool AttackTable::CanAttack(BWAPI::UnitType attacker, bool flying_target) const
+{
+	const TypeAttack& attack = attacks_[0][attacker.getID()];
+	return flying_target ? attack.can_attack_air_ : attack.can_attack_ground_;
+}
+
+int AttackTable::Range(BWAPI::Player player, BWAPI::UnitType attacker, bool flying_target) const
+{
+	const TypeAttack& attack = attacks_[PlayerIndex(player)][attacker.getID()];
+	return flying_target ? attack.air_range_ : attack.ground_range_;
+}
+
+int AttackTable::DamagePercent(BWAPI::DamageType damage, BWAPI::UnitSizeType size)
+{
+	if (damage == BWAPI::DamageTypes::Explosive)
+	{
+		if (size == BWAPI::UnitSizeTypes::Small)
+		{
+			return 50;
+		}
+		if (size == BWAPI::UnitSizeTypes::Medium)
+		{
+			return 75;
+		}
+	}
+	else if (damage == BWAPI::DamageTypes::Concussive)
+	{
+		if (size == BWAPI::UnitSizeTypes::Medium)
+		{
+			return 50;
+		}
+		if (size == BWAPI::UnitSizeTypes::Large)
+		{
+			return 25;
+		}
+	}
+	return 100;
+}
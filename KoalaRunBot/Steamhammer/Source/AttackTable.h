@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace KoalaRunBot {
+  // Type-level facts about attacks, computed once instead of in the micro managers' inner loops.
+  // Ranges are per player and include range upgrades, with the same special cases as
+  // UnitUtil::GetAttackRange(): reavers, carriers and bunkers. The table is filled at the
+  // start of the game and refilled when a range upgrade finishes for either side.
+  class AttackTable {
+    struct TypeAttack {
+      bool can_attack_air_;
+      bool can_attack_ground_;
+      int air_range_;
+      int ground_range_;
+    };
+
+    std::vector<TypeAttack> attacks_[2]; // [self, enemy] x unit type id
+    std::vector<int> upgrade_levels_;    // range upgrades of both players, to notice changes
+    int frame_;
+
+    static int PlayerIndex(BWAPI::Player player);
+    void ReadUpgradeLevels(std::vector<int>& levels) const;
+    void Fill();
+
+  public:
+    AttackTable();
+
+    void Initialize();
+
+    // Refill if a range upgrade has finished. Cheap; does the check at most once per frame.
+    void Update();
+
+    bool CanAttack(BWAPI::UnitType attacker, bool flying_target) const;
+
+    // Attack range in pixels, 0 if the attacker cannot attack the target at all.
+    int Range(BWAPI::Player player, BWAPI::UnitType attacker, bool flying_target) const;
+
+    // Percent of weapon damage done to a target of the given size.
+    static int DamagePercent(BWAPI::DamageType damage, BWAPI::UnitSizeType size);
+  };
+}
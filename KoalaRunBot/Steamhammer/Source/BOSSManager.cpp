@@ -1,8 +1,12 @@
 #include "Common.h"
 #include "BOSSManager.h"
+#include "AsyncWriter.h"
 #include "BuildingManager.h"
 #include "UnitUtil.h"
 
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
 using namespace KoalaRunBot;
 
 BOSSManager& BOSSManager::Instance() {
@@ -47,6 +51,18 @@ void BOSSManager::startNewSearch(const std::vector<MetaPair>& goalUnits) {
     BOSS::GameState initialState(BWAPI::Broodwar, BWAPI::Broodwar->self(),
                                  BuildingManager::Instance().buildingsQueued());
 
+    // a build order solved offline, if there is one that fits
+    const BOSS::BuildOrderTable::Entry* entry = _buildOrderTable.find(initialState, goal);
+    if (entry && entry->buildOrder.isLegalFromState(initialState)) {
+      _previousBuildOrder = entry->buildOrder;
+      _previousStatusDesc = std::string("\x07") + "Table Solution\n";
+      _previousGoalUnits = goalUnits;
+      _totalPreviousSearchTime = 0;
+      return;
+    }
+
+    recordCase(initialState, goal);
+
     _smartSearch = SearchPtr(new BOSS::DFBB_BuildOrderSmartSearch(initialState.getRace()));
     _smartSearch->setGoal(GetGoal(goalUnits));
     _smartSearch->setState(initialState);
@@ -63,6 +79,35 @@ void BOSSManager::startNewSearch(const std::vector<MetaPair>& goalUnits) {
   }
 }
 
+// Build orders precomputed by the BOSS batch solver, looked up before each search.
+void BOSSManager::loadBuildOrderTable() {
+  if (Config::IO::BuildOrderTableFilename.empty()) {
+    return;
+  }
+
+  if (!_buildOrderTable.load(Config::IO::BuildOrderTableFilename)) {
+    UAB_ASSERT_WARNING(false, "Could not load build order table %s", Config::IO::BuildOrderTableFilename.c_str());
+  }
+}
+
+// Add the search to the case file that the BOSS benchmark reads, one case per line.
+void BOSSManager::recordCase(const BOSS::GameState& state, const BOSS::BuildOrderSearchGoal& goal) const {
+  if (Config::IO::BOSSCorpusFilename.empty()) {
+    return;
+  }
+
+  // Map file names may hold any characters, so let rapidjson quote and escape the name.
+  const std::string name = BWAPI::Broodwar->mapFileName() + "@" + std::to_string(BWAPI::Broodwar->getFrameCount());
+  rapidjson::StringBuffer quotedName;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(quotedName);
+  writer.String(name.c_str(), rapidjson::SizeType(name.size()));
+
+  std::ostringstream line;
+  line << "{\"name\" : " << quotedName.GetString() << ", \"state\" : " << state.getJSONString()
+    << ", \"goal\" : " << goal.getJSONString() << "}\n";
+  AsyncWriter::Instance().Append(Config::IO::BOSSCorpusFilename, line.str());
+}
+
 void BOSSManager::drawSearchInformation(int x, int y) {
   if (!Config::Debug::DrawBuildOrderSearchInfo) {
     return;
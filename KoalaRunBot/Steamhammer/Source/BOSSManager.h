@@ -25,6 +25,8 @@ namespace KoalaRunBot {
     BOSS::DFBB_BuildOrderSearchResults _savedSearchResults;
     BOSS::BuildOrder _previousBuildOrder;
 
+    BOSS::BuildOrderTable _buildOrderTable;
+
     BOSS::GameState getCurrentState();
     BOSS::GameState getStartState();
 
@@ -36,6 +38,7 @@ namespace KoalaRunBot {
     std::vector<std::vector<MacroAct>> openingBook;
     const BOSS::RaceID getRace() const;
     void logBadSearch();
+    void recordCase(const BOSS::GameState& state, const BOSS::BuildOrderSearchGoal& goal) const;
 
     BOSSManager();
 
@@ -43,6 +46,7 @@ namespace KoalaRunBot {
 
     static BOSSManager& Instance();
 
+    void loadBuildOrderTable();
     void update(double timeLimit);
     void reset();
 
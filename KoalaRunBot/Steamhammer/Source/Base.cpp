@@ -86,6 +86,24 @@ void Base::setOwner(BWAPI::Unit depot, BWAPI::Player player) {
   reserved = false;
 }
 
+// Ground distance in pixels, -1 if unreachable.
+// After initializeWalkDistances(), it is the walking distance from the center of the depot
+// for a medium-size unit, at walk tile resolution. Otherwise it is the Manhattan tile distance.
+int Base::getDistance(const BWAPI::Position& pos) const {
+  if (walkDistances) {
+    return walkDistances->GetDistance(pos);
+  }
+
+  const int tiles = getTileDistance(pos);
+  return tiles < 0 ? -1 : 32 * tiles;
+}
+
+// A search over the whole map at walk tile resolution. Call it at startup, not during play.
+void Base::initializeWalkDistances() {
+  const BWAPI::Position depotCenter = getPosition() + BWAPI::Position(64, 48);
+  walkDistances.reset(new WalkDistances(BWAPI::WalkPosition(depotCenter), BWAPI::UnitSizeTypes::Medium));
+}
+
 int Base::getInitialMinerals() const {
   int total = 0;
   for (const BWAPI::Unit min : minerals) {
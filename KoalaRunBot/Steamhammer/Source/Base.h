@@ -1,6 +1,9 @@
 #pragma once
 
+#include <memory>
+
 #include "GridDistances.h"
+#include "WalkDistances.h"
 
 namespace KoalaRunBot
 {
@@ -19,6 +22,8 @@ private:
 	BWAPI::Unitset		geysers;			// the base's associated geysers
 	BWAPI::Unitset		blockers;			// destructible neutral units that may be in the way
 	GridDistances		distances;			// ground distances from tilePosition
+	std::unique_ptr<WalkDistances>
+						walkDistances;		// from the depot center, or null if not made
 
 	bool				reserved;			// if this is a planned expansion
 	bool				workerDanger;		// for our own bases only; false for others
@@ -45,7 +50,9 @@ public:
 	// Ground distances.
 	int getTileDistance(const BWAPI::Position & pos) const { return distances.at(pos); };
 	int getTileDistance(const BWAPI::TilePosition & pos) const { return distances.at(pos); };
-	int getDistance(const BWAPI::Position & pos) const { return 32 * getTileDistance(pos); };
+	int getDistance(const BWAPI::Position & pos) const;
+	void initializeWalkDistances();
+	bool hasWalkDistances() const { return walkDistances != nullptr; };
 
 	void setOwner(BWAPI::Unit depot, BWAPI::Player player);
 
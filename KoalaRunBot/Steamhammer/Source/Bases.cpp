@@ -359,6 +359,16 @@ void Bases::initialize()
 	setNaturalBase();
 }
 
+// Config option Tools.WalkDistances. Each base gets a map-wide walk distance field, which
+// takes time and memory, so do it once at startup after the config is read.
+void Bases::initializeWalkDistances()
+{
+	for (Base * base : bases)
+	{
+		base->initializeWalkDistances();
+	}
+}
+
 void Bases::drawBaseInfo() const
 {
 	//the.partitions.drawWalkable();
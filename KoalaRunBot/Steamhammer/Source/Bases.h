@@ -65,6 +65,7 @@ namespace KoalaRunBot
 
 	public:
 		void initialize();
+		void initializeWalkDistances();
 		void drawBaseInfo() const;
 		void drawBaseOwnership(int x, int y) const;
 
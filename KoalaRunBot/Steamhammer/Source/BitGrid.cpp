@@ -0,0 +1,213 @@
+#include "BitGrid.h"
+
+#include <algorithm>
+
+using namespace KoalaRunBot;
+
+// Create an empty grid. Necessary if the owner is created before BWAPI is initialized.
+BitGrid::BitGrid()
+	: width_(0)
+	, height_(0)
+	, words_per_row_(0)
+{
+}
+
+BitGrid::BitGrid(int width, int height, bool value)
+	: width_(width)
+	, height_(height)
+	, words_per_row_((width + 63) / 64)
+	, bits_(words_per_row_ * height, value ? ~uint64_t(0) : uint64_t(0))
+{
+	ClearPadding();
+}
+
+// The bits past the right edge of each row stay 0, so that counting and shifting can ignore them.
+void BitGrid::ClearPadding()
+{
+	if (width_ % 64 == 0)
+	{
+		return;
+	}
+	const uint64_t keep = Mask(0, width_ % 64);
+	for (int y = 0; y < height_; ++y)
+	{
+		bits_[y * words_per_row_ + words_per_row_ - 1] &= keep;
+	}
+}
+
+// Clip the rectangle to the grid. Return false if it was changed.
+bool BitGrid::ClipRect(int & x1, int & y1, int & x2, int & y2) const
+{
+	const bool inside = x1 >= 0 && y1 >= 0 && x2 <= width_ && y2 <= height_;
+	x1 = std::max(x1, 0);
+	y1 = std::max(y1, 0);
+	x2 = std::min(x2, width_);
+	y2 = std::min(y2, height_);
+	return inside;
+}
+
+void BitGrid::SetRect(int x1, int y1, int x2, int y2, bool value)
+{
+	ClipRect(x1, y1, x2, y2);
+	if (x1 >= x2 || y1 >= y2)
+	{
+		return;
+	}
+
+	const int firstWord = x1 >> 6;
+	const int lastWord = (x2 - 1) >> 6;
+	for (int y = y1; y < y2; ++y)
+	{
+		uint64_t * row = &bits_[y * words_per_row_];
+		for (int w = firstWord; w <= lastWord; ++w)
+		{
+			const uint64_t mask = Mask(w == firstWord ? x1 & 63 : 0, w == lastWord ? ((x2 - 1) & 63) + 1 : 64);
+			row[w] = value ? row[w] | mask : row[w] & ~mask;
+		}
+	}
+}
+
+bool BitGrid::AnyInRect(int x1, int y1, int x2, int y2) const
+{
+	ClipRect(x1, y1, x2, y2);
+	if (x1 >= x2 || y1 >= y2)
+	{
+		return false;
+	}
+
+	const int firstWord = x1 >> 6;
+	const int lastWord = (x2 - 1) >> 6;
+	for (int y = y1; y < y2; ++y)
+	{
+		const uint64_t * row = &bits_[y * words_per_row_];
+		for (int w = firstWord; w <= lastWord; ++w)
+		{
+			if (row[w] & Mask(w == firstWord ? x1 & 63 : 0, w == lastWord ? ((x2 - 1) & 63) + 1 : 64))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool BitGrid::AllInRect(int x1, int y1, int x2, int y2) const
+{
+	if (!ClipRect(x1, y1, x2, y2))
+	{
+		return false;
+	}
+
+	const int firstWord = x1 >> 6;
+	const int lastWord = (x2 - 1) >> 6;
+	for (int y = y1; y < y2; ++y)
+	{
+		const uint64_t * row = &bits_[y * words_per_row_];
+		for (int w = firstWord; w <= lastWord; ++w)
+		{
+			const uint64_t mask = Mask(w == firstWord ? x1 & 63 : 0, w == lastWord ? ((x2 - 1) & 63) + 1 : 64);
+			if ((row[w] & mask) != mask)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int BitGrid::Count() const
+{
+	int count = 0;
+	for (uint64_t word : bits_)
+	{
+		while (word)
+		{
+			word &= word - 1;
+			++count;
+		}
+	}
+	return count;
+}
+
+// Dilate each row by shifting it one tile left and right, radius times, then OR
+// each row with its neighbors within the radius.
+void BitGrid::Dilate(int radius)
+{
+	if (radius <= 0 || bits_.empty())
+	{
+		return;
+	}
+
+	const int n = words_per_row_;
+
+	for (int y = 0; y < height_; ++y)
+	{
+		uint64_t * row = &bits_[y * n];
+		for (int r = 0; r < radius; ++r)
+		{
+			uint64_t carryLeft = 0;          // bit shifted in from the word to the left (lower x)
+			std::vector<uint64_t> grown(row, row + n);
+			for (int w = 0; w < n; ++w)
+			{
+				const uint64_t fromRight = w + 1 < n ? row[w + 1] << 63 : 0;
+				grown[w] |= (row[w] << 1) | carryLeft | (row[w] >> 1) | fromRight;
+				carryLeft = row[w] >> 63;
+			}
+			std::copy(grown.begin(), grown.end(), row);
+		}
+	}
+	ClearPadding();
+
+	const std::vector<uint64_t> rows(bits_);
+	for (int y = 0; y < height_; ++y)
+	{
+		for (int dy = -radius; dy <= radius; ++dy)
+		{
+			const int yy = y + dy;
+			if (dy == 0 || yy < 0 || yy >= height_)
+			{
+				continue;
+			}
+			for (int w = 0; w < n; ++w)
+			{
+				bits_[y * n + w] |= rows[yy * n + w];
+			}
+		}
+	}
+}
+
+BitGrid & BitGrid::operator|=(const BitGrid & other)
+{
+	for (size_t i = 0; i < bits_.size(); ++i)
+	{
+		bits_[i] |= other.bits_[i];
+	}
+	return *this;
+}
+
+BitGrid & BitGrid::operator&=(const BitGrid & other)
+{
+	for (size_t i = 0; i < bits_.size(); ++i)
+	{
+		bits_[i] &= other.bits_[i];
+	}
+	return *this;
+}
+
+BitGrid & BitGrid::AndNot(const BitGrid & other)
+{
+	for (size_t i = 0; i < bits_.size(); ++i)
+	{
+		bits_[i] &= ~other.bits_[i];
+	}
+	return *this;
+}
+
+void BitGrid::Invert()
+{
+	for (uint64_t & word : bits_)
+	{
+		word = ~word;
+	}
+	ClearPadding();
+}
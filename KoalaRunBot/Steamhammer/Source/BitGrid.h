@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// A flat, row-major grid of bits with 64 tiles per word, for boolean map layers
+// like walkability, buildability and reserved tiles.
+// Rectangle tests, layer AND/OR and dilation work a word at a time.
+// Coordinates are tile coordinates; rectangles are half-open [x1,x2) x [y1,y2).
+
+namespace KoalaRunBot {
+  class BitGrid {
+    int width_;
+    int height_;
+    int words_per_row_;
+    std::vector<uint64_t> bits_;
+
+    // Bits [from,to) of one word, 0 <= from < to <= 64.
+    static uint64_t Mask(int from, int to) {
+      return (to - from == 64 ? ~uint64_t(0) : ((uint64_t(1) << (to - from)) - 1)) << from;
+    }
+
+    void ClearPadding();
+    bool ClipRect(int& x1, int& y1, int& x2, int& y2) const;
+
+  public:
+    BitGrid();
+    BitGrid(int width, int height, bool value);
+
+    int Width() const { return width_; }
+    int Height() const { return height_; }
+
+    // No bounds checking. Pass only valid tiles!
+    bool Get(const int x, const int y) const {
+      return (bits_[y * words_per_row_ + (x >> 6)] >> (x & 63) & 1) != 0;
+    }
+
+    void Set(const int x, const int y, const bool value) {
+      const uint64_t bit = uint64_t(1) << (x & 63);
+      uint64_t& word = bits_[y * words_per_row_ + (x >> 6)];
+      word = value ? word | bit : word & ~bit;
+    }
+
+    // Tiles off the map are ignored.
+    void SetRect(int x1, int y1, int x2, int y2, bool value);
+
+    // Tiles off the map count as unset for Any and as set for None, so that a
+    // rectangle hanging off the edge is not All and not None.
+    bool AnyInRect(int x1, int y1, int x2, int y2) const;
+    bool AllInRect(int x1, int y1, int x2, int y2) const;
+
+    int Count() const;
+
+    // Set every tile within the given Chebyshev distance of a set tile (a square brush).
+    void Dilate(int radius);
+
+    // Layer operations. The grids must be the same size.
+    BitGrid& operator|=(const BitGrid& other);
+    BitGrid& operator&=(const BitGrid& other);
+    BitGrid& AndNot(const BitGrid& other);
+    void Invert();
+  };
+}
@@ -1,8 +1,13 @@
 #include "BotCore.h"
+#include "AsyncWriter.h"
+#include "BOSSManager.h"
+#include "CombatSimulation.h"
 #include "Bases.h"
 #include "Common.h"
+#include "EventLog.h"
 #include "OpponentModel.h"
 #include "ParseUtils.h"
+#include "Profiler.h"
 
 using namespace KoalaRunBot;
 
@@ -15,8 +20,15 @@ BotCore::BotCore()
 // This gets called when the bot starts.
 void BotCore::onStart()
 {
+	// The client may play many games in one process. Reset what outlives a game.
+	AsyncWriter::Instance().Start();
+	CombatSimulation::StartGame();
+
 	the.Initialize();
 
+	// If the bot crashes, write out the recent events first.
+	EventLog::Instance().InstallCrashHandler();
+
 	// Initialize BOSS, the Build Order Search System
 	BOSS::init();
 
@@ -34,6 +46,12 @@ void BotCore::onStart()
 	// The config depends on the map and must be read after the map is analyzed.
 	ParseUtils::ParseConfigFile(Config::ConfigFile::ConfigFileLocation);
 
+	// Walk distances are a config option, so they are made after the config is read.
+	if (Config::Tools::WalkDistances)
+	{
+		Bases::Instance().initializeWalkDistances();
+	}
+
 	// Set our BWAPI options according to the configuration. 
 	BWAPI::Broodwar->setLocalSpeed(Config::BWAPIOptions::SetLocalSpeed);
 	BWAPI::Broodwar->setFrameSkip(Config::BWAPIOptions::SetFrameSkip);
@@ -50,6 +68,9 @@ void BotCore::onStart()
 
 	StrategyManager::Instance().setOpeningGroup();    // may depend on config and/or opponent model
 
+	// Build orders solved offline, if configured.
+	BOSSManager::Instance().loadBuildOrderTable();
+
 	if (Config::BotInfo::PrintInfoOnStart)
 	{
 		BWAPI::Broodwar->printf("%s by %s, based on SteamHammer.", Config::BotInfo::BotName.c_str(), Config::BotInfo::Authors.c_str());
@@ -66,6 +87,12 @@ void BotCore::onEnd(bool isWinner)
 {
 	OpponentModel::Instance().setWin(isWinner);
 	OpponentModel::Instance().write();
+
+	EventLog::Instance().Dump("game end");
+	Profiler::Instance().WriteReport(Config::IO::ProfileFilename, Config::IO::ProfileTraceFilename);
+
+	// Finish writing files before the tournament manager loses patience.
+	AsyncWriter::Instance().Shutdown(Config::IO::EndWriteTimeout);
 }
 
 void BotCore::onFrame()
@@ -8,10 +8,14 @@
 
 using namespace KoalaRunBot;
 
+// Rebuild the placement index at least this often, to catch terran buildings lifting off and landing.
+static const int BlockedRefreshFrames = 5 * 24;
+
 BuildingPlacer::BuildingPlacer()
-  : the(The::Root()) {
-  _reserveMap = std::vector<std::vector<bool>>(BWAPI::Broodwar->mapWidth(),
-                                               std::vector<bool>(BWAPI::Broodwar->mapHeight(), false));
+  : the(The::Root())
+    , _blockedDirty(true)
+    , _blockedFrame(0) {
+  _reserveMap = BitGrid(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight(), false);
 
   reserveSpaceNearResources();
 }
@@ -77,12 +81,8 @@ bool BuildingPlacer::canBuildHere(BWAPI::TilePosition position, const Building&
   }
 
   // check the reserve map
-  for (int x = position.x; x < position.x + b.type.tileWidth(); x++) {
-    for (int y = position.y; y < position.y + b.type.tileHeight(); y++) {
-      if (_reserveMap[x][y]) {
-        return false;
-      }
-    }
+  if (_reserveMap.AnyInRect(position.x, position.y, position.x + b.type.tileWidth(), position.y + b.type.tileHeight())) {
+    return false;
   }
 
   // if it overlaps a base location return false
@@ -110,12 +110,8 @@ bool BuildingPlacer::tileBlocksAddon(BWAPI::TilePosition position) const {
 
 // Can we build this building here with the specified amount of space around it?
 // Space value is buildDist. horizontalOnly means only horizontal spacing.
+// The spacing rectangle is checked against the placement index before anything that asks BWAPI.
 bool BuildingPlacer::canBuildHereWithSpace(BWAPI::TilePosition position, const Building& b, int buildDist) const {
-  //if we can't build here, we of course can't build here with space
-  if (!canBuildHere(position, b)) {
-    return false;
-  }
-
   // height and width of the building
   int width(b.type.tileWidth());
   int height(b.type.tileHeight());
@@ -150,11 +146,21 @@ bool BuildingPlacer::canBuildHereWithSpace(BWAPI::TilePosition position, const B
     return false;
   }
 
+  // Cheap test first: Rule out terrain, reserved tiles and our own buildings in O(1).
+  if (!b.type.isRefinery() && !rectangleClear(startx, starty, endx, endy)) {
+    return false;
+  }
+
+  //if we can't build here, we of course can't build here with space
+  if (!canBuildHere(position, b)) {
+    return false;
+  }
+
   // if space is reserved, or it's in the resource box, we can't build here
   for (int x = startx; x < endx; x++) {
     for (int y = starty; y < endy; y++) {
       if (!b.type.isRefinery()) {
-        if (!buildable(b, x, y) || _reserveMap[x][y]) {
+        if (!buildable(b, x, y) || _reserveMap.Get(x, y)) {
           return false;
         }
       }
@@ -167,6 +173,8 @@ bool BuildingPlacer::canBuildHereWithSpace(BWAPI::TilePosition position, const B
 BWAPI::TilePosition BuildingPlacer::getBuildLocationNear(const Building& b, int buildDist) const {
   // BWAPI::Broodwar->printf("Building Placer seeks position near %d, %d", b.desiredPosition.x, b.desiredPosition.y);
 
+  updateBlockedSums();
+
   // get the precomputed vector of tile positions which are sorted closest to this location
   const std::vector<BWAPI::TilePosition>& closestToBuilding = MapTools::Instance().getClosestTilesTo(b.desiredPosition);
 
@@ -241,13 +249,8 @@ bool BuildingPlacer::buildable(const Building& b, int x, int y) const {
 }
 
 void BuildingPlacer::reserveTiles(BWAPI::TilePosition position, int width, int height) {
-  int rwidth = _reserveMap.size();
-  int rheight = _reserveMap[0].size();
-  for (int x = std::max(position.x, 0); x < std::min(position.x + width, rwidth); x++) {
-    for (int y = std::max(position.y, 0); y < std::min(position.y + height, rheight); y++) {
-      _reserveMap[x][y] = true;
-    }
-  }
+  _reserveMap.SetRect(position.x, position.y, position.x + width, position.y + height, true);
+  _blockedDirty = true;
 }
 
 void BuildingPlacer::drawReservedTiles() {
@@ -255,12 +258,9 @@ void BuildingPlacer::drawReservedTiles() {
     return;
   }
 
-  int rwidth = _reserveMap.size();
-  int rheight = _reserveMap[0].size();
-
-  for (int x = 0; x < rwidth; ++x) {
-    for (int y = 0; y < rheight; ++y) {
-      if (_reserveMap[x][y]) {
+  for (int x = 0; x < _reserveMap.Width(); ++x) {
+    for (int y = 0; y < _reserveMap.Height(); ++y) {
+      if (_reserveMap.Get(x, y)) {
         int x1 = x * 32 + 3;
         int y1 = y * 32 + 3;
         int x2 = (x + 1) * 32 - 3;
@@ -273,14 +273,58 @@ void BuildingPlacer::drawReservedTiles() {
 }
 
 void BuildingPlacer::freeTiles(BWAPI::TilePosition position, int width, int height) {
-  int rwidth = _reserveMap.size();
-  int rheight = _reserveMap[0].size();
+  _reserveMap.SetRect(position.x, position.y, position.x + width, position.y + height, false);
+  _blockedDirty = true;
+}
 
-  for (int x = position.x; x < position.x + width && x < rwidth; x++) {
-    for (int y = position.y; y < position.y + height && y < rheight; y++) {
-      _reserveMap[x][y] = false;
+// Called when a unit is created, destroyed, or morphs. Only our buildings are in the index.
+void BuildingPlacer::onUnitChange(BWAPI::Unit unit) {
+  if (unit->getPlayer() == BWAPI::Broodwar->self() && unit->getType().isBuilding()) {
+    _blockedDirty = true;
+  }
+}
+
+// Recount blocked tiles into the summed-area table, if anything changed.
+// _blockedSums[y * (w+1) + x] is the number of blocked tiles in [0,x) x [0,y).
+void BuildingPlacer::updateBlockedSums() const {
+  if (!_blockedDirty && BWAPI::Broodwar->getFrameCount() - _blockedFrame < BlockedRefreshFrames) {
+    return;
+  }
+
+  const int w = BWAPI::Broodwar->mapWidth();
+  const int h = BWAPI::Broodwar->mapHeight();
+
+  // blocked = not buildable, or reserved, or under one of our buildings
+  BitGrid blocked(MapTools::Instance().getBuildableGrid());
+  blocked.Invert();
+  blocked |= _reserveMap;
+  for (const auto unit : BWAPI::Broodwar->self()->getUnits()) {
+    if (unit->getType().isBuilding() && !unit->isLifted()) {
+      const BWAPI::TilePosition tile = unit->getTilePosition();
+      blocked.SetRect(tile.x, tile.y, tile.x + unit->getType().tileWidth(), tile.y + unit->getType().tileHeight(), true);
+    }
+  }
+
+  _blockedSums.assign((w + 1) * (h + 1), 0);
+  for (int y = 0; y < h; ++y) {
+    int rowSum = 0;
+    for (int x = 0; x < w; ++x) {
+      rowSum += blocked.Get(x, y);
+      _blockedSums[(y + 1) * (w + 1) + x + 1] = _blockedSums[y * (w + 1) + x + 1] + rowSum;
     }
   }
+
+  _blockedDirty = false;
+  _blockedFrame = BWAPI::Broodwar->getFrameCount();
+}
+
+// Are all tiles in [x1,x2) x [y1,y2) free of blocking? The rectangle must be on the map.
+bool BuildingPlacer::rectangleClear(int x1, int y1, int x2, int y2) const {
+  updateBlockedSums();
+
+  const int stride = BWAPI::Broodwar->mapWidth() + 1;
+  return _blockedSums[y2 * stride + x2] - _blockedSums[y1 * stride + x2]
+    - _blockedSums[y2 * stride + x1] + _blockedSums[y1 * stride + x1] == 0;
 }
 
 // NOTE This allows building only on accessible geysers.
@@ -315,11 +359,9 @@ BWAPI::TilePosition BuildingPlacer::getRefineryPosition() {
 }
 
 bool BuildingPlacer::isReserved(int x, int y) const {
-  int rwidth = _reserveMap.size();
-  int rheight = _reserveMap[0].size();
-  if (x < 0 || y < 0 || x >= rwidth || y >= rheight) {
+  if (x < 0 || y < 0 || x >= _reserveMap.Width() || y >= _reserveMap.Height()) {
     return false;
   }
 
-  return _reserveMap[x][y];
+  return _reserveMap.Get(x, y);
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BitGrid.h"
 #include "BuildingData.h"
 
 namespace KoalaRunBot {
@@ -7,12 +8,23 @@ namespace KoalaRunBot {
 
   class BuildingPlacer {
     The& the;
-    std::vector<std::vector<bool>> _reserveMap;
+    BitGrid _reserveMap;
+
+    // Placement index: a summed-area table counting blocked tiles, where a tile is blocked
+    // if it is unbuildable terrain, reserved, or under one of our buildings.
+    // Any rectangle can then be tested for blocked tiles in O(1).
+    // Rebuilt lazily when reserved tiles or our buildings change.
+    mutable std::vector<int> _blockedSums; // (mapWidth+1) x (mapHeight+1), row-major
+    mutable bool _blockedDirty;
+    mutable int _blockedFrame; // when it was last rebuilt
 
     BuildingPlacer();
 
     void reserveSpaceNearResources();
 
+    void updateBlockedSums() const;
+    bool rectangleClear(int x1, int y1, int x2, int y2) const;
+
     // determines whether we can build at a given location
     bool canBuildHere(BWAPI::TilePosition position, const Building& b) const;
     bool canBuildHereWithSpace(BWAPI::TilePosition position, const Building& b, int buildDist) const;
@@ -35,6 +47,9 @@ namespace KoalaRunBot {
 
     void drawReservedTiles();
 
+    // Keep the placement index up to date.
+    void onUnitChange(BWAPI::Unit unit);
+
     BWAPI::TilePosition getRefineryPosition();
 
   };
@@ -5,6 +5,7 @@
 #include "Bases.h"
 #include "MapGrid.h"
 #include "Micro.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "UnitUtil.h"
 
@@ -102,27 +103,38 @@ void CombatCommander::update(const BWAPI::Unitset& combatUnits) {
   int frame8 = BWAPI::Broodwar->getFrameCount() % 8;
 
   if (frame8 == 1) {
-    updateIdleSquad();
-    updateOverlordSquad();
-    updateScourgeSquad();
-    updateDropSquads();
-    updateScoutDefenseSquad();
-    updateBaseDefenseSquads();
-    updateWatchSquads();
-    updateReconSquad();
-    updateAttackSquads();
+    PROFILE_ZONE("AssignSquads");
+    { PROFILE_ZONE("IdleSquad"); updateIdleSquad(); }
+    { PROFILE_ZONE("OverlordSquad"); updateOverlordSquad(); }
+    { PROFILE_ZONE("ScourgeSquad"); updateScourgeSquad(); }
+    { PROFILE_ZONE("DropSquads"); updateDropSquads(); }
+    { PROFILE_ZONE("ScoutDefense"); updateScoutDefenseSquad(); }
+    { PROFILE_ZONE("BaseDefense"); updateBaseDefenseSquads(); }
+    { PROFILE_ZONE("WatchSquads"); updateWatchSquads(); }
+    { PROFILE_ZONE("ReconSquad"); updateReconSquad(); }
+    { PROFILE_ZONE("AttackSquads"); updateAttackSquads(); }
   }
   else if (frame8 % 4 == 2) {
+    PROFILE_ZONE("ComsatScan");
     doComsatScan();
   }
 
-  loadOrUnloadBunkers();
+  {
+    PROFILE_ZONE("Bunkers");
+    loadOrUnloadBunkers();
+  }
 
   //the.ops.update();
 
-  _squadData.update(); // update() all the squads
+  {
+    PROFILE_ZONE("Squads");
+    _squadData.update(); // update() all the squads
+  }
 
-  cancelDyingItems();
+  {
+    PROFILE_ZONE("CancelDying");
+    cancelDyingItems();
+  }
 }
 
 void CombatCommander::updateIdleSquad() {
@@ -1369,12 +1381,16 @@ BWAPI::Position CombatCommander::getAttackLocation(const Squad* squad) {
   const int squadPartition = the.map_partitions_.id(Bases::Instance().myStartingBase()->getTilePosition());
 
   // Ground and air considerations.
+  // Large units like ultralisks and archons can't squeeze through every gap that smaller units can.
+  const BWAPI::Position squadHome = Bases::Instance().myStartingBase()->getPosition();
   bool hasGround = true;
+  BWAPI::UnitSizeType groundSize = BWAPI::UnitSizeTypes::Small;
   bool hasAir = false;
   bool canAttackGround = true;
   bool canAttackAir = false;
   if (squad) {
     hasGround = squad->hasGround();
+    groundSize = squad->groundSize();
     hasAir = squad->hasAir();
     canAttackGround = squad->canAttackGround();
     canAttackAir = squad->canAttackAir();
@@ -1388,7 +1404,9 @@ BWAPI::Position CombatCommander::getAttackLocation(const Squad* squad) {
     for (Base* base : Bases::Instance().getBases()) {
       if (base->getOwner() == BWAPI::Broodwar->enemy()) {
         // Ground squads ignore enemy bases which they cannot reach.
-        if (hasGround && squadPartition != the.map_partitions_.id(base->getTilePosition())) {
+        if (hasGround &&
+          (squadPartition != the.map_partitions_.id(base->getTilePosition()) ||
+            !the.map_partitions_.connected(squadHome, base->getPosition(), groundSize))) {
           continue;
         }
 
@@ -1436,7 +1454,10 @@ BWAPI::Position CombatCommander::getAttackLocation(const Squad* squad) {
       if (ui.type.isBuilding() &&
         ui.lastPosition.isValid() &&
         !ui.goneFromLastPosition &&
-        (!hasGround || (!ui.type.isRefinery() && squadPartition == the.map_partitions_.id(ui.lastPosition)))) {
+        (!hasGround ||
+          (!ui.type.isRefinery() &&
+            squadPartition == the.map_partitions_.id(ui.lastPosition) &&
+            the.map_partitions_.connected(squadHome, ui.lastPosition, groundSize)))) {
         if (ui.unit->exists() && ui.unit->isLifted()) {
           // The building is lifted. Only if the squad can hit it.
           if (canAttackAir) {
@@ -1,9 +1,16 @@
 #include "CombatSimulation.h"
+#include "AsyncWriter.h"
 #include "FAP.h"
 #include "UnitUtil.h"
 
 using namespace KoalaRunBot;
 
+int CombatSimulation::last_record_frame_ = -24;
+
+void CombatSimulation::StartGame() {
+  last_record_frame_ = -24;
+}
+
 bool CombatSimulation::IncludeEnemy(const CombatSimEnemies which, BWAPI::UnitType type) const {
   if (which == CombatSimEnemies::kAntiGroundEnemies) {
     // Ground enemies plus air enemies that can shoot down.
@@ -132,6 +139,24 @@ void CombatSimulation::SetCombatUnits(const BWAPI::Unitset& my_units
   */
 }
 
+// Save the engagement as a scenario for the FAPBench benchmark, at most once a second.
+// Implements config option IO::CombatSimRecordFilename.
+void CombatSimulation::RecordScenario() const {
+  const int frame = BWAPI::Broodwar->getFrameCount();
+  if (Config::IO::CombatSimRecordFilename.empty() || frame - last_record_frame_ < 24) {
+    return;
+  }
+  last_record_frame_ = frame;
+
+  // Scenario names are one word.
+  std::string name = BWAPI::Broodwar->mapFileName() + "@" + std::to_string(frame);
+  std::replace(name.begin(), name.end(), ' ', '_');
+
+  std::ostringstream scenario;
+  fap.writeScenario(scenario, name);
+  AsyncWriter::Instance().Append(Config::IO::CombatSimRecordFilename, scenario.str());
+}
+
 // Simulate combat and return the result as a score. Score >= 0 means you win.
 double CombatSimulation::SimulateCombat(const bool meat_grinder) const {
   const auto start_scores = fap.playerScores();
@@ -140,6 +165,8 @@ double CombatSimulation::SimulateCombat(const bool meat_grinder) const {
     return 0.0;
   }
 
+  RecordScenario();
+
   fap.simulate();
   const auto end_scores = fap.playerScores();
 
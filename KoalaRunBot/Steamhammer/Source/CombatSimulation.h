@@ -14,11 +14,17 @@ namespace KoalaRunBot {
   };
 
   class CombatSimulation {
+    static int last_record_frame_; // shared by all sims, since each lives only for one decision
+
     bool IncludeEnemy(CombatSimEnemies which, BWAPI::UnitType type) const;
+    void RecordScenario() const;
 
   public:
     CombatSimulation() = default;
 
+    // Reset the recording schedule. The client may play many games in one process.
+    static void StartGame();
+
     void SetCombatUnits(const BWAPI::Unitset& my_units
                         , const BWAPI::Position& center
                         , int radius
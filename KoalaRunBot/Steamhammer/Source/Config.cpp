@@ -16,10 +16,19 @@ namespace Config {
   namespace IO {
     std::string ErrorLogFilename = "Steamhammer_ErrorLog.txt";
     bool LogAssertToErrorFile = false;
+    std::string EventLogFilename = "Steamhammer_EventLog.txt";
+    std::string EventLogLevel = "info";
+    std::string EventLogSubsystems = "all";
+    std::string ProfileFilename = "";      // empty to skip the profile summary
+    std::string ProfileTraceFilename = ""; // empty to skip the Chrome trace of slow frames
+    std::string CombatSimRecordFilename = ""; // empty to not record combat sim scenarios
+    std::string BOSSCorpusFilename = "";      // empty to not record build order search cases
+    std::string BuildOrderTableFilename = ""; // empty to search for every build order
 
     std::string ReadDir = "bwapi-data/read/";
     std::string WriteDir = "bwapi-data/write/";
     int MaxGameRecords = 0;
+    int EndWriteTimeout = 500; // milliseconds
     bool ReadOpponentModel = false;
     bool WriteOpponentModel = false;
   }
@@ -72,6 +81,7 @@ namespace Config {
     bool DrawEnemyUnitInfo = false;
     bool DrawMapInfo = false;
     bool DrawMapGrid = false;
+    bool DrawThreatMap = false;
     bool DrawMapDistances = false;
     bool DrawBaseInfo = false;
     bool DrawStrategyBossInfo = false;
@@ -98,6 +108,7 @@ namespace Config {
 
   namespace Macro {
     int BOSSFrameLimit = 160;
+    int FrameBudget = 35; // milliseconds per frame for manager updates
     int WorkersPerRefinery = 3;
     double WorkersPerPatch = 3.0;
     int AbsoluteMaxWorkers = 75;
@@ -109,5 +120,6 @@ namespace Config {
 
   namespace Tools {
     extern int MAP_GRID_SIZE = 320; // size of grid spacing in MapGrid
+    bool WalkDistances = false;     // bases get walk tile distances at startup, used for mineral trips
   }
 }
@@ -23,10 +23,19 @@ namespace Config
 	{
 		extern std::string ErrorLogFilename;
 		extern bool LogAssertToErrorFile;
+		extern std::string EventLogFilename;
+		extern std::string EventLogLevel;
+		extern std::string EventLogSubsystems;
+		extern std::string ProfileFilename;
+		extern std::string ProfileTraceFilename;
+		extern std::string CombatSimRecordFilename;
+		extern std::string BOSSCorpusFilename;
+		extern std::string BuildOrderTableFilename;
 
 		extern std::string ReadDir;
 		extern std::string WriteDir;
 		extern int MaxGameRecords;
+		extern int EndWriteTimeout;
 		extern bool ReadOpponentModel;
 		extern bool WriteOpponentModel;
 	}
@@ -72,6 +81,7 @@ namespace Config
 		extern bool DrawUnitOrders;
 		extern bool DrawMapInfo;
 		extern bool DrawMapGrid;
+		extern bool DrawThreatMap;
 		extern bool DrawMapDistances;
 		extern bool DrawBaseInfo;
 		extern bool DrawStrategyBossInfo;
@@ -102,6 +112,7 @@ namespace Config
     namespace Macro
     {
         extern int BOSSFrameLimit;
+        extern int FrameBudget;
         extern int WorkersPerRefinery;
 		extern double WorkersPerPatch;
 		extern int AbsoluteMaxWorkers;
@@ -114,5 +125,6 @@ namespace Config
     namespace Tools
     {
         extern int MAP_GRID_SIZE;
+        extern bool WalkDistances;
     }
 }
\ No newline at end of file
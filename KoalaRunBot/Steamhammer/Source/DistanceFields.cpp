@@ -0,0 +1,255 @@
+#include "DistanceFields.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "Bases.h"
+#include "InformationManager.h"
+#include "MapTools.h"
+
+using namespace KoalaRunBot;
+
+const int DistanceFields::kNumLayers;
+
+DistanceFields::DistanceFields()
+	: width_(0)
+	, height_(0)
+{
+}
+
+void DistanceFields::Initialize()
+{
+	width_ = BWAPI::Broodwar->mapWidth();
+	height_ = BWAPI::Broodwar->mapHeight();
+
+	fields_.assign(kNumLayers, Field());
+	fields_[int(Layer::kEnemyBases)].ground_ = true;
+	fields_[int(Layer::kGroundStaticDefense)].ground_ = true;
+	fields_[int(Layer::kAirStaticDefense)].ground_ = false;
+	fields_[int(Layer::kShieldBatteries)].ground_ = false;
+
+	for (Field& field : fields_)
+	{
+		Compute(field);
+	}
+	fringe_.reserve(width_ * height_);
+}
+
+// Breadth-first search from all the sources at once. Each tile takes the distance and the
+// source index of the first source to reach it. Ties go to the source listed first.
+void DistanceFields::Compute(Field& field)
+{
+	field.distance_.assign(width_ * height_, -1);
+	field.nearest_.assign(width_ * height_, -1);
+	fringe_.clear();
+
+	for (size_t i = 0; i < field.sources_.size(); ++i)
+	{
+		const BWAPI::TilePosition& tile = field.sources_[i];
+		if (tile.isValid() && field.distance_[Index(tile)] < 0)
+		{
+			field.distance_[Index(tile)] = 0;
+			field.nearest_[Index(tile)] = short(i);
+			fringe_.push_back(Index(tile));
+		}
+	}
+
+	const int actionX[4] = { 1, -1, 0, 0 };
+	const int actionY[4] = { 0, 0, 1, -1 };
+
+	for (size_t head = 0; head < fringe_.size(); ++head)
+	{
+		const int index = fringe_[head];
+		const int x = index / height_;
+		const int y = index % height_;
+
+		for (int a = 0; a < 4; ++a)
+		{
+			const BWAPI::TilePosition next(x + actionX[a], y + actionY[a]);
+			if (next.isValid() &&
+				field.distance_[Index(next)] < 0 &&
+				(!field.ground_ || MapTools::Instance().isWalkable(next)))
+			{
+				field.distance_[Index(next)] = field.distance_[index] + 1;
+				field.nearest_[Index(next)] = field.nearest_[index];
+				fringe_.push_back(Index(next));
+			}
+		}
+	}
+}
+
+// Sort the sources so that the same set always comes in the same order, whatever order the
+// unit set gives them in. The units are refreshed every time, the field only if the tiles changed.
+void DistanceFields::SetUnits(Layer layer, std::vector<std::pair<BWAPI::TilePosition, BWAPI::Unit>>& sources)
+{
+	std::sort(sources.begin(), sources.end(), [](const std::pair<BWAPI::TilePosition, BWAPI::Unit>& a,
+	                                             const std::pair<BWAPI::TilePosition, BWAPI::Unit>& b)
+	{
+		if (a.first.x != b.first.x)
+		{
+			return a.first.x < b.first.x;
+		}
+		if (a.first.y != b.first.y)
+		{
+			return a.first.y < b.first.y;
+		}
+		return a.second->getID() < b.second->getID();
+	});
+
+	Field& field = fields_[int(layer)];
+	std::vector<BWAPI::TilePosition> tiles;
+	field.units_.clear();
+	for (const auto& source : sources)
+	{
+		tiles.push_back(source.first);
+		field.units_.push_back(source.second);
+	}
+
+	if (tiles != field.sources_)
+	{
+		field.sources_.swap(tiles);
+		Compute(field);
+	}
+}
+
+void DistanceFields::Update()
+{
+	if (width_ == 0)
+	{
+		return;
+	}
+
+	// Enemy bases. Bases keeps them in a fixed order.
+	{
+		Field& field = fields_[int(Layer::kEnemyBases)];
+		std::vector<BWAPI::TilePosition> tiles;
+		field.bases_.clear();
+		for (Base* base : Bases::Instance().getBases())
+		{
+			if (base->getOwner() == BWAPI::Broodwar->enemy())
+			{
+				tiles.push_back(base->getTilePosition());
+				field.bases_.push_back(base);
+			}
+		}
+		if (tiles != field.sources_)
+		{
+			field.sources_.swap(tiles);
+			Compute(field);
+		}
+	}
+
+	// Our static defense.
+	// NOTE This assumes that we only put marines into a bunker: If it is loaded, it can shoot
+	// ground and air. If we ever put firebats or SCVs or medics into a bunker, we'll have to
+	// do a fancier check.
+	std::vector<std::pair<BWAPI::TilePosition, BWAPI::Unit>> ground;
+	std::vector<std::pair<BWAPI::TilePosition, BWAPI::Unit>> air;
+	std::vector<std::pair<BWAPI::TilePosition, BWAPI::Unit>> batteries;
+	for (BWAPI::Unit building : InformationManager::Instance().getStaticDefense())
+	{
+		const BWAPI::UnitType type = building->getType();
+		const bool loadedBunker = type == BWAPI::UnitTypes::Terran_Bunker && !building->getLoadedUnits().empty();
+		const std::pair<BWAPI::TilePosition, BWAPI::Unit> source(building->getTilePosition(), building);
+
+		if (loadedBunker ||
+			type == BWAPI::UnitTypes::Protoss_Photon_Cannon ||
+			type == BWAPI::UnitTypes::Zerg_Sunken_Colony)
+		{
+			ground.push_back(source);
+		}
+		if (loadedBunker ||
+			type == BWAPI::UnitTypes::Terran_Missile_Turret ||
+			type == BWAPI::UnitTypes::Protoss_Photon_Cannon ||
+			type == BWAPI::UnitTypes::Zerg_Spore_Colony)
+		{
+			air.push_back(source);
+		}
+		if (type == BWAPI::UnitTypes::Protoss_Shield_Battery)
+		{
+			batteries.push_back(source);
+		}
+	}
+	SetUnits(Layer::kGroundStaticDefense, ground);
+	SetUnits(Layer::kAirStaticDefense, air);
+	SetUnits(Layer::kShieldBatteries, batteries);
+}
+
+int DistanceFields::Distance(Layer layer, const BWAPI::TilePosition& tile) const
+{
+	if (!tile.isValid() || width_ == 0)
+	{
+		return -1;
+	}
+	return fields_[int(layer)].distance_[Index(tile)];
+}
+
+Base* DistanceFields::NearestBase(Layer layer, const BWAPI::TilePosition& tile) const
+{
+	if (!tile.isValid() || width_ == 0)
+	{
+		return nullptr;
+	}
+	const Field& field = fields_[int(layer)];
+	const int nearest = field.nearest_[Index(tile)];
+	return nearest >= 0 && nearest < int(field.bases_.size()) ? field.bases_[nearest] : nullptr;
+}
+
+// A ground layer has no entry for a tile that is not entirely walkable, such as a ramp or cliff
+// edge or a tile next to minerals, which is where static defense often stands. Then take the
+// entry of the nearest walkable neighbor.
+// If there is still no answer, because no source can be reached from here or the unit was
+// destroyed since the last update, fall back to the source nearest in a straight line.
+// So the result is null only if the layer has no live sources.
+BWAPI::Unit DistanceFields::NearestUnit(Layer layer, const BWAPI::TilePosition& tile) const
+{
+	if (!tile.isValid() || width_ == 0)
+	{
+		return nullptr;
+	}
+	const Field& field = fields_[int(layer)];
+	int nearest = field.nearest_[Index(tile)];
+
+	if (nearest < 0 && field.ground_)
+	{
+		int bestDist = -1;
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				const BWAPI::TilePosition next(tile.x + dx, tile.y + dy);
+				if (next.isValid())
+				{
+					const int dist = field.distance_[Index(next)];
+					if (dist >= 0 && (bestDist < 0 || dist < bestDist))
+					{
+						bestDist = dist;
+						nearest = field.nearest_[Index(next)];
+					}
+				}
+			}
+		}
+	}
+
+	if (nearest >= 0 && nearest < int(field.units_.size()) && field.units_[nearest]->exists())
+	{
+		return field.units_[nearest];
+	}
+
+	const BWAPI::Position center = BWAPI::Position(tile) + BWAPI::Position(16, 16);
+	BWAPI::Unit closest = nullptr;
+	int closestDist = INT_MAX;
+	for (BWAPI::Unit unit : field.units_)
+	{
+		if (unit->exists())
+		{
+			const int dist = unit->getDistance(center);
+			if (dist < closestDist)
+			{
+				closestDist = dist;
+				closest = unit;
+			}
+		}
+	}
+	return closest;
+}
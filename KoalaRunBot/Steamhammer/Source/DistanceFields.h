@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace KoalaRunBot {
+  class Base;
+
+  // Multi-source distance fields for "which of these is nearest to here" queries.
+  // Each layer holds, for every tile, the Manhattan tile distance to the nearest of its sources
+  // and which source that is, found by one breadth-first search out of all the sources at once.
+  // Ground layers spread over walkable tiles like GridDistances. Air layers spread everywhere.
+  // Update() collects each layer's sources and searches again only if they changed.
+  class DistanceFields {
+  public:
+    enum class Layer {
+      kEnemyBases,           // ground, bases the enemy owns
+      kGroundStaticDefense,  // ground, our static defense that can hit ground
+      kAirStaticDefense,     // air, our static defense that can hit air
+      kShieldBatteries,      // air, our shield batteries
+    };
+    static const int kNumLayers = 4;
+
+  private:
+    struct Field {
+      bool ground_;
+      std::vector<BWAPI::TilePosition> sources_;
+      std::vector<Base*> bases_;             // parallel to sources_, for base layers
+      std::vector<BWAPI::Unit> units_;       // parallel to sources_, for unit layers
+      std::vector<short> distance_;          // -1 if no source is reachable
+      std::vector<short> nearest_;           // index into sources_, -1 if none is reachable
+    };
+
+    int width_;
+    int height_;
+    std::vector<Field> fields_;
+    std::vector<int> fringe_;
+
+    int Index(const BWAPI::TilePosition& tile) const { return tile.x * height_ + tile.y; }
+    void Compute(Field& field);
+    void SetUnits(Layer layer, std::vector<std::pair<BWAPI::TilePosition, BWAPI::Unit>>& sources);
+
+  public:
+    DistanceFields();
+
+    void Initialize();
+    void Update();
+
+    // -1 if no source of the layer is reachable.
+    int Distance(Layer layer, const BWAPI::TilePosition& tile) const;
+
+    // The nearest source, or null if none is reachable.
+    Base* NearestBase(Layer layer, const BWAPI::TilePosition& tile) const;
+
+    // The nearest source. Falls back to straight-line distance where the field has no answer,
+    // so null only if the layer has no live sources.
+    BWAPI::Unit NearestUnit(Layer layer, const BWAPI::TilePosition& tile) const;
+  };
+}
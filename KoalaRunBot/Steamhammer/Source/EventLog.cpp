@@ -0,0 +1,137 @@
+#include "EventLog.h"
+
+#include "AsyncWriter.h"
+#include "Common.h"
+
+#include <cstdio>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+using namespace KoalaRunBot;
+
+static const char* const kSubsystemNames[] = {
+	"general", "workers", "production", "buildings", "strategy", "combat", "micro", "scouting", "map", "opponent", "search"
+};
+
+static const char* const kSeverityNames[] = { "debug", "info", "warning", "error" };
+
+static bool crash_filter_installed = false;
+static LPTOP_LEVEL_EXCEPTION_FILTER previous_crash_filter = nullptr;
+
+// Write out what led up to the crash, then let the crash go on as it would have.
+static LONG WINAPI CrashFilter(EXCEPTION_POINTERS* info) {
+	EventLog::Instance().DumpNow("crash");
+	return previous_crash_filter ? previous_crash_filter(info) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+EventLog::EventLog()
+	: events_(kCapacity)
+	, next_(0)
+	, dumped_(0)
+	, min_severity_(int(EventSeverity::Info))
+	, subsystem_mask_((1u << int(EventSubsystem::Size)) - 1) {
+}
+
+void EventLog::Configure(const std::string& level, const std::string& subsystems) {
+	for (int i = 0; i < int(EventSeverity::Size); ++i) {
+		if (level == kSeverityNames[i]) {
+			min_severity_ = i;
+		}
+	}
+
+	if (subsystems == "all") {
+		subsystem_mask_ = (1u << int(EventSubsystem::Size)) - 1;
+		return;
+	}
+	subsystem_mask_ = 0;
+	std::stringstream names(subsystems);
+	std::string name;
+	while (std::getline(names, name, ',')) {
+		name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+		for (int i = 0; i < int(EventSubsystem::Size); ++i) {
+			if (name == kSubsystemNames[i]) {
+				subsystem_mask_ |= 1u << i;
+			}
+		}
+	}
+}
+
+void EventLog::Add(const EventSubsystem subsystem, const EventSeverity severity, const int id,
+                   const int a, const int b, const int c, const float x, const float y) {
+	const unsigned n = next_.load(std::memory_order_relaxed);
+	Event& event = events_[n % kCapacity];
+	event.frame_ = BWAPI::BroodwarPtr ? BWAPI::Broodwar->getFrameCount() : -1;
+	event.subsystem_ = uint8_t(subsystem);
+	event.severity_ = uint8_t(severity);
+	event.id_ = uint16_t(id);
+	event.args_[0] = a;
+	event.args_[1] = b;
+	event.args_[2] = c;
+	event.x_ = x;
+	event.y_ = y;
+	next_.store(n + 1, std::memory_order_release);
+}
+
+// One line per event: frame subsystem severity id a b c x y
+std::string EventLog::Format(const std::string& reason, const unsigned from, const unsigned to) const {
+	std::ostringstream out;
+	out << "# " << reason << ", events " << from << " to " << to << '\n';
+	for (unsigned i = from; i < to; ++i) {
+		const Event& event = events_[i % kCapacity];
+		out << event.frame_ << ' '
+			<< SubsystemName(EventSubsystem(event.subsystem_)) << ' '
+			<< SeverityName(EventSeverity(event.severity_)) << ' '
+			<< event.id_ << ' '
+			<< event.args_[0] << ' ' << event.args_[1] << ' ' << event.args_[2] << ' '
+			<< event.x_ << ' ' << event.y_ << '\n';
+	}
+	return out.str();
+}
+
+// The text of the events not dumped yet, and mark them dumped. Events older than the buffer are gone.
+std::string EventLog::TakeUndumped(const std::string& reason) {
+	const unsigned to = next_.load(std::memory_order_acquire);
+	const unsigned from = std::max(dumped_, to > unsigned(kCapacity) ? to - kCapacity : 0);
+	dumped_ = to;
+	return from < to ? Format(reason, from, to) : "";
+}
+
+void EventLog::Dump(const std::string& reason) {
+	const std::string text = TakeUndumped(reason);
+	if (!text.empty()) {
+		AsyncWriter::Instance().Append(Config::IO::EventLogFilename, text);
+	}
+}
+
+void EventLog::DumpNow(const std::string& reason) {
+	const std::string text = TakeUndumped(reason);
+	if (!text.empty()) {
+		FILE* file = fopen(Config::IO::EventLogFilename.c_str(), "a");
+		if (file) {
+			fwrite(text.data(), 1, text.size(), file);
+			fclose(file);
+		}
+	}
+}
+
+void EventLog::InstallCrashHandler() {
+	if (!crash_filter_installed) {
+		previous_crash_filter = SetUnhandledExceptionFilter(CrashFilter);
+		crash_filter_installed = true;
+	}
+}
+
+const char* EventLog::SubsystemName(const EventSubsystem subsystem) {
+	return int(subsystem) < int(EventSubsystem::Size) ? kSubsystemNames[int(subsystem)] : "?";
+}
+
+const char* EventLog::SeverityName(const EventSeverity severity) {
+	return int(severity) < int(EventSeverity::Size) ? kSeverityNames[int(severity)] : "?";
+}
+
+EventLog& EventLog::Instance() {
+	static EventLog instance;
+	return instance;
+}
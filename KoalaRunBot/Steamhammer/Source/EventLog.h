@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace KoalaRunBot {
+  enum class EventSubsystem { General, Workers, Production, Buildings, Strategy, Combat, Micro, Scouting, Map, OpponentModel, Search, Size };
+  enum class EventSeverity { Debug, Info, Warning, Error, Size };
+
+  // A cheap in-memory log of small binary events, for diagnosing production games.
+  // Logging an event fills one slot of a fixed ring buffer: no formatting, no allocation, no I/O.
+  // The buffer keeps the most recent kCapacity events and is written out as text on demand:
+  // at game end, on an assertion failure, or from the crash handler.
+  // Only the frame thread logs. A dump may come from a crash handler on any thread, so
+  // the write position is atomic and a dump reads only completed slots.
+  class EventLog {
+  public:
+    static const int kCapacity = 8192;
+
+    struct Event {
+      int frame_;
+      uint8_t subsystem_;
+      uint8_t severity_;
+      uint16_t id_; // meaning is up to the subsystem
+      int args_[3];
+      float x_;
+      float y_;
+    };
+
+  private:
+    std::vector<Event> events_;
+    std::atomic<unsigned> next_; // count of events ever logged
+    unsigned dumped_; // events before this have been dumped already
+
+    int min_severity_;
+    unsigned subsystem_mask_;
+
+    EventLog();
+
+    std::string Format(const std::string& reason, unsigned from, unsigned to) const;
+    std::string TakeUndumped(const std::string& reason);
+
+  public:
+    // level is debug, info, warning or error. subsystems is "all" or a comma separated list of names.
+    void Configure(const std::string& level, const std::string& subsystems);
+
+    bool Enabled(EventSubsystem subsystem, EventSeverity severity) const {
+      return int(severity) >= min_severity_ && (subsystem_mask_ >> int(subsystem) & 1) != 0;
+    }
+
+    void Log(EventSubsystem subsystem, EventSeverity severity, int id,
+             int a = 0, int b = 0, int c = 0, float x = 0.0f, float y = 0.0f) {
+      if (Enabled(subsystem, severity)) {
+        Add(subsystem, severity, id, a, b, c, x, y);
+      }
+    }
+
+    void Add(EventSubsystem subsystem, EventSeverity severity, int id, int a, int b, int c, float x, float y);
+
+    // Append the events not yet dumped to the event log file, in the background.
+    void Dump(const std::string& reason);
+
+    // The same, but write the file at once on this thread. For when the bot is going down.
+    void DumpNow(const std::string& reason);
+
+    void InstallCrashHandler();
+
+    static const char* SubsystemName(EventSubsystem subsystem);
+    static const char* SeverityName(EventSeverity severity);
+
+    static EventLog& Instance();
+  };
+}
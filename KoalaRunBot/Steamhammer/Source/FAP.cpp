@@ -14,7 +14,77 @@ KoalaRunBot::FastApproximation fap;
 
 namespace KoalaRunBot {
 
-  FastApproximation::FastApproximation() { }
+  FAPPlayer::FAPPlayer() {
+    std::fill(levels, levels + BWAPI::UpgradeTypes::Enum::MAX, 0);
+  }
+
+  void FAPPlayer::setUpgradeLevel(BWAPI::UpgradeType upgrade, int level) {
+    if (upgrade.getID() >= 0 && upgrade.getID() < BWAPI::UpgradeTypes::Enum::MAX)
+      levels[upgrade.getID()] = level;
+  }
+
+  int FAPPlayer::getUpgradeLevel(BWAPI::UpgradeType upgrade) const {
+    if (upgrade.getID() >= 0 && upgrade.getID() < BWAPI::UpgradeTypes::Enum::MAX)
+      return levels[upgrade.getID()];
+    return 0;
+  }
+
+  int FAPPlayer::damage(BWAPI::WeaponType weapon) const {
+    const int amount = weapon.damageAmount() + getUpgradeLevel(weapon.upgradeType()) * weapon.damageBonus();
+    return amount * weapon.damageFactor();
+  }
+
+  int FAPPlayer::armor(BWAPI::UnitType type) const {
+    int armor = type.armor() + getUpgradeLevel(type.armorUpgrade());
+    if (type == BWAPI::UnitTypes::Zerg_Ultralisk && getUpgradeLevel(BWAPI::UpgradeTypes::Chitinous_Plating))
+      armor += 2;
+    return armor;
+  }
+
+  double FAPPlayer::topSpeed(BWAPI::UnitType type) const {
+    double speed = type.topSpeed();
+    if ((type == BWAPI::UnitTypes::Terran_Vulture && getUpgradeLevel(BWAPI::UpgradeTypes::Ion_Thrusters)) ||
+        (type == BWAPI::UnitTypes::Zerg_Overlord && getUpgradeLevel(BWAPI::UpgradeTypes::Pneumatized_Carapace)) ||
+        (type == BWAPI::UnitTypes::Zerg_Zergling && getUpgradeLevel(BWAPI::UpgradeTypes::Metabolic_Boost)) ||
+        (type == BWAPI::UnitTypes::Zerg_Hydralisk && getUpgradeLevel(BWAPI::UpgradeTypes::Muscular_Augments)) ||
+        (type == BWAPI::UnitTypes::Zerg_Ultralisk && getUpgradeLevel(BWAPI::UpgradeTypes::Anabolic_Synthesis)) ||
+        (type == BWAPI::UnitTypes::Protoss_Zealot && getUpgradeLevel(BWAPI::UpgradeTypes::Leg_Enhancements)) ||
+        (type == BWAPI::UnitTypes::Protoss_Shuttle && getUpgradeLevel(BWAPI::UpgradeTypes::Gravitic_Drive)) ||
+        (type == BWAPI::UnitTypes::Protoss_Observer && getUpgradeLevel(BWAPI::UpgradeTypes::Gravitic_Boosters)) ||
+        (type == BWAPI::UnitTypes::Protoss_Scout && getUpgradeLevel(BWAPI::UpgradeTypes::Gravitic_Thrusters))) {
+      if (type == BWAPI::UnitTypes::Protoss_Scout)
+        speed += 427.0 / 256.0;
+      else
+        speed *= 1.5;
+      speed = std::max(speed, 853.0 / 256.0);
+    }
+    return speed;
+  }
+
+  int FAPPlayer::weaponMaxRange(BWAPI::WeaponType weapon) const {
+    int range = weapon.maxRange();
+    if ((weapon == BWAPI::WeaponTypes::Gauss_Rifle && getUpgradeLevel(BWAPI::UpgradeTypes::U_238_Shells)) ||
+        (weapon == BWAPI::WeaponTypes::Needle_Spines && getUpgradeLevel(BWAPI::UpgradeTypes::Grooved_Spines)))
+      range += 32;
+    else if (weapon == BWAPI::WeaponTypes::Phase_Disruptor && getUpgradeLevel(BWAPI::UpgradeTypes::Singularity_Charge))
+      range += 64;
+    else if (weapon == BWAPI::WeaponTypes::Hellfire_Missile_Pack && getUpgradeLevel(BWAPI::UpgradeTypes::Charon_Boosters))
+      range += 96;
+    return range;
+  }
+
+  int FAPPlayer::weaponDamageCooldown(BWAPI::UnitType type) const {
+    int cooldown = type.groundWeapon().damageCooldown();
+    if (type == BWAPI::UnitTypes::Zerg_Zergling && getUpgradeLevel(BWAPI::UpgradeTypes::Adrenal_Glands))
+      cooldown = std::max(5, cooldown / 2);
+    return cooldown;
+  }
+
+  FastApproximation::FastApproximation()
+    : didSomething(false)
+    , fixedPoint(false)
+    , trace(nullptr)
+    , chosenTarget(-1) { }
 
   void FastApproximation::addUnitPlayer1(FAPUnit fu) {
     player1.push_back(fu);
@@ -34,7 +104,8 @@ namespace KoalaRunBot {
       addUnitPlayer2(fu);
   }
 
-  void FastApproximation::simulate(int n_frames) {
+  int FastApproximation::simulate(int n_frames) {
+    int frames = 0;
     while (n_frames--) {
       if (player1.empty() || player2.empty())
         break;
@@ -42,10 +113,14 @@ namespace KoalaRunBot {
       didSomething = false;
 
       Isimulate();
+      ++frames;
+      if (trace)
+        trace->endFrame(player1, player2);
 
       if (!didSomething)
         break;
     }
+    return frames;
   }
 
   std::pair<int, int> FastApproximation::playerScores() const {
@@ -99,6 +174,29 @@ namespace KoalaRunBot {
     player1.clear(), player2.clear();
   }
 
+  // The scenario format is read by the FAPBench program. Hit points go back to unscaled values.
+  // Whether a unit is stimmed is not kept, so it is not written.
+  void FastApproximation::writeScenario(std::ostream& out, const std::string& name) const {
+    out << "scenario " << name << '\n';
+
+    const std::vector<FAPUnit>* sides[2] = {&player1, &player2};
+    for (int side = 0; side < 2; ++side) {
+      const std::vector<FAPUnit>& units = *sides[side];
+      if (!units.empty() && units.front().player) {
+        for (BWAPI::UpgradeType upgrade : BWAPI::UpgradeTypes::allUpgradeTypes()) {
+          const int level = units.front().player->getUpgradeLevel(upgrade);
+          if (level > 0)
+            out << "upgrade " << side + 1 << ' ' << upgrade.getName() << ' ' << level << '\n';
+        }
+      }
+      for (auto& u : units)
+        out << "unit " << side + 1 << ' ' << u.unitType.getName() << ' ' << u.x << ' ' << u.y << ' '
+          << u.health / 2 << ' ' << u.shields / 2 << '\n';
+    }
+
+    out << "end\n";
+  }
+
   void FastApproximation::dealDamage(const FastApproximation::FAPUnit& fu, int damage,
                                      BWAPI::DamageType damageType) const {
     if (fu.shields >= damage - fu.shieldArmor) {
@@ -183,7 +281,10 @@ namespace KoalaRunBot {
       }
     }
 
-    if (closest_enemy != enemyUnits.end() && sqrt(closest_dist) <= fu.speed && !(fu.x == closest_enemy->x && fu.y ==
+    if (closest_enemy != enemyUnits.end())
+      chosenTarget = int(closest_enemy - enemyUnits.begin());
+
+    if (closest_enemy != enemyUnits.end() && withinMove(fu, closest_dist) && !(fu.x == closest_enemy->x && fu.y ==
       closest_enemy->y)) {
       fu.x = closest_enemy->x;
       fu.y = closest_enemy->y;
@@ -213,11 +314,8 @@ namespace KoalaRunBot {
       didSomething = true;
       return;
     }
-    else if (closest_enemy != enemyUnits.end() && sqrt(closest_dist) > fu.speed) {
-      int dx = closest_enemy->x - fu.x, dy = closest_enemy->y - fu.y;
-
-      fu.x += (int)(dx * (fu.speed / sqrt(dx * dx + dy * dy)));
-      fu.y += (int)(dy * (fu.speed / sqrt(dx * dx + dy * dy)));
+    else if (closest_enemy != enemyUnits.end() && !withinMove(fu, closest_dist)) {
+      moveToward(fu, *closest_enemy);
 
       didSomething = true;
       return;
@@ -239,6 +337,7 @@ namespace KoalaRunBot {
     }
 
     if (closest_heal_able != friendlyUnits.end()) {
+      chosenTarget = int(closest_heal_able - friendlyUnits.begin());
       fu.x = closest_heal_able->x;
       fu.y = closest_heal_able->y;
 
@@ -279,7 +378,10 @@ namespace KoalaRunBot {
       }
     }
 
-    if (closestEnemy != enemyUnits.end() && sqrt(closestDist) <= fu.speed) {
+    if (closestEnemy != enemyUnits.end())
+      chosenTarget = int(closestEnemy - enemyUnits.begin());
+
+    if (closestEnemy != enemyUnits.end() && withinMove(fu, closestDist)) {
       if (closestEnemy->flying)
         dealDamage(*closestEnemy, fu.airDamage, fu.airDamageType);
       else
@@ -295,11 +397,8 @@ namespace KoalaRunBot {
       didSomething = true;
       return true;
     }
-    else if (closestEnemy != enemyUnits.end() && sqrt(closestDist) > fu.speed) {
-      const auto dx = closestEnemy->x - fu.x, dy = closestEnemy->y - fu.y;
-
-      fu.x += static_cast<int>(dx * (fu.speed / sqrt(dx * dx + dy * dy)));
-      fu.y += static_cast<int>(dy * (fu.speed / sqrt(dx * dx + dy * dy)));
+    else if (closestEnemy != enemyUnits.end() && !withinMove(fu, closestDist)) {
+      moveToward(fu, *closestEnemy);
 
       didSomething = true;
     }
@@ -309,8 +408,11 @@ namespace KoalaRunBot {
 
   void FastApproximation::Isimulate() {
     for (auto fu = player1.begin(); fu != player1.end();) {
+      const int unit = int(fu - player1.begin());
+      chosenTarget = -1;
       if (IsSuicideUnit(fu->unitType)) {
         bool result = suicideSim(*fu, player2);
+        recordChoice(0, unit);
         if (result)
           fu = player1.erase(fu);
         else
@@ -321,13 +423,17 @@ namespace KoalaRunBot {
           Medicsim(*fu, player1);
         else
           UnitSim(*fu, player2);
+        recordChoice(0, unit);
         ++fu;
       }
     }
 
     for (auto fu = player2.begin(); fu != player2.end();) {
+      const int unit = int(fu - player2.begin());
+      chosenTarget = -1;
       if (IsSuicideUnit(fu->unitType)) {
         bool result = suicideSim(*fu, player1);
+        recordChoice(1, unit);
         if (result)
           fu = player2.erase(fu);
         else
@@ -338,6 +444,7 @@ namespace KoalaRunBot {
           Medicsim(*fu, player2);
         else
           UnitSim(*fu, player1);
+        recordChoice(1, unit);
         ++fu;
       }
     }
@@ -357,6 +464,51 @@ namespace KoalaRunBot {
     }
   }
 
+  // Whether the unit can reach a point at this squared distance in one frame.
+  bool FastApproximation::withinMove(const FAPUnit& fu, int dist) const {
+    if (fixedPoint)
+      return int64_t(dist) * 256 * 256 <= int64_t(fu.fixedSpeed) * fu.fixedSpeed;
+    return sqrt(dist) <= fu.speed;
+  }
+
+  // Move one frame's worth toward the target, which is out of reach.
+  // Both modes round toward zero. Fixed point takes the distance to 1/16 pixel.
+  void FastApproximation::moveToward(const FAPUnit& fu, const FAPUnit& target) const {
+    const int dx = target.x - fu.x, dy = target.y - fu.y;
+
+    if (fixedPoint) {
+      const int64_t scale = int64_t(16) * isqrt(int64_t(dx * dx + dy * dy) * 256);
+      fu.x += int(dx * int64_t(fu.fixedSpeed) / scale);
+      fu.y += int(dy * int64_t(fu.fixedSpeed) / scale);
+    }
+    else {
+      fu.x += (int)(dx * (fu.speed / sqrt(dx * dx + dy * dy)));
+      fu.y += (int)(dy * (fu.speed / sqrt(dx * dx + dy * dy)));
+    }
+  }
+
+  // Integer square root, rounded down, bit by bit.
+  int64_t FastApproximation::isqrt(int64_t n) {
+    uint64_t rest = uint64_t(n), root = 0, bit = uint64_t(1) << 62;
+    while (bit > rest)
+      bit >>= 2;
+    while (bit) {
+      if (rest >= root + bit) {
+        rest -= root + bit;
+        root = (root >> 1) + bit;
+      }
+      else
+        root >>= 1;
+      bit >>= 2;
+    }
+    return int64_t(root);
+  }
+
+  void FastApproximation::recordChoice(int side, int unit) const {
+    if (trace && chosenTarget >= 0)
+      trace->addChoice(side, unit, chosenTarget);
+  }
+
   void FastApproximation::unitDeath(const FAPUnit& fu, std::vector<FAPUnit>& itsFriendlies) {
     if (fu.unitType == BWAPI::UnitTypes::Terran_Bunker) {
       ConvertToUnitType(fu, BWAPI::UnitTypes::Terran_Marine);
@@ -367,6 +519,16 @@ namespace KoalaRunBot {
   }
 
   void FastApproximation::ConvertToUnitType(const FAPUnit& fu, BWAPI::UnitType ut) {
+    // Health and shields stay 0, as in a UnitInfo that was never filled in.
+    if (fu.standIn) {
+      FAPUnit funew(*fu.standIn, ut, fu.x, fu.y, 0, 0);
+      funew.attackCooldownRemaining = fu.attackCooldownRemaining;
+      funew.elevation = fu.elevation;
+
+      fu.operator=(funew);
+      return;
+    }
+
     KoalaRunBot::UnitInfo ui;
     ui.lastPosition = BWAPI::Position(fu.x, fu.y);
     ui.player = fu.player;
@@ -379,40 +541,88 @@ namespace KoalaRunBot {
     fu.operator=(funew);
   }
 
+  // The stats that depend on upgrades. P is BWAPI::PlayerInterface or FAPPlayer.
+  template <class P>
+  void FastApproximation::FAPUnit::setStats(const P& player) const {
+    speed = player.topSpeed(unitType);
+    fixedSpeed = int(speed * 256.0 + 0.5);
+    shieldArmor = player.getUpgradeLevel(BWAPI::UpgradeTypes::Protoss_Plasma_Shields);
+    armor = player.armor(unitType);
+
+    groundDamage = player.damage(unitType.groundWeapon());
+    groundCooldown = unitType.groundWeapon().damageFactor() && unitType.maxGroundHits()
+                       ? player.weaponDamageCooldown(unitType) / (unitType.groundWeapon().damageFactor() * unitType.
+                                                                                                        maxGroundHits())
+                       : 0;
+    groundMaxRange = player.weaponMaxRange(unitType.groundWeapon());
+
+    airDamage = player.damage(unitType.airWeapon());
+    airCooldown = unitType.airWeapon().damageFactor() && unitType.maxAirHits()
+                    ? unitType.airWeapon().damageCooldown() / (unitType.airWeapon().damageFactor() * unitType.maxAirHits())
+                    : 0;
+    airMaxRange = player.weaponMaxRange(unitType.airWeapon());
+
+    if (unitType == BWAPI::UnitTypes::Protoss_Carrier) {
+      groundDamage = player.damage(BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon());
+      groundDamageType = BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon().damageType();
+      groundCooldown = 5;
+      groundMaxRange = 32 * 8;
+
+      airDamage = groundDamage;
+      airDamageType = groundDamageType;
+      airCooldown = groundCooldown;
+      airMaxRange = groundMaxRange;
+    }
+    else if (unitType == BWAPI::UnitTypes::Terran_Bunker) {
+      groundDamage = player.damage(BWAPI::WeaponTypes::Gauss_Rifle);
+      groundCooldown = BWAPI::UnitTypes::Terran_Marine.groundWeapon().damageCooldown() / 4;
+      groundMaxRange = player.weaponMaxRange(BWAPI::UnitTypes::Terran_Marine.groundWeapon()) + 32;
+
+      airDamage = groundDamage;
+      airCooldown = groundCooldown;
+      airMaxRange = groundMaxRange;
+    }
+    else if (unitType == BWAPI::UnitTypes::Protoss_Reaver) {
+      groundDamage = player.damage(BWAPI::WeaponTypes::Scarab);
+    }
+  }
+
+  // FAP works in squared ranges and doubled hit points and damage.
+  void FastApproximation::FAPUnit::scale() const {
+    groundMaxRange *= groundMaxRange;
+    groundMinRange *= groundMinRange;
+    airMaxRange *= airMaxRange;
+    airMinRange *= airMinRange;
+
+    groundDamage *= 2;
+    airDamage *= 2;
+
+    shieldArmor *= 2;
+    armor *= 2;
+
+    health *= 2;
+    maxHealth *= 2;
+    shields *= 2;
+    maxShields *= 2;
+  }
+
   FastApproximation::FAPUnit::FAPUnit(BWAPI::Unit u): FAPUnit(UnitInfo(u)) { }
 
   FastApproximation::FAPUnit::FAPUnit(UnitInfo ui) :
     x(ui.lastPosition.x),
     y(ui.lastPosition.y),
 
-    speed(ui.player->topSpeed(ui.type)),
-
     health(ui.lastHealth),
     maxHealth(ui.type.maxHitPoints()),
 
     shields(ui.lastShields),
-    shieldArmor(ui.player->getUpgradeLevel(BWAPI::UpgradeTypes::Protoss_Plasma_Shields)),
     maxShields(ui.type.maxShields()),
-    armor(ui.player->armor(ui.type)),
     flying(ui.type.isFlyer()),
     underSwarm(ui.unit && ui.unit->isVisible() && ui.unit->isUnderDarkSwarm()), // not too accurate
 
-    groundDamage(ui.player->damage(ui.type.groundWeapon())),
-    groundCooldown(ui.type.groundWeapon().damageFactor() && ui.type.maxGroundHits()
-                     ? ui.player->weaponDamageCooldown(ui.type) / (ui.type.groundWeapon().damageFactor() * ui
-                                                                                                           .type.
-                                                                                                           maxGroundHits()
-                     )
-                     : 0),
-    groundMaxRange(ui.player->weaponMaxRange(ui.type.groundWeapon())),
     groundMinRange(ui.type.groundWeapon().minRange()),
     groundDamageType(ui.type.groundWeapon().damageType()),
 
-    airDamage(ui.player->damage(ui.type.airWeapon())),
-    airCooldown(ui.type.airWeapon().damageFactor() && ui.type.maxAirHits()
-                  ? ui.type.airWeapon().damageCooldown() / (ui.type.airWeapon().damageFactor() * ui.type.maxAirHits())
-                  : 0),
-    airMaxRange(ui.player->weaponMaxRange(ui.type.airWeapon())),
     airMinRange(ui.type.airWeapon().minRange()),
     airDamageType(ui.type.airWeapon().damageType()),
 
@@ -424,29 +634,7 @@ namespace KoalaRunBot {
     static int nextId = 0;
     id = nextId++;
 
-    if (ui.type == BWAPI::UnitTypes::Protoss_Carrier) {
-      groundDamage = ui.player->damage(BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon());
-      groundDamageType = BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon().damageType();
-      groundCooldown = 5;
-      groundMaxRange = 32 * 8;
-
-      airDamage = groundDamage;
-      airDamageType = groundDamageType;
-      airCooldown = groundCooldown;
-      airMaxRange = groundMaxRange;
-    }
-    else if (ui.type == BWAPI::UnitTypes::Terran_Bunker) {
-      groundDamage = ui.player->damage(BWAPI::WeaponTypes::Gauss_Rifle);
-      groundCooldown = BWAPI::UnitTypes::Terran_Marine.groundWeapon().damageCooldown() / 4;
-      groundMaxRange = ui.player->weaponMaxRange(BWAPI::UnitTypes::Terran_Marine.groundWeapon()) + 32;
-
-      airDamage = groundDamage;
-      airCooldown = groundCooldown;
-      airMaxRange = groundMaxRange;
-    }
-    else if (ui.type == BWAPI::UnitTypes::Protoss_Reaver) {
-      groundDamage = ui.player->damage(BWAPI::WeaponTypes::Scarab);
-    }
+    setStats(*ui.player);
 
     if (ui.unit && ui.unit->isStimmed()) {
       groundCooldown /= 2;
@@ -457,28 +645,50 @@ namespace KoalaRunBot {
       elevation = BWAPI::Broodwar->getGroundHeight(ui.unit->getTilePosition());
     }
 
-    groundMaxRange *= groundMaxRange;
-    groundMinRange *= groundMinRange;
-    airMaxRange *= airMaxRange;
-    airMinRange *= airMinRange;
+    scale();
+  }
 
-    groundDamage *= 2;
-    airDamage *= 2;
+  // A unit with no game behind it, for the combat sim benchmark.
+  FastApproximation::FAPUnit::FAPUnit(const FAPPlayer& player, BWAPI::UnitType type, int x, int y,
+                                      int health, int shields, bool stimmed) :
+    x(x),
+    y(y),
 
-    shieldArmor *= 2;
-    armor *= 2;
+    health(health),
+    maxHealth(type.maxHitPoints()),
 
-    health *= 2;
-    maxHealth *= 2;
-    shields *= 2;
-    maxShields *= 2;
+    shields(shields),
+    maxShields(type.maxShields()),
+    flying(type.isFlyer()),
+
+    groundMinRange(type.groundWeapon().minRange()),
+    groundDamageType(type.groundWeapon().damageType()),
+
+    airMinRange(type.airWeapon().minRange()),
+    airDamageType(type.airWeapon().damageType()),
+
+    unitType(type),
+    isOrganic(type.isOrganic()),
+    score(type.mineralPrice() + type.gasPrice()),
+    standIn(&player) {
+    static int nextId = 0;
+    id = nextId++;
+
+    setStats(player);
+
+    if (stimmed) {
+      groundCooldown /= 2;
+      airCooldown /= 2;
+    }
+
+    scale();
   }
 
   const FastApproximation::FAPUnit& FastApproximation::FAPUnit::operator=(const FAPUnit& other) const {
     x = other.x, y = other.y;
     health = other.health, maxHealth = other.maxHealth;
     shields = other.shields, maxShields = other.maxShields;
-    speed = other.speed, armor = other.armor, flying = other.flying, underSwarm = other.underSwarm, unitSize = other.
+    speed = other.speed, fixedSpeed = other.fixedSpeed, armor = other.armor, flying = other.flying, underSwarm = other.underSwarm, unitSize = other.
       unitSize;
     groundDamage = other.groundDamage, groundCooldown = other.groundCooldown, groundMaxRange = other.groundMaxRange,
       groundMinRange = other.groundMinRange, groundDamageType = other.groundDamageType;
@@ -492,6 +702,7 @@ namespace KoalaRunBot {
     didHealThisFrame = other.didHealThisFrame;
     elevation = other.elevation;
     player = other.player;
+    standIn = other.standIn;
 
     return *this;
   }
@@ -500,4 +711,84 @@ namespace KoalaRunBot {
     return id < other.id;
   }
 
+  FAPTrace::FAPTrace(int maxFrames, int maxChoices, int maxStates)
+    : maxFrames(maxFrames)
+    , maxChoices(maxChoices)
+    , maxStates(maxStates)
+    , isFull(false) {
+    frames.reserve(maxFrames);
+    choices.reserve(maxChoices);
+    states.reserve(maxStates);
+  }
+
+  void FAPTrace::clear() {
+    frames.clear();
+    choices.clear();
+    states.clear();
+    isFull = false;
+  }
+
+  void FAPTrace::addChoice(int side, int unit, int target) {
+    if (isFull)
+      return;
+    if (choices.size() == maxChoices) {
+      isFull = true;
+      return;
+    }
+
+    Choice choice;
+    choice.side = (unsigned char)side;
+    choice.unit = short(unit);
+    choice.target = short(target);
+    choices.push_back(choice);
+  }
+
+  // A frame whose states don't fit is dropped along with its choices, so that every frame
+  // in the trace is whole.
+  void FAPTrace::endFrame(const std::vector<FastApproximation::FAPUnit>& player1,
+                          const std::vector<FastApproximation::FAPUnit>& player2) {
+    const int choicesBegin = frames.empty() ? 0 : frames.back().choicesEnd;
+    if (isFull || frames.size() == maxFrames || states.size() + player1.size() + player2.size() > maxStates) {
+      isFull = true;
+      choices.resize(choicesBegin);
+      return;
+    }
+
+    for (const auto* side : {&player1, &player2}) {
+      for (const auto& u : *side) {
+        State state;
+        state.x = short(u.x);
+        state.y = short(u.y);
+        state.health = short(u.health);
+        state.shields = short(u.shields);
+        states.push_back(state);
+      }
+    }
+
+    Frame frame;
+    frame.choicesEnd = int(choices.size());
+    frame.statesEnd = int(states.size());
+    frame.units[0] = short(player1.size());
+    frame.units[1] = short(player2.size());
+    frames.push_back(frame);
+  }
+
+  void FAPTrace::write(std::ostream& out) const {
+    int choice = 0;
+    int state = 0;
+    for (size_t f = 0; f < frames.size(); ++f) {
+      const Frame& frame = frames[f];
+      out << "frame " << f + 1 << ' ' << frame.units[0] << ' ' << frame.units[1];
+      for (; choice < frame.choicesEnd; ++choice)
+        out << ' ' << int(choices[choice].side) + 1 << ':' << choices[choice].unit << '>' << choices[choice].target;
+      out << " |";
+      for (; state < frame.statesEnd; ++state)
+        out << ' ' << states[state].x << ',' << states[state].y << ',' << states[state].health << ','
+          << states[state].shields;
+      out << '\n';
+    }
+    if (isFull)
+      out << "full\n";
+  }
+
 }
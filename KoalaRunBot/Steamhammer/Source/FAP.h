@@ -1,13 +1,38 @@
 #pragma once
 
+#include <cstdint>
+
 #include "UnitStatistic.h"
 
 namespace KoalaRunBot {
 
+  // One side's upgrades, standing in for a BWAPI::Player when there is no game.
+  // The stat functions follow the BWAPI::PlayerInterface functions of the same names.
+  // The unit type data itself is static in BWAPI and works without a game.
+  class FAPPlayer {
+    int levels[BWAPI::UpgradeTypes::Enum::MAX];
+
+  public:
+    FAPPlayer();
+
+    void setUpgradeLevel(BWAPI::UpgradeType upgrade, int level);
+    int getUpgradeLevel(BWAPI::UpgradeType upgrade) const;
+
+    int damage(BWAPI::WeaponType weapon) const;
+    int armor(BWAPI::UnitType type) const;
+    double topSpeed(BWAPI::UnitType type) const;
+    int weaponMaxRange(BWAPI::WeaponType weapon) const;
+    int weaponDamageCooldown(BWAPI::UnitType type) const;
+  };
+
+  class FAPTrace;
+
   class FastApproximation {
+  public:
     struct FAPUnit {
       FAPUnit(BWAPI::Unit u);
       FAPUnit(UnitInfo ui);
+      FAPUnit(const FAPPlayer& player, BWAPI::UnitType type, int x, int y, int health, int shields, bool stimmed = false);
       const FAPUnit& operator=(const FAPUnit& other) const;
 
       int id = 0;
@@ -23,6 +48,7 @@ namespace KoalaRunBot {
       mutable int maxShields = 0;
 
       mutable double speed = 0;
+      mutable int fixedSpeed = 0;   // in 1/256 pixels per frame, for fixed point mode
       mutable bool flying = false;
       mutable int elevation = -1;
       mutable bool underSwarm = false;
@@ -43,6 +69,7 @@ namespace KoalaRunBot {
 
       mutable BWAPI::UnitType unitType;
       mutable BWAPI::Player player = nullptr;
+      mutable const FAPPlayer* standIn = nullptr; // instead of player
       mutable int healTimer = 0;
       mutable bool isOrganic = false;
       mutable bool didHealThisFrame = false;
@@ -57,9 +84,12 @@ namespace KoalaRunBot {
 #endif
 
       bool operator<(const FAPUnit& other) const;
-    };
 
-  public:
+    private:
+      template <class P>
+      void setStats(const P& player) const;
+      void scale() const;
+    };
 
     FastApproximation();
 
@@ -68,7 +98,15 @@ namespace KoalaRunBot {
     void addUnitPlayer2(FAPUnit fu);
     void addIfCombatUnitPlayer2(FAPUnit fu);
 
-    void simulate(int nFrames = 96); // = 24*4, 4 seconds on fastest
+    int simulate(int nFrames = 96); // = 24*4, 4 seconds on fastest; returns the frames simulated
+
+    // In fixed point mode, movement uses integer arithmetic only, so the results are the same
+    // with every compiler and platform. They differ a little from the default mode's.
+    void setFixedPoint(bool on) { fixedPoint = on; }
+
+    // Record each frame of simulate() into the trace, or stop recording with nullptr.
+    // The trace is not cleared first.
+    void setTrace(FAPTrace* t) { trace = t; }
 
     std::pair<int, int> playerScores() const;
     std::pair<int, int> playerScoresUnits() const;
@@ -76,22 +114,79 @@ namespace KoalaRunBot {
     std::pair<std::vector<FAPUnit> *, std::vector<FAPUnit> *> getState();
     void clearState();
 
+    // The current state as a combat sim benchmark scenario: our upgrades and units as side 1, the enemy's as 2.
+    void writeScenario(std::ostream& out, const std::string& name) const;
+
   private:
     std::vector<FAPUnit> player1, player2;
 
     bool didSomething;
+    bool fixedPoint;
+    FAPTrace* trace;
+    int chosenTarget;   // by the last unit to act, -1 if none
     void dealDamage(const FastApproximation::FAPUnit& fu, int damage, BWAPI::DamageType damageType) const;
     static int DistButNotReally(const FastApproximation::FAPUnit& u1, const FastApproximation::FAPUnit& u2);
     static bool IsSuicideUnit(BWAPI::UnitType ut);
     void UnitSim(const FAPUnit& fu, std::vector<FAPUnit>& enemyUnits);
-    static void Medicsim(const FAPUnit& fu, std::vector<FAPUnit>& friendlyUnits);
+    void Medicsim(const FAPUnit& fu, std::vector<FAPUnit>& friendlyUnits);
     bool suicideSim(const FAPUnit& fu, std::vector<FAPUnit>& enemyUnits);
+    bool withinMove(const FAPUnit& fu, int dist) const;
+    void moveToward(const FAPUnit& fu, const FAPUnit& target) const;
+    static int64_t isqrt(int64_t n);
+    void recordChoice(int side, int unit) const;
     void Isimulate();
     void unitDeath(const FAPUnit& fu, std::vector<FAPUnit>& itsFriendlies);
     static void ConvertToUnitType(const FAPUnit& fu, BWAPI::UnitType ut);
 
   };
 
+  // A compact record of a FastApproximation run, to replay and check it.
+  // For each frame, the target choices in the order they were made, then the state of every
+  // unit after the frame, side 1 then side 2, each side in list order. Units and targets are
+  // identified by their index in their side's list at the time.
+  // The space is reserved up front. When it runs out, recording stops and full() is set.
+  class FAPTrace {
+  public:
+    struct Choice {
+      unsigned char side;   // 0 or 1, the side of the unit choosing
+      short unit;
+      short target;         // in the enemy list; for a medic, in its own list
+    };
+
+    struct State {
+      short x, y;
+      short health, shields;   // doubled, as in FAP
+    };
+
+    struct Frame {
+      int choicesEnd;
+      int statesEnd;
+      short units[2];          // on each side, after the frame
+    };
+
+    FAPTrace(int maxFrames, int maxChoices, int maxStates);
+
+    void clear();
+    bool full() const { return isFull; }
+    int frameCount() const { return int(frames.size()); }
+
+    // Called by FastApproximation as it simulates.
+    void addChoice(int side, int unit, int target);
+    void endFrame(const std::vector<FastApproximation::FAPUnit>& player1,
+                  const std::vector<FastApproximation::FAPUnit>& player2);
+
+    // One line per frame: the unit counts, the choices as side:unit>target, the states as x,y,hp,sh.
+    void write(std::ostream& out) const;
+
+  private:
+    size_t maxFrames, maxChoices, maxStates;
+    bool isFull;
+
+    std::vector<Frame> frames;
+    std::vector<Choice> choices;
+    std::vector<State> states;
+  };
+
 }
 
 extern KoalaRunBot::FastApproximation fap;
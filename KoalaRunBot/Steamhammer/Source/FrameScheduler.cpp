@@ -0,0 +1,145 @@
+#include "FrameScheduler.h"
+
+#include "Common.h"
+#include "Profiler.h"
+
+using namespace KoalaRunBot;
+
+// How far a task may run past the budget before the rest of the plan is put off.
+// Timers overshoot a little, and an elastic task uses its time to the end.
+static const double kSlackMs = 1.0;
+
+FrameScheduler::FrameScheduler()
+	: budget_ms_(0.0)
+	, reserved_ms_(0.0) {
+}
+
+void FrameScheduler::Add(const char* name, const Priority priority, const int min_period, const int max_period,
+                         const double estimated_ms, const std::function<void()>& work) {
+	UAB_ASSERT(min_period >= 1 && max_period >= min_period, "bad task period");
+
+	Task task;
+	task.name_ = name;
+	task.zone_ = Profiler::Instance().ZoneId(name);
+	task.priority_ = priority;
+	task.min_period_ = min_period;
+	task.max_period_ = priority == Priority::Critical ? 1 : max_period;
+	task.cost_ms_ = estimated_ms;
+	task.elastic_ = false;
+	task.last_run_ = -max_period; // eligible and due on the first frame
+	task.deferred_ = 0;
+	task.work_ = work;
+	tasks_.push_back(task);
+	chosen_.push_back(false);
+}
+
+void FrameScheduler::AddElastic(const char* name, const Priority priority, const int min_period, const int max_period,
+                                const double minimum_ms, const std::function<void()>& work) {
+	Add(name, priority, min_period, max_period, minimum_ms, work);
+	tasks_.back().elastic_ = true;
+}
+
+// Tasks that are due are chosen regardless of cost. The rest fill the remaining budget
+// by priority, then by how far they are into their latency bound.
+void FrameScheduler::Choose(const int frame, const double elapsed_ms) {
+	double planned = elapsed_ms;
+	std::vector<int> optional;
+
+	for (size_t i = 0; i < tasks_.size(); ++i) {
+		const Task& task = tasks_[i];
+		const int since = frame - task.last_run_;
+		chosen_[i] = since >= task.max_period_;
+		if (chosen_[i]) {
+			planned += task.cost_ms_;
+		}
+		else if (since >= task.min_period_) {
+			optional.push_back(int(i));
+		}
+	}
+
+	std::stable_sort(optional.begin(), optional.end(), [this, frame](const int a, const int b) {
+		const Task& ta = tasks_[a];
+		const Task& tb = tasks_[b];
+		if (ta.priority_ != tb.priority_) {
+			return ta.priority_ < tb.priority_;
+		}
+		return (frame - ta.last_run_) * tb.max_period_ > (frame - tb.last_run_) * ta.max_period_;
+	});
+
+	for (const int i : optional) {
+		if (planned + tasks_[i].cost_ms_ <= budget_ms_) {
+			chosen_[i] = true;
+			planned += tasks_[i].cost_ms_;
+		}
+		else {
+			++tasks_[i].deferred_;
+		}
+	}
+}
+
+void FrameScheduler::RunTask(Task& task, const int frame) {
+	const double before = Profiler::Instance().FrameMilliseconds();
+	{
+		ProfileZone zone(task.zone_);
+		task.work_();
+	}
+	const double ms = Profiler::Instance().FrameMilliseconds() - before;
+
+	task.last_run_ = frame;
+	if (task.elastic_) {
+		return;
+	}
+
+	// Rise at once to a higher cost, fall slowly from it. An occasional spike makes the task
+	// wait for a quieter frame for a while, which is what we want.
+	task.cost_ms_ = std::max(ms, 0.9 * task.cost_ms_ + 0.1 * ms);
+}
+
+void FrameScheduler::Update(const double budget_ms) {
+	const int frame = BWAPI::Broodwar->getFrameCount();
+	budget_ms_ = budget_ms;
+
+	Choose(frame, Profiler::Instance().FrameMilliseconds());
+
+	reserved_ms_ = 0.0;
+	for (size_t i = 0; i < tasks_.size(); ++i) {
+		if (chosen_[i]) {
+			reserved_ms_ += tasks_[i].cost_ms_;
+		}
+	}
+
+	for (size_t i = 0; i < tasks_.size(); ++i) {
+		Task& task = tasks_[i];
+		if (!chosen_[i]) {
+			continue;
+		}
+		reserved_ms_ -= task.cost_ms_;
+		// The plan was made on estimates. If earlier tasks ran long, put off what can wait.
+		if (frame - task.last_run_ < task.max_period_ &&
+			Profiler::Instance().FrameMilliseconds() + task.cost_ms_ > budget_ms_ + kSlackMs) {
+			++task.deferred_;
+			continue;
+		}
+		RunTask(task, frame);
+	}
+}
+
+double FrameScheduler::RemainingMilliseconds() const {
+	return budget_ms_ - reserved_ms_ - Profiler::Instance().FrameMilliseconds();
+}
+
+void FrameScheduler::DrawTasks(const int x, const int y) const {
+	if (!Config::Debug::DrawModuleTimers) {
+		return;
+	}
+
+	const int frame = BWAPI::Broodwar->getFrameCount();
+	int yy = y;
+	BWAPI::Broodwar->drawTextScreen(x, yy, "%ctask       cost  age  deferred", kWhite);
+	for (const Task& task : tasks_) {
+		yy += 10;
+		BWAPI::Broodwar->drawTextScreen(x, yy, "%c%-10s %5.2f %4d %d",
+			frame - task.last_run_ <= 1 ? kGreen : kOrange,
+			task.name_.c_str(), task.cost_ms_, frame - task.last_run_, task.deferred_);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace KoalaRunBot {
+  // Decides each frame which manager updates run, to keep the frame within a time budget.
+  // A task runs at most once every min_period frames and at least once every max_period frames,
+  // whatever the budget says; a task with max_period 1 runs every frame. Between those bounds,
+  // tasks that are allowed to run go in order of priority and staleness while their estimated
+  // cost fits in what is left of the budget.
+  // The chosen tasks run in the order they were added, so that information is updated before
+  // the managers that act on it. Each task is a profiler zone.
+  // An elastic task uses whatever time it is given (the build order search). Its cost is the
+  // least time worth giving it, and it gets the budget left after reserving for the tasks after it.
+  class FrameScheduler {
+  public:
+    enum class Priority { Critical, High, Normal, Low };
+
+  private:
+    struct Task {
+      std::string name_;
+      int zone_;
+      Priority priority_;
+      int min_period_;
+      int max_period_;
+      double cost_ms_; // recent cost, leaning toward the high side
+      bool elastic_;
+      int last_run_;
+      int deferred_; // frames it was eligible but skipped for lack of time
+      std::function<void()> work_;
+    };
+
+    std::vector<Task> tasks_;
+    std::vector<bool> chosen_;
+    double budget_ms_;
+    double reserved_ms_; // estimated cost of the chosen tasks still to run after the current one
+
+    void Choose(int frame, double elapsed_ms);
+    void RunTask(Task& task, int frame);
+
+  public:
+    FrameScheduler();
+
+    void Add(const char* name, Priority priority, int min_period, int max_period, double estimated_ms,
+             const std::function<void()>& work);
+    void AddElastic(const char* name, Priority priority, int min_period, int max_period, double minimum_ms,
+                    const std::function<void()>& work);
+
+    // Run this frame's tasks.
+    void Update(double budget_ms);
+
+    // The budget left in this frame for an elastic task.
+    double RemainingMilliseconds() const;
+
+    void DrawTasks(int x, int y) const;
+  };
+}
@@ -2,6 +2,7 @@
 #include "GameCommander.h"
 #include "MapTools.h"
 #include "OpponentModel.h"
+#include "Profiler.h"
 #include "UnitUtil.h"
 
 using namespace KoalaRunBot;
@@ -10,10 +11,48 @@ GameCommander::GameCommander()
   : the_(The::Root())
     , combat_commander_(CombatCommander::Instance())
     , surrender_time_(0)
-    , initial_scout_time_(0) {}
+    , initial_scout_time_(0) {
+  typedef FrameScheduler::Priority Priority;
+
+  // In update order. Managers that gather information come first, then those that act on it.
+  // Periods are in frames: at most every min, at least every max. Costs are first guesses in ms.
+  // Critical tasks run every frame. Some keep their own frame schedules, or must react at once.
+  scheduler_.Add("UnitInfo", Priority::Critical, 1, 1, 1.0, []() { InformationManager::Instance().update(); });
+  scheduler_.Add("MapGrid", Priority::High, 1, 3, 0.5, []() { MapGrid::Instance().update(); });
+  // The attack table must be current before the threat map and micro read it. It only refills on upgrades.
+  scheduler_.Add("AttackTable", Priority::Critical, 1, 1, 0.05, [this]() { the_.attack_table_.Update(); });
+  scheduler_.Add("ThreatMap", Priority::High, 1, 4, 0.3, [this]() { the_.threat_map_.Update(); });
+  scheduler_.Add("Distances", Priority::High, 1, 4, 0.3, [this]() { the_.distance_fields_.Update(); });
+  scheduler_.Add("Opponent", Priority::Critical, 1, 1, 0.2, []() { OpponentModel::Instance().update(); });
+  // The enemy clusters are only drawn, so skip clustering unless the drawing is turned on.
+  scheduler_.Add("Ops", Priority::Low, 5, 10, 0.5, [this]() {
+    if (Config::Debug::DrawClusters) {
+      the_.ops_boss_.Update();
+    }
+  });
+
+  // The search takes the time left over, but always gets at least 5ms when it runs.
+  scheduler_.AddElastic("Search", Priority::Low, 1, 4, 5.0, [this]() {
+    BOSSManager::Instance().update(scheduler_.RemainingMilliseconds());
+  });
+  scheduler_.Add("Worker", Priority::High, 1, 2, 0.5, []() { WorkerManager::Instance().update(); });
+  scheduler_.Add("Rebalance", Priority::Low, 48, 96, 0.5, []() { WorkerManager::Instance().rebalanceMineralWorkers(); });
+  scheduler_.Add("Production", Priority::Critical, 1, 1, 1.0, []() { ProductionManager::Instance().update(); });
+  scheduler_.Add("Building", Priority::High, 1, 2, 0.5, []() { BuildingManager::Instance().update(); });
+  scheduler_.Add("Combat", Priority::Critical, 1, 1, 3.0, [this]() { combat_commander_.update(combat_units_); });
+  scheduler_.Add("Scout", Priority::Normal, 1, 2, 0.2, []() { ScoutManager::Instance().update(); });
+
+  // Path searches queued by the managers above, at most 2ms per frame.
+  scheduler_.AddElastic("Paths", Priority::Normal, 1, 4, 0.5, [this]() {
+    the_.path_service_.Update(std::min(2.0, scheduler_.RemainingMilliseconds()));
+  });
+
+  // Execute micro commands gathered above. Do this at the end of the frame.
+  scheduler_.Add("Micro", Priority::Critical, 1, 1, 1.0, [this]() { the_.micro_.update(); });
+}
 
 void GameCommander::Update() {
-  timer_manager_.startTimer(TimerManager::Total);
+  ProfileFrame frame;
 
   // populate the unit vectors we will pass into various managers
   HandleUnitAssignments();
@@ -31,54 +70,12 @@ void GameCommander::Update() {
     return;
   }
 
-  // -- Managers that gather inforation. --
-
-  timer_manager_.startTimer(TimerManager::InformationManager);
-  InformationManager::Instance().update();
-  timer_manager_.stopTimer(TimerManager::InformationManager);
-
-  timer_manager_.startTimer(TimerManager::MapGrid);
-  MapGrid::Instance().update();
-  timer_manager_.stopTimer(TimerManager::MapGrid);
-
-  timer_manager_.startTimer(TimerManager::OpponentModel);
-  OpponentModel::Instance().update();
-  timer_manager_.stopTimer(TimerManager::OpponentModel);
-
-  // -- Managers that act on information. --
-
-  timer_manager_.startTimer(TimerManager::Search);
-  BOSSManager::Instance().update(35 - timer_manager_.getTotalMilliseconds());
-  timer_manager_.stopTimer(TimerManager::Search);
+  scheduler_.Update(Config::Macro::FrameBudget);
 
-  timer_manager_.startTimer(TimerManager::Worker);
-  WorkerManager::Instance().update();
-  timer_manager_.stopTimer(TimerManager::Worker);
-
-  timer_manager_.startTimer(TimerManager::Production);
-  ProductionManager::Instance().update();
-  timer_manager_.stopTimer(TimerManager::Production);
-
-  timer_manager_.startTimer(TimerManager::Building);
-  BuildingManager::Instance().update();
-  timer_manager_.stopTimer(TimerManager::Building);
-
-  timer_manager_.startTimer(TimerManager::Combat);
-  combat_commander_.update(combat_units_);
-  timer_manager_.stopTimer(TimerManager::Combat);
-
-  timer_manager_.startTimer(TimerManager::Scout);
-  ScoutManager::Instance().update();
-  timer_manager_.stopTimer(TimerManager::Scout);
-
-  // Execute micro commands gathered above. Do this at the end of the frame.
-  timer_manager_.startTimer(TimerManager::Micro);
-  the_.micro_.update();
-  timer_manager_.stopTimer(TimerManager::Micro);
-
-  timer_manager_.stopTimer(TimerManager::Total);
-
-  DrawDebugInterface();
+  {
+    PROFILE_ZONE("Draw");
+    DrawDebugInterface();
+  }
 }
 
 void GameCommander::DrawDebugInterface() {
@@ -95,7 +92,10 @@ void GameCommander::DrawDebugInterface() {
 
   combat_commander_.drawSquadInformation(170, 70);
   combat_commander_.drawCombatSimInformation();
-  timer_manager_.drawModuleTimers(490, 215);
+  Profiler::Instance().DrawZoneTimers(490, 215);
+  scheduler_.DrawTasks(490, 350);
+  the_.ops_boss_.DrawClusters();
+  the_.threat_map_.Draw();
   DrawGameInformation(4, 1);
 
   DrawUnitOrders();
@@ -172,8 +172,8 @@ void GameCommander::DrawGameInformation(int x, int y) {
                                   frame,
                                   int(frame / (23.8 * 60)),
                                   int(frame / 23.8) % 60,
-                                  timer_manager_.getMeanMilliseconds(),
-                                  timer_manager_.getMaxMilliseconds());
+                                  Profiler::Instance().GetMeanMilliseconds(),
+                                  Profiler::Instance().GetMaxMilliseconds());
 
   /*
   // latency display
@@ -306,6 +306,7 @@ void GameCommander::OnUnitHide(BWAPI::Unit unit) {
 
 void GameCommander::OnUnitCreate(BWAPI::Unit unit) {
   InformationManager::Instance().onUnitCreate(unit);
+  BuildingPlacer::Instance().onUnitChange(unit);
 }
 
 void GameCommander::OnUnitComplete(BWAPI::Unit unit) {
@@ -320,11 +321,13 @@ void GameCommander::OnUnitDestroy(BWAPI::Unit unit) {
   ProductionManager::Instance().onUnitDestroy(unit);
   WorkerManager::Instance().onUnitDestroy(unit);
   InformationManager::Instance().onUnitDestroy(unit);
+  BuildingPlacer::Instance().onUnitChange(unit);
 }
 
 void GameCommander::OnUnitMorph(BWAPI::Unit unit) {
   InformationManager::Instance().onUnitMorph(unit);
   WorkerManager::Instance().onUnitMorph(unit);
+  BuildingPlacer::Instance().onUnitChange(unit);
 }
 
 // Used only to choose a worker to scout.
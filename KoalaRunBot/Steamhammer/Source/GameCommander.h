@@ -4,13 +4,13 @@
 
 #include "BuildingManager.h"
 #include "CombatCommander.h"
+#include "FrameScheduler.h"
 #include "InformationManager.h"
 #include "MapGrid.h"
 #include "OpponentModel.h"
 #include "ProductionManager.h"
 #include "ScoutManager.h"
 #include "StrategyManager.h"
-#include "TimerManager.h"
 #include "WorkerManager.h"
 
 namespace KoalaRunBot {
@@ -31,7 +31,7 @@ namespace KoalaRunBot {
   class GameCommander {
     The& the_;
     CombatCommander& combat_commander_;
-    TimerManager timer_manager_;
+    FrameScheduler scheduler_;
 
     BWAPI::Unitset valid_units_;
     BWAPI::Unitset combat_units_;
@@ -0,0 +1,98 @@
+#include "GameMatcher.h"
+
+#include "GameRecord.h"
+
+using namespace KoalaRunBot;
+
+// The map and opening penalties are the same as in GameRecord::distance().
+GameMatcher::Candidate::Candidate(const GameRecord* record, const int penalty)
+	: record_(record)
+	, distance_(penalty)
+	, done_(0) {
+}
+
+int GameMatcher::Candidate::Slices() const {
+	return int(record_->getSnapshots().size());
+}
+
+GameMatcher::GameMatcher()
+	: enemy_race_(BWAPI::Races::None)
+	, current_(nullptr)
+	, current_slices_(0)
+	, best_(nullptr) {
+}
+
+// Choose the comparable past records.
+// Only records of the same matchup with at least one snapshot can be compared.
+void GameMatcher::Build(const GameRecord& current, const std::vector<GameRecord*>& past) {
+	enemy_race_ = current.getEnemyRace();
+	candidates_.clear();
+
+	for (const GameRecord* record : past) {
+		if (record->getOurRace() == current.getOurRace() &&
+			record->getEnemyRace() == current.getEnemyRace() &&
+			!record->getSnapshots().empty()) {
+			int penalty = 0;
+			if (current.getMapName() != record->getMapName()) {
+				penalty += 20;
+			}
+			if (current.getOpeningName() != record->getOpeningName()) {
+				penalty += 200;
+			}
+			candidates_.push_back(Candidate(record, penalty));
+		}
+	}
+}
+
+// Same as the 2 snapDistance() terms in GameRecord::distance().
+int GameMatcher::SliceDistance(const Candidate& candidate, const int slice) const {
+	const GameSnapshot& here = current_->getSnapshots()[slice];
+	const GameSnapshot& there = candidate.record_->getSnapshots()[slice];
+
+	return PlayerSnapshot::distance(here.us, there.us) + kEnemyWeight * PlayerSnapshot::distance(here.them, there.them);
+}
+
+// Extend the candidate's running distance to all the slices both games have.
+// With limit >= 0, give up as soon as the distance is over the limit, and return false.
+bool GameMatcher::CatchUp(Candidate& candidate, const int limit) const {
+	const int slices = std::min(current_slices_, candidate.Slices());
+	while (candidate.done_ < slices) {
+		if (limit >= 0 && candidate.distance_ > limit) {
+			return false;
+		}
+		candidate.distance_ += SliceDistance(candidate, candidate.done_);
+		++candidate.done_;
+	}
+	return limit < 0 || candidate.distance_ <= limit;
+}
+
+// If the past game ended before now, it has no information for us.
+bool GameMatcher::StillUseful(const Candidate& candidate) const {
+	const int slices = std::min(current_slices_, candidate.Slices());
+	const int latest = slices > 0 ? candidate.record_->getSnapshots()[slices - 1].frame : 0;
+	return BWAPI::Broodwar->getFrameCount() - latest <= candidate.record_->getSnapshotInterval();
+}
+
+void GameMatcher::Update(const GameRecord& current, const std::vector<GameRecord*>& past) {
+	if (enemy_race_ != current.getEnemyRace()) {
+		Build(current, past);
+	}
+	current_ = &current;
+	current_slices_ = int(current.getSnapshots().size());
+
+	// A candidate that has run out of snapshots can never be useful again.
+	candidates_.erase(std::remove_if(candidates_.begin(), candidates_.end(), [this](const Candidate& candidate) {
+		return candidate.Slices() < current_slices_ && !StillUseful(candidate);
+	}), candidates_.end());
+
+	// Candidates stay in the order of the past records, so ties go to the earlier record as before.
+	best_ = nullptr;
+	int best_distance = -1;
+	for (Candidate& candidate : candidates_) {
+		if (StillUseful(candidate) && CatchUp(candidate, best_distance) &&
+			(!best_ || candidate.distance_ < best_distance)) {
+			best_ = candidate.record_;
+			best_distance = candidate.distance_;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Common.h"
+
+namespace KoalaRunBot {
+  class GameRecord;
+
+  // Finds the past game record nearest to the current game, by the same distance as GameRecord::distance().
+  // Each candidate keeps a running distance, which only grows as the game goes on, so it is a
+  // lower bound on the final distance. Each new snapshot of the current game is compared only
+  // against candidates whose lower bound can still beat the best, and those that fall behind
+  // stop partway and catch up later if they become competitive again.
+  class GameMatcher {
+    struct Candidate {
+      const GameRecord* record_;
+      int distance_; // running distance over the first done_ slices
+      int done_;
+
+      Candidate(const GameRecord* record, int penalty);
+      int Slices() const;
+    };
+
+    static const int kEnemyWeight = 5; // differences in enemy play count 5 times more
+
+    BWAPI::Race enemy_race_; // the enemy race the candidates were chosen for
+    std::vector<Candidate> candidates_;
+    const GameRecord* current_;
+    int current_slices_;
+
+    const GameRecord* best_;
+
+    void Build(const GameRecord& current, const std::vector<GameRecord*>& past);
+    int SliceDistance(const Candidate& candidate, int slice) const;
+    bool CatchUp(Candidate& candidate, int limit) const;
+    bool StillUseful(const Candidate& candidate) const;
+
+  public:
+    GameMatcher();
+
+    // Call after each snapshot of the current game. Cheap if there is no new snapshot.
+    void Update(const GameRecord& current, const std::vector<GameRecord*>& past);
+
+    // Null if no past record can be compared.
+    const GameRecord* GetBestMatch() const { return best_; }
+  };
+}
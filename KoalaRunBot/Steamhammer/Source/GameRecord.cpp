@@ -6,12 +6,14 @@
 #include "OpponentModel.h"
 #include "UnitUtil.h"
 
+#include <cstring>
+
 using namespace KoalaRunBot;
 
 // Take a digest snapshot of the game situation.
 void GameRecord::takeSnapshot()
 {
-	snapshots.push_back(new GameSnapshot(PlayerSnapshot (BWAPI::Broodwar->self()), PlayerSnapshot (BWAPI::Broodwar->enemy())));
+	snapshots.push_back(GameSnapshot(PlayerSnapshot (BWAPI::Broodwar->self()), PlayerSnapshot (BWAPI::Broodwar->enemy())));
 }
 
 BWAPI::Race GameRecord::charRace(char ch)
@@ -137,15 +139,15 @@ bool GameRecord::readPlayerSnapshot(std::istream & input, PlayerSnapshot & snap)
 		}
 		while (lineStream >> id >> n)
 		{
-			snap.unitCounts[BWAPI::UnitType(id)] = n;
+			snap.setCount(BWAPI::UnitType(id), n);
 		}
 		return true;
 	}
 	throw game_record_read_error();
 }
 
-// Allocate and return the next snapshot, or null if none.
-GameSnapshot * GameRecord::readGameSnapshot(std::istream & input)
+// Read the next snapshot and add it to the record. Return false if there is none.
+bool GameRecord::readGameSnapshot(std::istream & input)
 {
 	int t;
 	PlayerSnapshot me;
@@ -157,17 +159,18 @@ GameSnapshot * GameRecord::readGameSnapshot(std::istream & input)
 	{
 		if (line == gameEndMark)
 		{
-			return nullptr;
+			return false;
 		}
 		t = readNumber(line);
 	}
 
 	if (valid && readPlayerSnapshot(input, me) && valid && readPlayerSnapshot(input, you) && valid)
 	{
-		return new GameSnapshot(t, me, you);
+		snapshots.push_back(GameSnapshot(t, me, you));
+		return true;
 	}
 
-	return nullptr;
+	return false;
 }
 
 // Reading a game record, we hit an error before the end of the record.
@@ -225,10 +228,8 @@ void GameRecord::read(std::istream & input)
 		frameEnemyGetsMobileDetection = readNumber(input);
 		frameGameEnds = readNumber(input);
 
-		GameSnapshot * snap;
-		while (snap = readGameSnapshot(input))
+		while (readGameSnapshot(input))
 		{
-			snapshots.push_back(snap);
 		}
 	}
 	catch (const game_record_read_error &)
@@ -241,53 +242,173 @@ void GameRecord::read(std::istream & input)
 void GameRecord::writePlayerSnapshot(std::ostream & output, const PlayerSnapshot & snap)
 {
 	output << snap.numBases;
-	for (auto unitCount : snap.unitCounts)
+	for (auto unitCount : snap.getCounts())
 	{
 		output << ' ' << unitCount.first.getID() << ' ' << unitCount.second;
 	}
 	output << '\n';
 }
 
-void GameRecord::writeGameSnapshot(std::ostream & output, const GameSnapshot * snap)
+void GameRecord::writeGameSnapshot(std::ostream & output, const GameSnapshot & snap)
 {
-	output << snap->frame << '\n';
-	writePlayerSnapshot(output, snap->us);
-	writePlayerSnapshot(output, snap->them);
+	output << snap.frame << '\n';
+	writePlayerSnapshot(output, snap.us);
+	writePlayerSnapshot(output, snap.them);
 }
 
-// Calculate a similarity distance between 2 snapshots.
-// This version is a simple first try. Some unit types should matter more than others.
-// 12 vs. 10 zerglings should count less than 2 vs. 0 lurkers.
-// Buildings and mobile units are hard to compare. Probably should weight by cost in some way.
-// Part of distance().
-int GameRecord::snapDistance(const PlayerSnapshot & a, const PlayerSnapshot & b) const
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+// Binary format helpers.
+// Values are stored in the machine's byte order. The file is only ever read by the bot that wrote it.
+
+template <class T>
+static T readRaw(const char * & p, const char * end)
 {
-	int distance = 0;
+	if (end - p < int(sizeof(T)))
+	{
+		throw game_record_read_error();
+	}
+	T value;
+	memcpy(&value, p, sizeof(T));
+	p += sizeof(T);
+	return value;
+}
+
+template <class T>
+static void writeRaw(std::ostream & output, T value)
+{
+	output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
 
-	// From a to b, count all differences.
-	for (std::pair<BWAPI::UnitType, int> unitCountA : a.unitCounts)
+// A string is a 1-byte length followed by the characters.
+static std::string readRawString(const char * & p, const char * end)
+{
+	const int length = readRaw<uint8_t>(p, end);
+	if (end - p < length)
 	{
-		auto unitCountBIt = b.unitCounts.find(unitCountA.first);
-		if (unitCountBIt == b.unitCounts.end())
+		throw game_record_read_error();
+	}
+	std::string s(p, length);
+	p += length;
+	return s;
+}
+
+static void writeRawString(std::ostream & output, const std::string & s)
+{
+	const size_t length = std::min(s.size(), size_t(255));
+	writeRaw<uint8_t>(output, uint8_t(length));
+	output.write(s.data(), length);
+}
+
+void GameRecord::readBinaryPlayerSnapshot(const char * & p, const char * end, PlayerSnapshot & snap)
+{
+	snap.numBases = readRaw<uint8_t>(p, end);
+	const int nTypes = readRaw<uint8_t>(p, end);
+	for (int i = 0; i < nTypes; ++i)
+	{
+		const int id = readRaw<uint8_t>(p, end);
+		const int n = readRaw<uint16_t>(p, end);
+		snap.setCount(BWAPI::UnitType(id), n);
+	}
+}
+
+// Read one record and leave p at the start of the next one.
+// A record that is framed correctly but fails to parse is marked invalid and skipped.
+// A record that runs past the end of the buffer ends the reading: It is marked invalid
+// and truncated, and p is set to end.
+void GameRecord::readBinary(const char * & p, const char * end)
+{
+	uint32_t length;
+	try
+	{
+		length = readRaw<uint32_t>(p, end);
+	}
+	catch (const game_record_read_error &)
+	{
+		valid = false;
+		truncated = true;
+		p = end;
+		return;
+	}
+	if (uint32_t(end - p) < length)
+	{
+		valid = false;
+		truncated = true;
+		p = end;
+		return;
+	}
+
+	const char * recordEnd = p + length;
+	try
+	{
+		// The fixed-size head of the record.
+		ourRace = charRace(readRaw<char>(p, recordEnd));
+		enemyRace = charRace(readRaw<char>(p, recordEnd));
+		enemyIsRandom = readRaw<uint8_t>(p, recordEnd) != 0;
+		win = readRaw<uint8_t>(p, recordEnd) != 0;
+		gasStealHappened = readRaw<uint8_t>(p, recordEnd) != 0;
+		frameScoutSentForGasSteal = readRaw<int32_t>(p, recordEnd);
+		frameEnemyScoutsOurBase = readRaw<int32_t>(p, recordEnd);
+		frameEnemyGetsCombatUnits = readRaw<int32_t>(p, recordEnd);
+		frameEnemyGetsAirUnits = readRaw<int32_t>(p, recordEnd);
+		frameEnemyGetsStaticAntiAir = readRaw<int32_t>(p, recordEnd);
+		frameEnemyGetsMobileAntiAir = readRaw<int32_t>(p, recordEnd);
+		frameEnemyGetsCloakedUnits = readRaw<int32_t>(p, recordEnd);
+		frameEnemyGetsStaticDetection = readRaw<int32_t>(p, recordEnd);
+		frameEnemyGetsMobileDetection = readRaw<int32_t>(p, recordEnd);
+		frameGameEnds = readRaw<int32_t>(p, recordEnd);
+
+		// Validity check. We should know our own race.
+		if (ourRace == BWAPI::Races::Unknown)
 		{
-			distance += unitCountA.second;
+			throw game_record_read_error();
 		}
-		else
+
+		// The strings.
+		mapName = readRawString(p, recordEnd);
+		openingName = readRawString(p, recordEnd);
+		expectedEnemyPlan = OpeningPlanFromString(readRawString(p, recordEnd));
+		enemyPlan = OpeningPlanFromString(readRawString(p, recordEnd));
+
+		// The snapshots.
+		const int nSnapshots = readRaw<uint16_t>(p, recordEnd);
+		for (int i = 0; i < nSnapshots; ++i)
 		{
-			distance += abs(unitCountA.second - (*unitCountBIt).second);
+			const int t = readRaw<int32_t>(p, recordEnd);
+			PlayerSnapshot me;
+			PlayerSnapshot you;
+			readBinaryPlayerSnapshot(p, recordEnd, me);
+			readBinaryPlayerSnapshot(p, recordEnd, you);
+			snapshots.push_back(GameSnapshot(t, me, you));
 		}
 	}
+	catch (const game_record_read_error &)
+	{
+		valid = false;
+	}
 
-	// From b to a, count differences where a is missing the type.
-	for (std::pair<BWAPI::UnitType, int> unitCountB : b.unitCounts)
+	p = recordEnd;
+}
+
+void GameRecord::writeBinaryPlayerSnapshot(std::ostream & output, const PlayerSnapshot & snap)
+{
+	writeRaw<uint8_t>(output, uint8_t(std::min(snap.numBases, 255)));
+	const std::vector< std::pair<BWAPI::UnitType, int> > unitCounts = snap.getCounts();
+	writeRaw<uint8_t>(output, uint8_t(unitCounts.size()));     // there are fewer than 256 unit types
+	for (auto unitCount : unitCounts)
 	{
-		if (a.unitCounts.find(unitCountB.first) == a.unitCounts.end())
-		{
-			distance += unitCountB.second;
-		}
+		writeRaw<uint8_t>(output, uint8_t(unitCount.first.getID()));
+		writeRaw<uint16_t>(output, uint16_t(unitCount.second));
 	}
+}
 
-	return distance;
+// Calculate a similarity distance between 2 snapshots.
+// This version is a simple first try. Some unit types should matter more than others.
+// 12 vs. 10 zerglings should count less than 2 vs. 0 lurkers.
+// Buildings and mobile units are hard to compare. Probably should weight by cost in some way.
+// Part of distance().
+int GameRecord::snapDistance(const PlayerSnapshot & a, const PlayerSnapshot & b) const
+{
+	return PlayerSnapshot::distance(a, b);
 }
 
 // Figure out whether the enemy has seen our base yet.
@@ -315,6 +436,7 @@ bool GameRecord::enemyScoutedUs() const
 // When this object is initialized, the opening and some other items are not yet known.
 GameRecord::GameRecord()
 	: valid(true)                  // never invalid, since it is recorded live
+	, truncated(false)
 	, savedRecord(false)
 	, ourRace(BWAPI::Broodwar->self()->getRace())
 	, enemyRace(BWAPI::Broodwar->enemy()->getRace())
@@ -340,6 +462,7 @@ GameRecord::GameRecord()
 // Constructor for the record of a past game.
 GameRecord::GameRecord(std::istream & input)
 	: valid(true)                  // until proven otherwise
+	, truncated(false)
 	, savedRecord(true)
 	, ourRace(BWAPI::Races::Unknown)
 	, enemyRace(BWAPI::Races::Unknown)
@@ -362,6 +485,33 @@ GameRecord::GameRecord(std::istream & input)
 	read(input);
 }
 
+// Constructor for the record of a past game, from the binary format.
+// p is advanced to the next record.
+GameRecord::GameRecord(const char * & p, const char * end)
+	: valid(true)                  // until proven otherwise
+	, truncated(false)
+	, savedRecord(true)
+	, ourRace(BWAPI::Races::Unknown)
+	, enemyRace(BWAPI::Races::Unknown)
+	, enemyIsRandom(false)
+	, expectedEnemyPlan(OpeningPlan::Unknown)
+	, enemyPlan(OpeningPlan::Unknown)
+	, win(false)                   // until proven otherwise
+	, frameScoutSentForGasSteal(0)
+	, gasStealHappened(false)
+	, frameEnemyScoutsOurBase(0)
+	, frameEnemyGetsCombatUnits(0)
+	, frameEnemyGetsAirUnits(0)
+	, frameEnemyGetsStaticAntiAir(0)
+	, frameEnemyGetsMobileAntiAir(0)
+	, frameEnemyGetsCloakedUnits(0)
+	, frameEnemyGetsStaticDetection(0)
+	, frameEnemyGetsMobileDetection(0)
+	, frameGameEnds(0)
+{
+	readBinary(p, end);
+}
+
 // Called when the game is over.
 void GameRecord::setWin(bool isWinner)
 {
@@ -432,6 +582,63 @@ void GameRecord::write(std::ostream & output)
 	output << gameEndMark << '\n';
 }
 
+// Write the game record in the binary format:
+
+// record length in bytes, not counting this field (4 bytes)
+// our race, enemy race (1 char each)
+// enemy is random, result, gas steal happened (1 byte each)
+// the 10 frame numbers, in the same order as the text format (4 bytes each)
+// map, opening, expected enemy opening plan, actual enemy opening plan (strings)
+// number of snapshots (2 bytes), then for each snapshot
+//   frame (4 bytes)
+//   for us, then for them: bases (1 byte), number of unit types (1 byte), then (type id, count) (1 + 2 bytes)
+
+// The fixed-size head comes first, so a reader can index the file by hopping from record to record.
+// Unlike the text format, the snapshots are kept. They cost only a few hundred bytes per game.
+
+void GameRecord::writeBinary(std::ostream & output)
+{
+	if (!savedRecord)
+	{
+		expectedEnemyPlan = OpponentModel::Instance().getInitialExpectedEnemyPlan();
+	}
+
+	std::ostringstream body;
+
+	writeRaw<char>(body, RaceChar(ourRace));
+	writeRaw<char>(body, RaceChar(enemyRace));
+	writeRaw<uint8_t>(body, enemyIsRandom ? 1 : 0);
+	writeRaw<uint8_t>(body, win ? 1 : 0);
+	writeRaw<uint8_t>(body, gasStealHappened ? 1 : 0);
+	writeRaw<int32_t>(body, frameScoutSentForGasSteal);
+	writeRaw<int32_t>(body, frameEnemyScoutsOurBase);
+	writeRaw<int32_t>(body, frameEnemyGetsCombatUnits);
+	writeRaw<int32_t>(body, frameEnemyGetsAirUnits);
+	writeRaw<int32_t>(body, frameEnemyGetsStaticAntiAir);
+	writeRaw<int32_t>(body, frameEnemyGetsMobileAntiAir);
+	writeRaw<int32_t>(body, frameEnemyGetsCloakedUnits);
+	writeRaw<int32_t>(body, frameEnemyGetsStaticDetection);
+	writeRaw<int32_t>(body, frameEnemyGetsMobileDetection);
+	writeRaw<int32_t>(body, frameGameEnds);
+
+	writeRawString(body, mapName);
+	writeRawString(body, openingName);
+	writeRawString(body, OpeningPlanString(expectedEnemyPlan));
+	writeRawString(body, OpeningPlanString(enemyPlan));
+
+	writeRaw<uint16_t>(body, uint16_t(snapshots.size()));
+	for (const auto & snap : snapshots)
+	{
+		writeRaw<int32_t>(body, snap.frame);
+		writeBinaryPlayerSnapshot(body, snap.us);
+		writeBinaryPlayerSnapshot(body, snap.them);
+	}
+
+	const std::string bytes = body.str();
+	writeRaw<uint32_t>(output, uint32_t(bytes.size()));
+	output.write(bytes.data(), bytes.size());
+}
+
 void GameRecord::update()
 {
 	int now = BWAPI::Broodwar->getFrameCount();
@@ -533,9 +740,9 @@ int GameRecord::distance(const GameRecord & record) const
 	int latest = 0;
 	while (here != snapshots.end() && there != record.snapshots.end())     // until one record runs out
 	{
-		distance +=     snapDistance((*here)->us,   (*there)->us);
-		distance += 5 * snapDistance((*here)->them, (*there)->them);
-		latest = (*there)->frame;
+		distance +=     snapDistance(here->us,   there->us);
+		distance += 5 * snapDistance(here->them, there->them);
+		latest = there->frame;
 
 		++here;
 		++there;
@@ -557,9 +764,9 @@ bool GameRecord::findClosestSnapshot(int t, PlayerSnapshot & snap) const
 {
 	for (const auto & ourSnap : snapshots)
 	{
-		if (abs(ourSnap->frame - t) < snapshotInterval)
+		if (abs(ourSnap.frame - t) < snapshotInterval)
 		{
-			snap = ourSnap->them;
+			snap = ourSnap.them;
 			return true;
 		}
 	}
@@ -585,11 +792,11 @@ void GameRecord::debugLog()
 		<< "vessels " << frameEnemyGetsMobileDetection << '\n'
 		<< "end of game " << frameGameEnds << '\n';
 
-	for (auto snap : snapshots)
+	for (const auto & snap : snapshots)
 	{
-		msg << snap->frame << '\n'
-			<< snap->us.debugString()
-			<< snap->them.debugString();
+		msg << snap.frame << '\n'
+			<< snap.us.debugString()
+			<< snap.them.debugString();
 	}
 	msg  << '\n';
 
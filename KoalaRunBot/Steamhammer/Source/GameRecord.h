@@ -4,6 +4,7 @@
 #include "OpponentPlan.h"
 #include "PlayerSnapshot.h"
 
+#include <cstdint>
 #include <exception>
 #include <utility>
 
@@ -46,6 +47,9 @@ namespace KoalaRunBot {
     // Is this a valid record, or broken in reading?
     bool valid;
 
+    // Binary format only: Did the record run past the end of the file?
+    bool truncated;
+
     // Is this the record of the current game, or a saved record?
     bool savedRecord;
 
@@ -72,8 +76,9 @@ namespace KoalaRunBot {
     int frameEnemyGetsMobileDetection;
     int frameGameEnds;
 
-    // We allocate the snapshots and never release them.
-    std::vector<GameSnapshot *> snapshots;
+    // The snapshots are allocated in chunks and released with the record.
+    // A deque never moves its elements, so pointers to them stay good.
+    std::deque<GameSnapshot> snapshots;
 
     void takeSnapshot();
 
@@ -87,12 +92,17 @@ namespace KoalaRunBot {
     OpeningPlan readOpeningPlan(std::istream& input);
 
     bool readPlayerSnapshot(std::istream& input, PlayerSnapshot& snap);
-    GameSnapshot* readGameSnapshot(std::istream& input);
+    bool readGameSnapshot(std::istream& input);
     void skipToEnd(std::istream& input);
     void read(std::istream& input);
 
     void writePlayerSnapshot(std::ostream& output, const PlayerSnapshot& snap);
-    void writeGameSnapshot(std::ostream& output, const GameSnapshot* snap);
+    void writeGameSnapshot(std::ostream& output, const GameSnapshot& snap);
+
+    // The binary format. See writeBinary().
+    void readBinaryPlayerSnapshot(const char*& p, const char* end, PlayerSnapshot& snap);
+    void readBinary(const char*& p, const char* end);
+    void writeBinaryPlayerSnapshot(std::ostream& output, const PlayerSnapshot& snap);
 
     int snapDistance(const PlayerSnapshot& a, const PlayerSnapshot& b) const;
 
@@ -101,12 +111,15 @@ namespace KoalaRunBot {
   public:
     GameRecord();
     GameRecord(std::istream& input);
+    GameRecord(const char*& p, const char* end);
 
     bool isValid() { return valid; };
+    bool isTruncated() const { return truncated; };
     void setOpening(const std::string& opening) { openingName = opening; };
     void setWin(bool isWinner);
 
     void write(std::ostream& output);
+    void writeBinary(std::ostream& output);
 
     void update();
 
@@ -114,6 +127,11 @@ namespace KoalaRunBot {
 
     bool findClosestSnapshot(int t, PlayerSnapshot& snap) const;
 
+    int getSnapshotInterval() const { return snapshotInterval; };
+    const std::deque<GameSnapshot>& getSnapshots() const { return snapshots; };
+
+    BWAPI::Race getOurRace() const { return ourRace; };
+    BWAPI::Race getEnemyRace() const { return enemyRace; };
     bool getEnemyIsRandom() const { return enemyIsRandom; };
     bool sameMatchup(const GameRecord& record) const;
     const std::string& getMapName() const { return mapName; };
@@ -4,6 +4,7 @@
 #include "MapTools.h"
 #include "ProductionManager.h"
 #include "Random.h"
+#include "The.h"
 #include "UnitUtil.h"
 
 using namespace KoalaRunBot;
@@ -1329,79 +1330,25 @@ bool InformationManager::enemyHasSiegeMode()
 	return false;
 }
 
-// Our nearest static defense building that can hit ground, by air distance.
-// Null if none.
-// NOTE This assumes that we never put medics or SCVs into a bunker.
+// Our nearest static defense building that can hit ground, by ground distance.
+// If the ground distance gives no answer, by straight-line distance. Null if none.
 BWAPI::Unit InformationManager::nearestGroundStaticDefense(BWAPI::Position pos) const
 {
-	int closestDist = 999999;
-	BWAPI::Unit closest = nullptr;
-	for (BWAPI::Unit building : _staticDefense)
-	{
-		if (building->getType() == BWAPI::UnitTypes::Terran_Bunker && !building->getLoadedUnits().empty() ||
-			building->getType() == BWAPI::UnitTypes::Protoss_Photon_Cannon ||
-			building->getType() == BWAPI::UnitTypes::Zerg_Sunken_Colony)
-		{
-			int dist = building->getDistance(pos);
-			if (dist < closestDist)
-			{
-				closestDist = dist;
-				closest = building;
-			}
-		}
-	}
-	return closest;
+	return The::Root().distance_fields_.NearestUnit(DistanceFields::Layer::kGroundStaticDefense, BWAPI::TilePosition(pos));
 }
 
-// Our nearest static defense building that can hit air, by air distance.
-// Null if none.
-// NOTE This assumes that we only put marines into a bunker: If it is loaded, it can shoot air.
-// If we ever put firebats or SCVs or medics into a bunker, we'll have to do a fancier check.
+// Our nearest static defense building that can hit air, by 4-connected Manhattan tile distance
+// from each building's top-left tile. Null if none.
 BWAPI::Unit InformationManager::nearestAirStaticDefense(BWAPI::Position pos) const
 {
-	int closestDist = 999999;
-	BWAPI::Unit closest = nullptr;
-	for (BWAPI::Unit building : _staticDefense)
-	{
-		if (building->getType() == BWAPI::UnitTypes::Terran_Missile_Turret ||
-			building->getType() == BWAPI::UnitTypes::Terran_Bunker && !building->getLoadedUnits().empty() ||
-			building->getType() == BWAPI::UnitTypes::Protoss_Photon_Cannon || 
-			building->getType() == BWAPI::UnitTypes::Zerg_Spore_Colony)
-		{
-			int dist = building->getDistance(pos);
-			if (dist < closestDist)
-			{
-				closestDist = dist;
-				closest = building;
-			}
-		}
-	}
-	return closest;
+	return The::Root().distance_fields_.NearestUnit(DistanceFields::Layer::kAirStaticDefense, BWAPI::TilePosition(pos));
 }
 
-// Our nearest shield battery, by air distance.
-// Null if none.
+// Our nearest shield battery, by 4-connected Manhattan tile distance from each battery's
+// top-left tile. Null if none.
 BWAPI::Unit InformationManager::nearestShieldBattery(BWAPI::Position pos) const
 {
-	if (_self->getRace() == BWAPI::Races::Protoss)
-	{
-		int closestDist = 999999;
-		BWAPI::Unit closest = nullptr;
-		for (BWAPI::Unit building : _staticDefense)
-		{
-			if (building->getType() == BWAPI::UnitTypes::Protoss_Shield_Battery)
-			{
-				int dist = building->getDistance(pos);
-				if (dist < closestDist)
-				{
-					closestDist = dist;
-					closest = building;
-				}
-			}
-		}
-		return closest;
-	}
-	return nullptr;
+	return The::Root().distance_fields_.NearestUnit(DistanceFields::Layer::kShieldBatteries, BWAPI::TilePosition(pos));
 }
 
 // Zerg specific calculation: How many scourge hits are needed
@@ -1,4 +1,5 @@
 #include "Logger.h"
+#include "AsyncWriter.h"
 #include "UABAssert.h"
 #include <stdarg.h>
 #include <cstdio>
@@ -6,13 +7,10 @@
 
 using namespace KoalaRunBot;
 
+// The writes are done in the background. See AsyncWriter.
 void Logger::LogAppendToFile(const std::string & logFile, const std::string & msg)
 {
-    std::ofstream logStream;
-    logStream.open(logFile.c_str(), std::ofstream::app);
-    logStream << msg;
-    logStream.flush();
-    logStream.close();
+    AsyncWriter::Instance().Append(logFile, msg);
 }
 
 void Logger::LogAppendToFile(const std::string & logFile, const char *fmt, ...)
@@ -24,20 +22,13 @@ void Logger::LogAppendToFile(const std::string & logFile, const char *fmt, ...)
 	char buff[256];
 	vsnprintf_s(buff, 256, fmt, arg);
 	va_end(arg);
-		
-	std::ofstream logStream;
-	logStream.open(logFile.c_str(), std::ofstream::app);
-	logStream << buff;
-	logStream.flush();
-	logStream.close();
+
+	AsyncWriter::Instance().Append(logFile, buff);
 }
 
 void Logger::LogOverwriteToFile(const std::string & logFile, const std::string & msg)
 {
-    std::ofstream logStream(logFile.c_str());
-    logStream << msg;
-    logStream.flush();
-    logStream.close();
+    AsyncWriter::Instance().Overwrite(logFile, msg);
 }
 
 std::string FileUtils::ReadFile(const std::string & filename)
@@ -137,19 +137,54 @@ BWAPI::Position MapGrid::GetCellCenter(int row, int col)
     return GetCellByIndex(row, col).center_;
 }
 
-// clear the vectors in the grid
-void MapGrid::ClearGrid()
+// File the unit under the cell it is in now, moving it if it changed cells.
+void MapGrid::PlaceUnit(BWAPI::Unit unit, bool ours, int frame)
 {
-    for (size_t i(0); i < cells_.size(); ++i)
+    const int id = unit->getID();
+    if (id >= int(unit_cell_.size()))
     {
-        cells_[i].our_units_.clear();
-        cells_[i].opp_units_.clear();
+        unit_cell_.resize(id + 1, -1);
+        unit_ours_.resize(id + 1, 0);
+        unit_frame_.resize(id + 1, -1);
+    }
+
+    const int cellIndex = CellIndex(unit->getPosition());
+    if (unit_cell_[id] != cellIndex || bool(unit_ours_[id]) != ours)
+    {
+        if (unit_cell_[id] < 0)
+        {
+            tracked_units_.push_back(unit);
+        }
+        else
+        {
+            RemoveUnit(unit);
+        }
+        unit_cell_[id] = cellIndex;
+        unit_ours_[id] = ours;
+        (ours ? cells_[cellIndex].our_units_ : cells_[cellIndex].opp_units_).push_back(unit);
+    }
+    unit_frame_[id] = frame;
+}
+
+// Take the unit out of its cell's list. The caller updates unit_cell_ and tracked_units_.
+void MapGrid::RemoveUnit(BWAPI::Unit unit)
+{
+    const int id = unit->getID();
+    GridCell& cell = cells_[unit_cell_[id]];
+    std::vector<BWAPI::Unit>& units = unit_ours_[id] ? cell.our_units_ : cell.opp_units_;
+    auto it = std::find(units.begin(), units.end(), unit);
+    if (it != units.end())
+    {
+        *it = units.back();
+        units.pop_back();
     }
 }
 
 // Populate the grid with units.
 // Include all buildings, but other units only if they are completed.
 // For the enemy, only include visible units (InformationManager remembers units which are out of sight).
+// Units are moved between cells only when they cross a cell boundary, and units which
+// no longer qualify (dead, out of sight, changed owner) are dropped at the end.
 void MapGrid::update()
 {
     if (Config::Debug::DrawMapGrid)
@@ -176,16 +211,16 @@ void MapGrid::update()
         }
     }
 
-    ClearGrid();
-
     //BWAPI::Broodwar->printf("MapGrid info: WH(%d, %d)  CS(%d)  RC(%d, %d)  C(%d)", mapWidth, mapHeight, cellSize, rows, cols, cells.size());
 
+    const int frame = BWAPI::Broodwar->getFrameCount();
+
     for (const auto unit : BWAPI::Broodwar->self()->getUnits())
     {
-        if (unit->isCompleted() || unit->getType().isBuilding())
+        if ((unit->isCompleted() || unit->getType().isBuilding()) && unit->getPosition().isValid())
         {
-            GetCell(unit).our_units_.insert(unit);
-            GetCell(unit).time_last_visited_ = BWAPI::Broodwar->getFrameCount();
+            PlaceUnit(unit, true, frame);
+            GetCell(unit).time_last_visited_ = frame;
         }
     }
 
@@ -194,10 +229,29 @@ void MapGrid::update()
         if (unit->exists() &&
             (unit->isCompleted() || unit->getType().isBuilding()) &&
             unit->getHitPoints() > 0 &&
-            unit->getType() != BWAPI::UnitTypes::Unknown)
+            unit->getType() != BWAPI::UnitTypes::Unknown &&
+            unit->getPosition().isValid())
         {
-            GetCell(unit).opp_units_.insert(unit);
-            GetCell(unit).time_last_opponent_seen_ = BWAPI::Broodwar->getFrameCount();
+            PlaceUnit(unit, false, frame);
+            GetCell(unit).time_last_opponent_seen_ = frame;
+        }
+    }
+
+    // Drop units that were not confirmed this frame.
+    for (size_t i = 0; i < tracked_units_.size(); )
+    {
+        const BWAPI::Unit unit = tracked_units_[i];
+        const int id = unit->getID();
+        if (unit_frame_[id] != frame)
+        {
+            RemoveUnit(unit);
+            unit_cell_[id] = -1;
+            tracked_units_[i] = tracked_units_.back();
+            tracked_units_.pop_back();
+        }
+        else
+        {
+            ++i;
         }
     }
 }
@@ -205,6 +259,17 @@ void MapGrid::update()
 // Return the set of units in the given circle.
 void MapGrid::GetUnits(BWAPI::Unitset& units, BWAPI::Position center, int radius, bool ourUnits, bool oppUnits)
 {
+    for (const auto unit : GetUnits(center, radius, ourUnits, oppUnits))
+    {
+        units.insert(unit);
+    }
+}
+
+// Return the units in the given circle, in a buffer that is reused by the next call.
+const std::vector<BWAPI::Unit>& MapGrid::GetUnits(BWAPI::Position center, int radius, bool ourUnits, bool oppUnits)
+{
+    query_result_.clear();
+
     const int x0(std::max((center.x - radius) / cell_size_, 0));
     const int x1(std::min((center.x + radius) / cell_size_, cols_ - 1));
     const int y0(std::max((center.y - radius) / cell_size_, 0));
@@ -215,10 +280,7 @@ void MapGrid::GetUnits(BWAPI::Unitset& units, BWAPI::Position center, int radius
     {
         for (int x(x0); x <= x1; ++x)
         {
-            int row = y;
-            int col = x;
-
-            const GridCell& cell(GetCellByIndex(row, col));
+            const GridCell& cell(GetCellByIndex(y, x));
             if (ourUnits)
             {
                 for (const auto unit : cell.our_units_)
@@ -226,30 +288,25 @@ void MapGrid::GetUnits(BWAPI::Unitset& units, BWAPI::Position center, int radius
                     BWAPI::Position d(unit->getPosition() - center);
                     if (d.x * d.x + d.y * d.y <= radiusSq)
                     {
-                        if (!units.contains(unit))
-                        {
-                            units.insert(unit);
-                        }
+                        query_result_.push_back(unit);
                     }
                 }
             }
             if (oppUnits)
             {
                 for (const auto unit : cell.opp_units_)
-                    if (unit->getType() != BWAPI::UnitTypes::Unknown)
+                {
+                    BWAPI::Position d(unit->getPosition() - center);
+                    if (d.x * d.x + d.y * d.y <= radiusSq)
                     {
-                        BWAPI::Position d(unit->getPosition() - center);
-                        if (d.x * d.x + d.y * d.y <= radiusSq)
-                        {
-                            if (!units.contains(unit))
-                            {
-                                units.insert(unit);
-                            }
-                        }
+                        query_result_.push_back(unit);
                     }
+                }
             }
         }
     }
+
+    return query_result_;
 }
 
 // We scanned the given position. Record it so we don't scan the same position
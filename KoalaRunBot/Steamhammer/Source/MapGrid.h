@@ -14,8 +14,8 @@ namespace KoalaRunBot
 		int time_last_visited_;
 		int time_last_opponent_seen_;
 		int time_last_scan_;
-		BWAPI::Unitset our_units_;
-		BWAPI::Unitset opp_units_;
+		std::vector<BWAPI::Unit> our_units_;	// unordered; a unit moves only when it changes cells
+		std::vector<BWAPI::Unit> opp_units_;
 		BWAPI::Position center_;
 
 		// Not the ideal place for this constant, but this is where it is used.
@@ -43,9 +43,20 @@ namespace KoalaRunBot
 
 		std::vector<GridCell> cells_;
 
+		// Cell membership is updated incrementally. For each unit ID, the cell it is
+		// filed under (-1 if none), which list it is in, and the frame it was last confirmed there.
+		std::vector<int> unit_cell_;
+		std::vector<char> unit_ours_;
+		std::vector<int> unit_frame_;
+		std::vector<BWAPI::Unit> tracked_units_;	// all units filed in some cell
+
+		std::vector<BWAPI::Unit> query_result_;		// reused by GetUnits()
+
 		void CalculateCellCenters();
 
-		void ClearGrid();
+		void PlaceUnit(BWAPI::Unit unit, bool ours, int frame);
+		void RemoveUnit(BWAPI::Unit unit);
+		int CellIndex(const BWAPI::Position& pos) const { return (pos.y / cell_size_) * cols_ + pos.x / cell_size_; }
 		BWAPI::Position GetCellCenter(int x, int y);
 
 	public:
@@ -55,6 +66,9 @@ namespace KoalaRunBot
 
 		void update();
 		void GetUnits(BWAPI::Unitset& units, BWAPI::Position center, int radius, bool our_units, bool opp_units);
+
+		// The same query without building a Unitset. The result is valid until the next call.
+		const std::vector<BWAPI::Unit>& GetUnits(BWAPI::Position center, int radius, bool our_units, bool opp_units);
 		BWAPI::Position GetLeastExplored() { return GetLeastExplored(false, 1); };
 		BWAPI::Position GetLeastExplored(bool by_ground, int map_partition);
 
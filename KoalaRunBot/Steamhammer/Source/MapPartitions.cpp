@@ -1,5 +1,7 @@
 #include "MapPartitions.h"
 
+#include <algorithm>
+
 #include "UABAssert.h"
 
 using namespace KoalaRunBot;
@@ -13,16 +15,16 @@ using namespace KoalaRunBot;
 void MapPartitions::findUnwalkability()
 {
 	// Fill with zeroes.
-	unwalkability = std::vector< std::vector<unsigned short> >(width, std::vector<unsigned short>(height, 0));
+	unwalkability.assign(width * height, 0);
 
 	// First count terrain.
-	for (int x = 0; x < width; ++x)
+	for (int y = 0; y < height; ++y)
 	{
-		for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
 		{
 			if (!BWAPI::Broodwar->isWalkable(x, y))
 			{
-				unwalkability[x][y] = 1;
+				unwalkability[index(x, y)] = 1;
 			}
 		}
 	}
@@ -41,7 +43,7 @@ void MapPartitions::findUnwalkability()
 				{
 					if (BWAPI::WalkPosition(x, y).isValid())   // assume it may be partly off the edge
 					{
-						unwalkability[x][y] += 1;
+						unwalkability[index(x, y)] += 1;
 					}
 				}
 			}
@@ -51,38 +53,182 @@ void MapPartitions::findUnwalkability()
 
 // Mark a partition: Fill a connected region with the value of numPartitions.
 // This depends on unwalkability[], which must be initialized first.
-// TODO This could be made faster by marking a whole line of tiles at once.
-void MapPartitions::markOnePartition(const BWAPI::WalkPosition & start)
+// Scanline flood fill: Each seed is grown into the longest horizontal run of unmarked walkable
+// tiles, the run is marked, and the rows above and below get one seed per run they touch.
+// The seed stack is passed in so that one buffer serves every partition on the map.
+void MapPartitions::markOnePartition(int startX, int startY, std::vector<int> & seeds)
 {
-	const size_t LegalActions = 4;
-	const int actionX[LegalActions] = { 1, -1, 0, 0 };
-	const int actionY[LegalActions] = { 0, 0, 1, -1 };
+	seeds.clear();
+	seeds.push_back(index(startX, startY));
+
+	while (!seeds.empty())
+	{
+		const int seed = seeds.back();
+		seeds.pop_back();
+
+		const int y = seed / width;
+		const int row = y * width;
+		int left = seed - row;
+
+		if (partition[row + left] != 0)
+		{
+			continue;      // reached through another run since it was pushed
+		}
+
+		int right = left;
+		while (left > 0 && partition[row + left - 1] == 0 && unwalkability[row + left - 1] == 0)
+		{
+			--left;
+		}
+		while (right + 1 < width && partition[row + right + 1] == 0 && unwalkability[row + right + 1] == 0)
+		{
+			++right;
+		}
+
+		for (int x = left; x <= right; ++x)
+		{
+			partition[row + x] = numPartitions;
+		}
+
+		// Seed the start of each unmarked walkable run in the neighboring rows.
+		for (int ny = y - 1; ny <= y + 1; ny += 2)
+		{
+			if (ny < 0 || ny >= height)
+			{
+				continue;
+			}
+			const int nrow = ny * width;
+			bool inRun = false;
+			for (int x = left; x <= right; ++x)
+			{
+				const bool open = partition[nrow + x] == 0 && unwalkability[nrow + x] == 0;
+				if (open && !inRun)
+				{
+					seeds.push_back(nrow + x);
+				}
+				inRun = open;
+			}
+		}
+	}
+}
+
+// Chebyshev distance transform in two raster passes, linear in the number of walk tiles.
+// The forward pass takes the minimum over the neighbors above and to the left, the backward
+// pass over the neighbors below and to the right. Off the map counts as walkable, so only
+// unwalkable tiles limit clearance, as the older dilated masks did. Clearance tops out at 255.
+// This depends on unwalkability[], which must be initialized first.
+void MapPartitions::findClearance()
+{
+	std::vector<int> dist(width * height, 0);
+	const auto at = [&](int x, int y) {
+		return x < 0 || y < 0 || x >= width || y >= height ? 254 : dist[index(x, y)];
+	};
+
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			if (unwalkability[index(x, y)] == 0)
+			{
+				dist[index(x, y)] = 1 + std::min(std::min(at(x - 1, y), at(x - 1, y - 1)), std::min(at(x, y - 1), at(x + 1, y - 1)));
+			}
+		}
+	}
+
+	for (int y = height - 1; y >= 0; --y)
+	{
+		for (int x = width - 1; x >= 0; --x)
+		{
+			if (dist[index(x, y)] > 0)
+			{
+				const int below = 1 + std::min(std::min(at(x + 1, y), at(x + 1, y + 1)), std::min(at(x, y + 1), at(x - 1, y + 1)));
+				dist[index(x, y)] = std::min(dist[index(x, y)], below);
+			}
+		}
+	}
 
-	std::vector<BWAPI::WalkPosition> fringe;
-	fringe.reserve(width * height);
-	fringe.push_back(start);
+	clearance.resize(width * height);
+	for (size_t i = 0; i < dist.size(); ++i)
+	{
+		clearance[i] = (unsigned char)(std::min(dist[i], 255));
+	}
+}
 
-	partition[start.x][start.y] = numPartitions;
+// Flood fill the walk tiles passable for medium (size 1) or large (size 2) units, 4-connected
+// like the walkable partitions.
+// This depends on clearance[], which must be initialized first.
+void MapPartitions::markSizePartitions(int size, std::vector<int> & seeds)
+{
+	std::vector<unsigned short> & marks = sizePartition[size - 1];
+	marks.assign(width * height, 0);
 
-	for (size_t fringeIndex = 0; fringeIndex < fringe.size(); ++fringeIndex)
+	unsigned short n = 0;
+	for (int start = 0; start < width * height; ++start)
 	{
-		const BWAPI::WalkPosition & tile = fringe[fringeIndex];
+		if (marks[start] != 0 || clearance[start] <= size)
+		{
+			continue;
+		}
 
-		// The legal actions define which tiles are nearest neighbors of this one.
-		for (size_t a = 0; a < LegalActions; ++a)
+		++n;
+		marks[start] = n;
+		seeds.clear();
+		seeds.push_back(start);
+		while (!seeds.empty())
 		{
-			BWAPI::WalkPosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+			const int i = seeds.back();
+			seeds.pop_back();
+			const int x = i % width;
+			const int y = i / width;
+			const int next[4] = { x > 0 ? i - 1 : -1, x + 1 < width ? i + 1 : -1, y > 0 ? i - width : -1, y + 1 < height ? i + width : -1 };
+			for (const int j : next)
+			{
+				if (j >= 0 && marks[j] == 0 && clearance[j] > size)
+				{
+					marks[j] = n;
+					seeds.push_back(j);
+				}
+			}
+		}
+	}
+}
 
-			// If the new tile is inside the map bounds, has not been marked yet, and is walkable.
-			if (nextTile.isValid() &&
-				partition[nextTile.x][nextTile.y] == 0 &&
-				walkable(nextTile))
+// The partition of the size at the walk tile of the position, or if the unit doesn't fit there,
+// of the roomiest walk tile within 2. 0 if there is none.
+int MapPartitions::nearbyPassable(const BWAPI::Position & pos, int size) const
+{
+	const BWAPI::WalkPosition walk(pos);
+	const std::vector<unsigned short> & marks = sizePartition[size - 1];
+
+	int best = 0;
+	int bestClearance = size;
+	for (int dy = -2; dy <= 2; ++dy)
+	{
+		for (int dx = -2; dx <= 2; ++dx)
+		{
+			const int x = walk.x + dx;
+			const int y = walk.y + dy;
+			if (x >= 0 && y >= 0 && x < width && y < height && clearance[index(x, y)] > bestClearance)
 			{
-				fringe.push_back(nextTile);
-				partition[nextTile.x][nextTile.y] = numPartitions;
+				best = marks[index(x, y)];
+				bestClearance = clearance[index(x, y)];
 			}
 		}
 	}
+	return best;
+}
+
+int MapPartitions::sizeIndex(BWAPI::UnitSizeType size)
+{
+	if (size == BWAPI::UnitSizeTypes::Large)
+	{
+		return 2;
+	}
+	if (size == BWAPI::UnitSizeTypes::Medium)
+	{
+		return 1;
+	}
+	return 0;
 }
 
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
@@ -100,17 +246,22 @@ void MapPartitions::initialize()
 	height = 4 * BWAPI::Broodwar->mapHeight();
 
 	findUnwalkability();
+	findClearance();
 
-	partition = std::vector< std::vector<unsigned short> >(width, std::vector<unsigned short>(height, 0));
+	partition.assign(width * height, 0);
 
-	for (int x = 0; x < width; ++x)
+	// The seed stack is shared by all partitions. It rarely grows past a few thousand entries.
+	std::vector<int> seeds;
+	seeds.reserve(4 * width);
+
+	for (int y = 0; y < height; ++y)
 	{
-		for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
 		{
-			if (partition[x][y] == 0 && walkable(x, y))
+			if (partition[index(x, y)] == 0 && unwalkability[index(x, y)] == 0)
 			{
 				++numPartitions;
-				markOnePartition(BWAPI::WalkPosition(x, y));
+				markOnePartition(x, y, seeds);
 			}
 		}
 	}
@@ -118,12 +269,15 @@ void MapPartitions::initialize()
 	// BWAPI::Broodwar->printf("map partitions: %d", numPartitions);
 
 	UAB_ASSERT(numPartitions > 0, "no partitions");
+
+	markSizePartitions(1, seeds);
+	markSizePartitions(2, seeds);
 }
 
 bool MapPartitions::walkable(int walkX, int walkY) const
 {
 	UAB_ASSERT(walkX >= 0 && walkY >= 0 && walkX < width && walkY < height, "bad walk tile");
-	return unwalkability[walkX][walkY] == 0;
+	return unwalkability[index(walkX, walkY)] == 0;
 }
 
 bool MapPartitions::walkable(const BWAPI::WalkPosition & pos) const
@@ -131,10 +285,16 @@ bool MapPartitions::walkable(const BWAPI::WalkPosition & pos) const
 	return walkable(pos.x, pos.y);
 }
 
+bool MapPartitions::passable(int walkX, int walkY, BWAPI::UnitSizeType size) const
+{
+	UAB_ASSERT(walkX >= 0 && walkY >= 0 && walkX < width && walkY < height, "bad walk tile");
+	return clearance[index(walkX, walkY)] > sizeIndex(size);
+}
+
 int MapPartitions::id(int walkX, int walkY) const
 {
 	UAB_ASSERT(walkX >= 0 && walkY >= 0 && walkX < width && walkY < height, "bad walk tile");
-	return partition[walkX][walkY];
+	return partition[index(walkX, walkY)];
 }
 
 int MapPartitions::id(const BWAPI::WalkPosition & pos) const
@@ -164,6 +324,18 @@ bool MapPartitions::connected(const BWAPI::Position & a, const BWAPI::Position &
 	return id(a) == id(b);
 }
 
+bool MapPartitions::connected(const BWAPI::Position & a, const BWAPI::Position & b, BWAPI::UnitSizeType size) const
+{
+	const int s = sizeIndex(size);
+	if (s == 0)
+	{
+		return connected(a, b);
+	}
+
+	const int idA = nearbyPassable(a, s);
+	return idA != 0 && idA == nearbyPassable(b, s);
+}
+
 void MapPartitions::drawWalkable() const
 {
 	for (int x = 0; x < width; ++x)
@@ -188,7 +360,7 @@ void MapPartitions::drawPartition(int i, BWAPI::Color color) const
 		{
 			for (int y = 0; y < height; ++y)
 			{
-				if (partition[x][y] == i)
+				if (partition[index(x, y)] == i)
 				{
 					BWAPI::Position pos = BWAPI::Position(BWAPI::WalkPosition(x, y));
 					BWAPI::Broodwar->drawCircleMap(pos.x + 4, pos.y + 4, 1, color);
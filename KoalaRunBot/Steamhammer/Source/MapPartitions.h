@@ -18,6 +18,14 @@
 // it is wide enough at every point for the unit to pass.
 // If two walk tiles are not in the same partition, no unit can walk between them.
 
+// The clearance of a walk tile is its Chebyshev distance in walk tiles to the nearest
+// unwalkable walk tile, 0 if it is unwalkable itself. The map edge does not count.
+// A walk tile is passable for a unit size if the unit can stand centered on it: Small units
+// need clearance 1 (the tile itself walkable), medium units 2, and large units 3. It is an
+// approximation of the unit dimensions.
+// Each unit size also gets its own partitions of the tiles passable for it. Large units like
+// ultralisks and archons can only walk between two points in the same large partition.
+
 namespace KoalaRunBot
 {
 	class MapPartitions
@@ -26,11 +34,21 @@ namespace KoalaRunBot
 		int height;		// in walk tiles
 		int numPartitions;
 
-		std::vector< std::vector<unsigned short> > unwalkability;	// 0 if walkable, otherwise count of blockages
-		std::vector< std::vector<unsigned short> > partition;		// 0 if unwalkable, otherwise partition ID
+		// Flat row-major arrays of walk tiles, indexed by index(x, y).
+		std::vector<unsigned short> unwalkability;	// 0 if walkable, otherwise count of blockages
+		std::vector<unsigned short> partition;		// 0 if unwalkable, otherwise partition ID
+		std::vector<unsigned char> clearance;		// in walk tiles, capped at 255
+		std::vector<unsigned short> sizePartition[2];	// medium, large: 0 if not passable
+
+		static int sizeIndex(BWAPI::UnitSizeType size);
+
+		int index(int walkX, int walkY) const { return walkY * width + walkX; };
 
 		void findUnwalkability();
-		void markOnePartition(const BWAPI::WalkPosition & start);
+		void markOnePartition(int startX, int startY, std::vector<int> & seeds);
+		void findClearance();
+		void markSizePartitions(int size, std::vector<int> & seeds);
+		int nearbyPassable(const BWAPI::Position & pos, int size) const;
 
 	public:
 		MapPartitions();
@@ -38,6 +56,11 @@ namespace KoalaRunBot
 
 		bool walkable(int walkX, int walkY) const;
 		bool walkable(const BWAPI::WalkPosition & pos) const;
+
+		int getClearance(int walkX, int walkY) const { return clearance[index(walkX, walkY)]; };
+
+		// Can a unit of this size stand centered on the walk tile?
+		bool passable(int walkX, int walkY, BWAPI::UnitSizeType size) const;
 		
 		// Return the partition ID of a given spot.
 		int id(int walkX, int walkY) const;
@@ -49,7 +72,13 @@ namespace KoalaRunBot
 		bool connected(const BWAPI::TilePosition & a, const BWAPI::TilePosition & b) const;
 		bool connected(const BWAPI::Position & a, const BWAPI::Position & b) const;
 
+		// Can a unit of this size walk between the two points?
+		// A point that is too cramped for the unit counts as the nearest roomy spot within 2 walk tiles.
+		bool connected(const BWAPI::Position & a, const BWAPI::Position & b, BWAPI::UnitSizeType size) const;
+
 		int getNumPartitions() const { return numPartitions; };
+		int getWidth() const { return width; };
+		int getHeight() const { return height; };
 
 		void drawWalkable() const;
 		void drawPartition(int i, BWAPI::Color color) const;
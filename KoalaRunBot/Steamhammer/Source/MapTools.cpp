@@ -18,6 +18,7 @@ MapTools::MapTools()
 {
 	// Figure out which tiles are walkable and buildable.
 	setBWAPIMapData();
+	setChokeDistance();
 
 	_hasIslandBases = false;
 	for (BWTA::BaseLocation * base : BWTA::getBaseLocations())
@@ -34,31 +35,57 @@ MapTools::MapTools()
 	//BWAPI::Broodwar->printf("start position %d,%d", homePosition.x, homePosition.y);
 }
 
+// Stamp each chokepoint onto the walk tiles within 255 pixels of its center, keeping the
+// nearest. The micro code asks "is this unit near a choke?" for many units every frame, and
+// this turns a scan over all the chokepoints into one lookup.
+// BWTA must have analyzed the map first.
+void MapTools::setChokeDistance()
+{
+	const int width = 4 * BWAPI::Broodwar->mapWidth();
+	const int height = 4 * BWAPI::Broodwar->mapHeight();
+	const int reach = 255 / 8 + 1;		// in walk tiles
+
+	_chokeDistance.assign(width * height, 255);
+	for (BWTA::Chokepoint * choke : BWTA::getChokepoints())
+	{
+		const BWAPI::Position center = choke->getCenter();
+		const BWAPI::WalkPosition walk(center);
+		for (int y = std::max(0, walk.y - reach); y <= std::min(height - 1, walk.y + reach); ++y)
+		{
+			for (int x = std::max(0, walk.x - reach); x <= std::min(width - 1, walk.x + reach); ++x)
+			{
+				const int dist = int(center.getDistance(BWAPI::Position(8 * x + 4, 8 * y + 4)));
+				unsigned char & cell = _chokeDistance[y * width + x];
+				if (dist < cell)
+				{
+					cell = (unsigned char)(dist);
+				}
+			}
+		}
+	}
+}
+
 // Read the map data from BWAPI and remember which 32x32 build tiles are walkable.
 // NOTE The game map is walkable at the resolution of 8x8 walk tiles, so this is an approximation.
 //      We're asking "Can big units walk here?" Small units may be able to squeeze into more places.
 void MapTools::setBWAPIMapData()
 {
+	const int width = BWAPI::Broodwar->mapWidth();
+	const int height = BWAPI::Broodwar->mapHeight();
+
 	// 1. Mark all tiles walkable and buildable at first.
-	_terrainWalkable = std::vector< std::vector<bool> >(BWAPI::Broodwar->mapWidth(), std::vector<bool>(BWAPI::Broodwar->mapHeight(), true));
-	_walkable = std::vector< std::vector<bool> >(BWAPI::Broodwar->mapWidth(), std::vector<bool>(BWAPI::Broodwar->mapHeight(), true));
-	_buildable = std::vector< std::vector<bool> >(BWAPI::Broodwar->mapWidth(), std::vector<bool>(BWAPI::Broodwar->mapHeight(), true));
-	_depotBuildable = std::vector< std::vector<bool> >(BWAPI::Broodwar->mapWidth(), std::vector<bool>(BWAPI::Broodwar->mapHeight(), true));
+	_terrainWalkable = BitGrid(width, height, true);
+	_buildable = BitGrid(width, height, true);
 
 	// 2. Check terrain: Is it buildable? Is it walkable?
-	// This sets _walkable and _terrainWalkable identically.
-	for (int x = 0; x < BWAPI::Broodwar->mapWidth(); ++x)
+	for (int x = 0; x < width; ++x)
 	{
-		for (int y = 0; y < BWAPI::Broodwar->mapHeight(); ++y)
+		for (int y = 0; y < height; ++y)
 		{
-			// This initializes all cells of _buildable and _depotBuildable.
-			bool buildable = BWAPI::Broodwar->isBuildable(BWAPI::TilePosition(x, y), false);
-			_buildable[x][y] = buildable;
-			_depotBuildable[x][y] = buildable;
-
-			bool walkable = true;
+			_buildable.Set(x, y, BWAPI::Broodwar->isBuildable(BWAPI::TilePosition(x, y), false));
 
 			// Check each 8x8 walk tile within this 32x32 TilePosition.
+			bool walkable = true;
 			for (int i = 0; i < 4 && walkable; ++i)
 			{
 				for (int j = 0; j < 4 && walkable; ++j)
@@ -66,8 +93,7 @@ void MapTools::setBWAPIMapData()
 					if (!BWAPI::Broodwar->isWalkable(x * 4 + i, y * 4 + j))
 					{
 						walkable = false;   // break out of both loops
-						_terrainWalkable[x][y] = false;
-						_walkable[x][y] = false;
+						_terrainWalkable.Set(x, y, false);
 					}
 				}
 			}
@@ -76,60 +102,36 @@ void MapTools::setBWAPIMapData()
 
 	// 3. Check neutral units: Do they block walkability?
 	// This affects _walkable but not _terrainWalkable. We don't update buildability here.
+	_walkable = _terrainWalkable;
 	for (const auto unit : BWAPI::Broodwar->getStaticNeutralUnits())
 	{
 		// The neutral units may include moving critters which do not permanently block tiles.
 		// Something immobile blocks tiles it occupies until it is destroyed. (Are there exceptions?)
+		// The unit may be partly off the edge; SetRect() clips it.
 		if (!unit->getType().canMove() && !unit->isFlying())
 		{
 			BWAPI::TilePosition pos = unit->getTilePosition();
-			for (int x = pos.x; x < pos.x + unit->getType().tileWidth(); ++x)
-			{
-				for (int y = pos.y; y < pos.y + unit->getType().tileHeight(); ++y)
-				{
-					if (BWAPI::TilePosition(x, y).isValid())   // assume it may be partly off the edge
-					{
-						_walkable[x][y] = false;
-					}
-				}
-			}
+			_walkable.SetRect(pos.x, pos.y, pos.x + unit->getType().tileWidth(), pos.y + unit->getType().tileHeight(), false);
 		}
 	}
 
 	// 4. Check static resources: Do they block buildability?
+	// Depots can't be built within 3 tiles of any resource: dilate the resource tiles by 3.
+	BitGrid resourceTiles(width, height, false);
 	for (const BWAPI::Unit resource : BWAPI::Broodwar->getStaticNeutralUnits())
 	{
-		if (!resource->getType().isResourceContainer())
+		if (resource->getType().isResourceContainer())
 		{
-			continue;
+			BWAPI::TilePosition pos = resource->getTilePosition();
+			resourceTiles.SetRect(pos.x, pos.y, pos.x + resource->getType().tileWidth(), pos.y + resource->getType().tileHeight(), true);
 		}
+	}
 
-		int tileX = resource->getTilePosition().x;
-		int tileY = resource->getTilePosition().y;
+	_depotBuildable = _buildable;
+	_buildable.AndNot(resourceTiles);
 
-		for (int x = tileX; x<tileX + resource->getType().tileWidth(); ++x)
-		{
-			for (int y = tileY; y<tileY + resource->getType().tileHeight(); ++y)
-			{
-				_buildable[x][y] = false;
-
-				// depots can't be built within 3 tiles of any resource
-				// TODO rewrite this to be less disgusting
-				for (int dx = -3; dx <= 3; dx++)
-				{
-					for (int dy = -3; dy <= 3; dy++)
-					{
-						if (!BWAPI::TilePosition(x + dx, y + dy).isValid())
-						{
-							continue;
-						}
-
-						_depotBuildable[x + dx][y + dy] = false;
-					}
-				}
-			}
-		}
-	}
+	resourceTiles.Dilate(3);
+	_depotBuildable.AndNot(resourceTiles);
 }
 
 // Ground distance in tiles, -1 if no path exists.
@@ -196,32 +198,26 @@ const std::vector<BWAPI::TilePosition> & MapTools::getClosestTilesTo(BWAPI::Posi
 	return getClosestTilesTo(BWAPI::TilePosition(pos));
 }
 
-bool MapTools::isBuildable(BWAPI::TilePosition tile, BWAPI::UnitType type) const
+// Accurate to the 8x8 walk tile.
+int MapTools::getChokeDistance(const BWAPI::Position & pos) const
 {
-	if (!tile.isValid())
+	const BWAPI::WalkPosition walk(pos);
+	if (!walk.isValid())
 	{
-		return false;
+		return 255;
 	}
+	return _chokeDistance[walk.y * 4 * BWAPI::Broodwar->mapWidth() + walk.x];
+}
 
-	int startX = tile.x;
-	int endX = tile.x + type.tileWidth();
-	int startY = tile.y;
-	int endY = tile.y + type.tileHeight();
-
-	for (int x = startX; x<endX; ++x)
+bool MapTools::isBuildable(BWAPI::TilePosition tile, BWAPI::UnitType type) const
+{
+	if (!tile.isValid())
 	{
-		for (int y = startY; y<endY; ++y)
-		{
-			BWAPI::TilePosition tile(x, y);
-
-			if (!tile.isValid() || !isBuildable(tile) || type.isResourceDepot() && !isDepotBuildable(tile))
-			{
-				return false;
-			}
-		}
+		return false;
 	}
 
-	return true;
+	const BitGrid & layer = type.isResourceDepot() ? _depotBuildable : _buildable;
+	return layer.AllInRect(tile.x, tile.y, tile.x + type.tileWidth(), tile.y + type.tileHeight());
 }
 
 void MapTools::drawHomeDistances()
@@ -347,21 +343,26 @@ Base * MapTools::nextExpansion(bool hidden, bool wantMinerals, bool wantGas)
 			}
         }
 
-		// Want to be far from the enemy base.
-		double distanceFromEnemy = 0.0;
-		if (enemyBase) {
-			BWAPI::TilePosition enemyTile = enemyBase->getTilePosition();
-			distanceFromEnemy = MapTools::Instance().getGroundTileDistance(tile, enemyTile);
-			if (distanceFromEnemy < 0)
-			{
-				// No ground distance found, so again substitute air distance.
-				if (the.map_partitions_.id(tile) == the.map_partitions_.id(enemyTile))
-				{
-					distanceFromEnemy = enemyTile.getDistance(tile);
-				}
-				else
+		// Want to be far from the enemy's bases, the nearest of them by ground.
+		// If none is known or reachable, fall back on the enemy main.
+		double distanceFromEnemy = the.distance_fields_.Distance(DistanceFields::Layer::kEnemyBases, tile);
+		if (distanceFromEnemy < 0.0)
+		{
+			distanceFromEnemy = 0.0;
+			if (enemyBase) {
+				BWAPI::TilePosition enemyTile = enemyBase->getTilePosition();
+				distanceFromEnemy = MapTools::Instance().getGroundTileDistance(tile, enemyTile);
+				if (distanceFromEnemy < 0)
 				{
-					distanceFromEnemy = 0.0;
+					// No ground distance found, so again substitute air distance.
+					if (the.map_partitions_.id(tile) == the.map_partitions_.id(enemyTile))
+					{
+						distanceFromEnemy = enemyTile.getDistance(tile);
+					}
+					else
+					{
+						distanceFromEnemy = 0.0;
+					}
 				}
 			}
 		}
@@ -3,6 +3,7 @@
 #include <BWTA.h>
 #include <vector>
 
+#include "BitGrid.h"
 #include "Common.h"
 #include "GridDistances.h"
 
@@ -21,17 +22,16 @@ class MapTools
 
 	std::map<BWAPI::TilePosition, GridDistances>
 						_allMaps;			// a cache of already computed distance maps
-	std::vector< std::vector<bool> >
-						_terrainWalkable;	// walkable considering terrain only
-	std::vector< std::vector<bool> >
-						_walkable;			// walkable considering terrain and neutral units
-	std::vector< std::vector<bool> >
-						_buildable;
-	std::vector< std::vector<bool> >
-						_depotBuildable;
+	BitGrid				_terrainWalkable;	// walkable considering terrain only
+	BitGrid				_walkable;			// walkable considering terrain and neutral units
+	BitGrid				_buildable;
+	BitGrid				_depotBuildable;
 	bool				_hasIslandBases;
+	std::vector<unsigned char>
+						_chokeDistance;		// per walk tile, pixels to the nearest choke center, capped at 255
 
     void				setBWAPIMapData();					// reads in the map data from bwapi and stores it in our map format
+	void				setChokeDistance();
 
 	Base *				nextExpansion(bool hidden, bool wantMinerals, bool wantGas);
 
@@ -46,13 +46,21 @@ public:
 	int		getGroundDistance(BWAPI::Position from, BWAPI::Position to);
 
 	// Pass only valid tiles to these routines!
-	bool	isTerrainWalkable(BWAPI::TilePosition tile) const { return _terrainWalkable[tile.x][tile.y]; };
-	bool	isWalkable(BWAPI::TilePosition tile) const { return _walkable[tile.x][tile.y]; };
-	bool	isBuildable(BWAPI::TilePosition tile) const { return _buildable[tile.x][tile.y]; };
-	bool	isDepotBuildable(BWAPI::TilePosition tile) const { return _depotBuildable[tile.x][tile.y]; };
+	bool	isTerrainWalkable(BWAPI::TilePosition tile) const { return _terrainWalkable.Get(tile.x, tile.y); };
+	bool	isWalkable(BWAPI::TilePosition tile) const { return _walkable.Get(tile.x, tile.y); };
+	bool	isBuildable(BWAPI::TilePosition tile) const { return _buildable.Get(tile.x, tile.y); };
+	bool	isDepotBuildable(BWAPI::TilePosition tile) const { return _depotBuildable.Get(tile.x, tile.y); };
+
+	// The whole layers, for word-parallel tests.
+	const BitGrid &	getWalkableGrid() const { return _walkable; };
+	const BitGrid &	getBuildableGrid() const { return _buildable; };
+	const BitGrid &	getDepotBuildableGrid() const { return _depotBuildable; };
 
 	bool	isBuildable(BWAPI::TilePosition tile, BWAPI::UnitType type) const;
 
+	// Distance in pixels from the position to the nearest BWTA chokepoint center, 255 if farther.
+	int		getChokeDistance(const BWAPI::Position & pos) const;
+
 	const std::vector<BWAPI::TilePosition> & getClosestTilesTo(BWAPI::TilePosition pos);
 	const std::vector<BWAPI::TilePosition> & getClosestTilesTo(BWAPI::Position pos);
 
@@ -296,6 +296,24 @@ void Micro::Move(BWAPI::Unit attacker, const BWAPI::Position & targetPosition)
     }
 }
 
+// Move along a path that avoids known enemy defenses where the detour is worth it.
+// Until the path service has a path, or when the target is near, move straight there.
+void Micro::MoveSafely(BWAPI::Unit unit, const BWAPI::Position & targetPosition)
+{
+	if (!unit || !unit->exists() || !unit->getPosition().isValid() || !targetPosition.isValid())
+	{
+		return;
+	}
+
+	if (unit->getDistance(targetPosition) <= 6 * 32)
+	{
+		Move(unit, targetPosition);
+		return;
+	}
+
+	Move(unit, the.path_service_.NextWaypoint(unit->getPosition(), targetPosition, unit->isFlying()));
+}
+
 void Micro::RightClick(BWAPI::Unit unit, BWAPI::Unit target)
 {
 	if (!unit || !unit->exists() || unit->getPlayer() != BWAPI::Broodwar->self() ||
@@ -48,6 +48,7 @@ public:
 	void AttackUnit(BWAPI::Unit attacker, BWAPI::Unit target);
     void AttackMove(BWAPI::Unit attacker, const BWAPI::Position & targetPosition);
     void Move(BWAPI::Unit attacker, const BWAPI::Position & targetPosition);
+	void MoveSafely(BWAPI::Unit unit, const BWAPI::Position & targetPosition);
 	void RightClick(BWAPI::Unit unit, BWAPI::Unit target);
 	void MineMinerals(BWAPI::Unit unit, BWAPI::Unit mineralPatch);
 	void LaySpiderMine(BWAPI::Unit unit, BWAPI::Position pos);
@@ -35,6 +35,9 @@ void MicroAirToAir::assignTargets(const BWAPI::Unitset & airUnits, const BWAPI::
 			!u->isStasised();
 	});
 
+	// Units that are free to fight this frame.
+	BWAPI::Unitset fighters;
+
     for (const auto airUnit : airUnits)
 	{
 		// Special case for irradiated devourers. Try not to endanger our other units.
@@ -52,102 +55,116 @@ void MicroAirToAir::assignTargets(const BWAPI::Unitset & airUnits, const BWAPI::
 		}
 
 		if (order.isCombatOrder())
-        {
-			BWAPI::Unit target = getTarget(airUnit, airTargets);
-			if (target)
-			{
-				// A target was found.
-				if (Config::Debug::DrawUnitTargetInfo)
-				{
-					BWAPI::Broodwar->drawLineMap(airUnit->getPosition(), airUnit->getTargetPosition(), BWAPI::Colors::Purple);
-				}
+		{
+			fighters.insert(airUnit);
+		}
+	}
 
-				the.micro_.CatchAndAttackUnit(airUnit, target);
-			}
-			else
+	std::map<BWAPI::Unit, BWAPI::Unit> targetOf;
+	if (!fighters.empty())
+	{
+		the.target_assigner_.Assign(fighters, airTargets,
+			[this](BWAPI::Unit airUnit, BWAPI::Unit target) { return getScore(airUnit, target); },
+			targetOf);
+	}
+
+	for (const auto airUnit : fighters)
+	{
+		BWAPI::Unit target = targetOf[airUnit];
+		if (target)
+		{
+			// A target was found.
+			if (Config::Debug::DrawUnitTargetInfo)
 			{
-				// No target found. Go to the attack position.
-				the.micro_.AttackMove(airUnit, order.getPosition());
+				BWAPI::Broodwar->drawLineMap(airUnit->getPosition(), airUnit->getTargetPosition(), BWAPI::Colors::Purple);
 			}
+
+			the.micro_.CatchAndAttackUnit(airUnit, target);
+		}
+		else
+		{
+			// No target found. Go to the attack position.
+			the.micro_.AttackMove(airUnit, order.getPosition());
 		}
 	}
 }
 
-// This could return null if no target is worth attacking, but doesn't happen to.
-BWAPI::Unit MicroAirToAir::getTarget(BWAPI::Unit airUnit, const BWAPI::Unitset & targets)
+// The score of attacking the target, or kNoTarget to skip it.
+int MicroAirToAir::getScore(BWAPI::Unit airUnit, BWAPI::Unit target)
 {
-	int bestScore = -999999;
-	BWAPI::Unit bestTarget = nullptr;
+	const int priority = getAttackPriority(airUnit, target);		// 0..12
+	const int range = airUnit->getDistance(target);					// 0..map size in pixels
+	const int closerToGoal =										// positive if target is closer than us to the goal
+		airUnit->getDistance(order.getPosition()) - target->getDistance(order.getPosition());
 
-	for (const auto target : targets)
+	// Skip targets that are too far away to worry about.
+	if (range >= 13 * 32)
 	{
-		const int priority = getAttackPriority(airUnit, target);		// 0..12
-		const int range = airUnit->getDistance(target);					// 0..map size in pixels
-		const int closerToGoal =										// positive if target is closer than us to the goal
-			airUnit->getDistance(order.getPosition()) - target->getDistance(order.getPosition());
+		return TargetAssigner::kNoTarget;
+	}
 
-		// Skip targets that are too far away to worry about.
-		if (range >= 13 * 32)
-		{
-			continue;
-		}
+	// Let's say that 1 priority step is worth 160 pixels (5 tiles).
+	// We care about unit-target range and target-order position distance.
+	int score = 5 * 32 * priority - range;
 
-		// Let's say that 1 priority step is worth 160 pixels (5 tiles).
-		// We care about unit-target range and target-order position distance.
-		int score = 5 * 32 * priority - range;
+	// Adjust for special features.
+	// A bonus for attacking enemies that are "in front".
+	// It helps reduce distractions from moving toward the goal, the order position.
+	if (closerToGoal > 0)
+	{
+		score += 3 * 32;
+	}
 
-		// Adjust for special features.
-		// A bonus for attacking enemies that are "in front".
-		// It helps reduce distractions from moving toward the goal, the order position.
-		if (closerToGoal > 0)
-		{
-			score += 3 * 32;
-		}
+	// This could adjust for relative speed and direction, so that we don't chase what we can't catch.
+	if (airUnit->isInWeaponRange(target))
+	{
+		score += 4 * 32;
+	}
+	else if (!target->isMoving())
+	{
+		score += 24;
+	}
+	else if (target->isBraking())
+	{
+		score += 16;
+	}
+	else if (target->getPlayer()->topSpeed(target->getType()) >= airUnit->getPlayer()->topSpeed(airUnit->getType()))
+	{
+		score -= 5 * 32;
+	}
+	
+	// Prefer targets that are already hurt.
+	if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() == 0)
+	{
+		score += 32;
+	}
+	if (target->getHitPoints() < target->getType().maxHitPoints())
+	{
+		score += 24;
+	}
 
-		// This could adjust for relative speed and direction, so that we don't chase what we can't catch.
-		if (airUnit->isInWeaponRange(target))
-		{
-			score += 4 * 32;
-		}
-		else if (!target->isMoving())
-		{
-			score += 24;
-		}
-		else if (target->isBraking())
-		{
-			score += 16;
-		}
-		else if (target->getPlayer()->topSpeed(target->getType()) >= airUnit->getPlayer()->topSpeed(airUnit->getType()))
-		{
-			score -= 5 * 32;
-		}
-		
-		// Prefer targets that are already hurt.
-		if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() == 0)
-		{
-			score += 32;
-		}
-		if (target->getHitPoints() < target->getType().maxHitPoints())
-		{
-			score += 24;
-		}
+	// TODO prefer targets in groups, so they'll all get splashed
+
+	return score;
+}
 
-		// TODO prefer targets in groups, so they'll all get splashed
+// get the attack priority of a target unit
+int MicroAirToAir::getAttackPriority(BWAPI::Unit airUnit, BWAPI::Unit target)
+{
+	// Whether the target is far enough outside its range, if it can attack us.
+	const bool farFromThreat =
+		airUnit->getDistance(target) > 64 + the.attack_table_.Range(target->getPlayer(), target->getType(), airUnit->isFlying());
 
-		if (score > bestScore)
+	return priorityMemo.Get(airUnit->getType(), target, farFromThreat,
+		[this](BWAPI::UnitType rangedType, BWAPI::Unit target, bool farFromThreat)
 		{
-			bestScore = score;
-			bestTarget = target;
-		}
-	}
-	
-	return bestTarget;
+			return getTypeAttackPriority(rangedType, target, farFromThreat);
+		});
 }
 
-// get the attack priority of a target unit
-int MicroAirToAir::getAttackPriority(BWAPI::Unit airUnit, BWAPI::Unit target) 
+// The part of the attack priority that depends only on the attacker's type.
+int MicroAirToAir::getTypeAttackPriority(BWAPI::UnitType rangedType, BWAPI::Unit target, bool farFromThreat)
 {
-	const BWAPI::UnitType rangedType = airUnit->getType();
 	const BWAPI::UnitType targetType = target->getType();
 
 	// Devourers are different from the others.
@@ -177,10 +194,10 @@ int MicroAirToAir::getAttackPriority(BWAPI::Unit airUnit, BWAPI::Unit target)
 	}
 
 	// Threats can attack us back.
-	if (UnitUtil::TypeCanAttackAir(targetType))    // includes carriers
+	if (the.attack_table_.CanAttack(targetType, true))    // includes carriers
 	{
 		// Enemy unit which is far enough outside its range is lower priority.
-		if (airUnit->getDistance(target) > 64 + UnitUtil::GetAttackRange(target, airUnit))
+		if (farFromThreat)
 		{
 			return 8;
 		}
@@ -17,7 +17,8 @@ public:
 	BWAPI::Unit chooseTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets, std::map<BWAPI::Unit, int> & numTargeting);
 
 	int getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target);
-	BWAPI::Unit getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets);
+	int getTypeAttackPriority(BWAPI::UnitType rangedType, BWAPI::Unit target, bool farFromThreat);
+	int getScore(BWAPI::Unit rangedUnit, BWAPI::Unit target);
 
 };
 }
\ No newline at end of file
@@ -5,8 +5,9 @@
 using namespace KoalaRunBot;
 
 // NOTE
-// The computations to decide whether and where to swarm and plague are expensive.
-// Don't have too many defilers at the same time, or you'll time out.
+// The computations to decide whether and where to swarm and plague score an area around
+// the defiler with summed-area tables, so each candidate box costs a few lookups.
+// Still, each defiler rasterizes its own area, so don't have too many at the same time.
 
 // We need to consume and have it researched. Look around for food.
 // For now, we consume zerglings.
@@ -134,46 +135,63 @@ bool MicroDefilers::maybeSwarm(BWAPI::Unit defiler, bool aboutToDie)
 		return false;
 	}
 
+	// Score the area once: each unit goes into the tile at its center, and the enemy building
+	// and ranged unit flags go into every tile the unit touches. Then each box is a few lookups.
+	// Every candidate box is tiles [x-3,x+3) x [y-3,y+3).
+	const BWAPI::TilePosition here = defiler->getTilePosition();
+	const int minX = std::max(3, here.x - limit);
+	const int maxX = std::min(BWAPI::Broodwar->mapWidth() - 4, here.x + limit);
+	const int minY = std::max(3, here.y - limit);
+	const int maxY = std::min(BWAPI::Broodwar->mapHeight() - 4, here.y + limit);
+	_swarmScores.Reset(minX - 3, minY - 3, maxX - minX + 6, maxY - minY + 6);
+	_enemyBuildings.Reset(minX - 3, minY - 3, maxX - minX + 6, maxY - minY + 6);
+	_rangedEnemies.Reset(minX - 3, minY - 3, maxX - minX + 6, maxY - minY + 6);
+
+	const BWAPI::Unitset nearby = BWAPI::Broodwar->getUnitsInRectangle(
+		BWAPI::Position(BWAPI::TilePosition(minX - 3, minY - 3)),
+		BWAPI::Position(BWAPI::TilePosition(maxX + 3, maxY + 3)));
+	for (BWAPI::Unit u : nearby)
+	{
+		const BWAPI::TilePosition tile(u->getPosition());
+		if (u->getPlayer() == BWAPI::Broodwar->self())
+		{
+			_swarmScores.Add(tile.x, tile.y, swarmScore(u));
+		}
+		else if (u->getPlayer() == BWAPI::Broodwar->enemy())
+		{
+			_swarmScores.Add(tile.x, tile.y, -swarmScore(u));
+			if (u->getType().isBuilding() && !u->getType().isAddon())
+			{
+				_swarmScores.Add(tile.x, tile.y, 2);		// enemy buildings under swarm are targets
+				_enemyBuildings.AddRect(u->getLeft() / 32, u->getTop() / 32, u->getRight() / 32 + 1, u->getBottom() / 32 + 1, 1);
+			}
+			if (u->getType().groundWeapon() != BWAPI::WeaponTypes::None &&
+				u->getType().groundWeapon().maxRange() > 32)
+			{
+				_rangedEnemies.AddRect(u->getLeft() / 32, u->getTop() / 32, u->getRight() / 32 + 1, u->getBottom() / 32 + 1, 1);
+			}
+		}
+	}
+	_swarmScores.Build();
+	_enemyBuildings.Build();
+	_rangedEnemies.Build();
+
 	// Look for the box with the best effect.
 	// NOTE This is not really the calculation we want. Better would be to find the box
 	// that nullifies the most enemy fire where we want to attack, no matter where the fire is from.
 	int bestScore = 0;
 	BWAPI::Position bestPlace = defiler->getPosition();
-	for (int tileX = std::max(3, defiler->getTilePosition().x - limit); tileX <= std::min(BWAPI::Broodwar->mapWidth() - 4, defiler->getTilePosition().x + limit); ++tileX)
+	for (int tileX = minX; tileX <= maxX; ++tileX)
 	{
-		for (int tileY = std::max(3, defiler->getTilePosition().y - limit); tileY <= std::min(BWAPI::Broodwar->mapHeight() - 4, defiler->getTilePosition().y + limit); ++tileY)
+		for (int tileY = minY; tileY <= maxY; ++tileY)
 		{
-			int score = 0;
-			bool hasEnemyBuilding = false;
-			bool hasRangedEnemy = false;
-			BWAPI::Position place(BWAPI::TilePosition(tileX, tileY));
-			const BWAPI::Position offset(3 * 32, 3 * 32);
-			BWAPI::Unitset affected = BWAPI::Broodwar->getUnitsInRectangle(place - offset, place + offset);
-			for (BWAPI::Unit u : affected)
-			{
-				if (u->getPlayer() == BWAPI::Broodwar->self())
-				{
-					score += swarmScore(u);
-				}
-				else if (u->getPlayer() == BWAPI::Broodwar->enemy())
-				{
-					score -= swarmScore(u);
-					if (u->getType().isBuilding() && !u->getType().isAddon())
-					{
-						hasEnemyBuilding = true;
-						score += 2;		// enemy buildings under swarm are targets
-					}
-					if (u->getType().groundWeapon() != BWAPI::WeaponTypes::None &&
-						u->getType().groundWeapon().maxRange() > 32)
-					{
-						hasRangedEnemy = true;
-					}
-				}
-			}
+			const int score = int(_swarmScores.Sum(tileX - 3, tileY - 3, tileX + 3, tileY + 3));
+			const bool hasEnemyBuilding = _enemyBuildings.Sum(tileX - 3, tileY - 3, tileX + 3, tileY + 3) > 0.0;
+			const bool hasRangedEnemy = _rangedEnemies.Sum(tileX - 3, tileY - 3, tileX + 3, tileY + 3) > 0.0;
 			if (hasEnemyBuilding && hasRangedEnemy && score > bestScore)
 			{
 				bestScore = score;
-				bestPlace = place;
+				bestPlace = BWAPI::Position(BWAPI::TilePosition(tileX, tileY));
 			}
 		}
 	}
@@ -250,32 +268,44 @@ bool MicroDefilers::maybePlague(BWAPI::Unit defiler, bool aboutToDie)
 	}
 
 	// Plague has range 9 and affects a box of size 4x4.
+	// Score the area once, each unit in the tile at its center. Then each box is a few lookups.
+	// Every candidate box is tiles [x-2,x+2) x [y-2,y+2).
+	const BWAPI::TilePosition here = defiler->getTilePosition();
+	const int minX = std::max(2, here.x - limit);
+	const int maxX = std::min(BWAPI::Broodwar->mapWidth() - 3, here.x + limit);
+	const int minY = std::max(2, here.y - limit);
+	const int maxY = std::min(BWAPI::Broodwar->mapHeight() - 3, here.y + limit);
+	_plagueScores.Reset(minX - 2, minY - 2, maxX - minX + 4, maxY - minY + 4);
+
+	const BWAPI::Unitset nearby = BWAPI::Broodwar->getUnitsInRectangle(
+		BWAPI::Position(BWAPI::TilePosition(minX - 2, minY - 2)),
+		BWAPI::Position(BWAPI::TilePosition(maxX + 2, maxY + 2)));
+	for (BWAPI::Unit u : nearby)
+	{
+		const BWAPI::TilePosition tile(u->getPosition());
+		if (u->getPlayer() == BWAPI::Broodwar->self())
+		{
+			_plagueScores.Add(tile.x, tile.y, -plagueScore(u));
+		}
+		else if (u->getPlayer() == BWAPI::Broodwar->enemy())
+		{
+			_plagueScores.Add(tile.x, tile.y, plagueScore(u));
+		}
+	}
+	_plagueScores.Build();
+
 	// Look for the box with the best effect.
 	double bestScore = 0.0;
 	BWAPI::Position bestPlace;
-	for (int tileX = std::max(2, defiler->getTilePosition().x-limit); tileX <= std::min(BWAPI::Broodwar->mapWidth()-3, defiler->getTilePosition().x+limit); ++tileX)
+	for (int tileX = minX; tileX <= maxX; ++tileX)
 	{
-		for (int tileY = std::max(2, defiler->getTilePosition().y - limit); tileY <= std::min(BWAPI::Broodwar->mapHeight()-3, defiler->getTilePosition().y+limit); ++tileY)
+		for (int tileY = minY; tileY <= maxY; ++tileY)
 		{
-			double score = 0.0;
-			BWAPI::Position place(BWAPI::TilePosition(tileX, tileY));
-			const BWAPI::Position offset(2 * 32, 2 * 32);
-			BWAPI::Unitset affected = BWAPI::Broodwar->getUnitsInRectangle(place - offset, place + offset);
-			for (BWAPI::Unit u : affected)
-			{
-				if (u->getPlayer() == BWAPI::Broodwar->self())
-				{
-					score -= plagueScore(u);
-				}
-				else if (u->getPlayer() == BWAPI::Broodwar->enemy())
-				{
-					score += plagueScore(u);
-				}
-			}
+			const double score = _plagueScores.Sum(tileX - 2, tileY - 2, tileX + 2, tileY + 2);
 			if (score > bestScore)
 			{
 				bestScore = score;
-				bestPlace = place;
+				bestPlace = BWAPI::Position(BWAPI::TilePosition(tileX, tileY));
 			}
 		}
 	}
@@ -1,6 +1,7 @@
 #pragma once;
 
 #include "MicroManager.h"
+#include "SummedAreaGrid.h"
 
 namespace KoalaRunBot
 {
@@ -9,6 +10,12 @@ class MicroDefilers : public MicroManager
 	// NOTE
 	// This micro manager controls all defilers plus any units assigned as defiler food.
 
+	// Scratch space for scoring the boxes where we might cast.
+	SummedAreaGrid _swarmScores;
+	SummedAreaGrid _enemyBuildings;
+	SummedAreaGrid _rangedEnemies;
+	SummedAreaGrid _plagueScores;
+
 	bool maybeConsume(BWAPI::Unit defiler, BWAPI::Unitset & food);
 
 	bool swarmOrPlague(BWAPI::Unit defiler, BWAPI::TechType techType, BWAPI::Position target) const;
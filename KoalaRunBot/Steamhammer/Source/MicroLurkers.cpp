@@ -28,10 +28,15 @@ void MicroLurkers::executeMicro(const BWAPI::Unitset & targets, const UnitCluste
 				u->getPosition().isValid();
 		});
 	
+	std::map<BWAPI::Unit, BWAPI::Unit> targetOf;
+	the.target_assigner_.Assign(lurkers, LurkerTargets,
+		[this](BWAPI::Unit lurker, BWAPI::Unit target) { return getScore(lurker, target); },
+		targetOf);
+
 	for (const auto lurker : lurkers)
 	{
 		const bool inOrderRange = lurker->getDistance(order.getPosition()) <= 3 * 32;
-		BWAPI::Unit target = getTarget(lurker, LurkerTargets);
+		BWAPI::Unit target = targetOf[lurker];
 
 		if (target)
 		{
@@ -150,53 +155,28 @@ void MicroLurkers::executeMicro(const BWAPI::Unitset & targets, const UnitCluste
 	}
 }
 
-// Return a target in range if any exists.
+// Targets in range come first, then higher priority, then closer.
 // Only ground targets are passed in.
-BWAPI::Unit MicroLurkers::getTarget(BWAPI::Unit lurker, const BWAPI::Unitset & targets)
+int MicroLurkers::getScore(BWAPI::Unit lurker, BWAPI::Unit target)
 {
-	if (targets.empty())
-	{
-		return nullptr;
-	}
-
 	const int lurkerRange = BWAPI::UnitTypes::Zerg_Lurker.groundWeapon().maxRange();
 
-	BWAPI::Unitset targetsInRange;
-	for (const auto target : targets)
-	{
-		if (lurker->getDistance(target) <= lurkerRange)
-		{
-			targetsInRange.insert(target);
-		}
-	}
-
-	// If any targets are in lurker range, then always return one of the targets in range.
-	const BWAPI::Unitset & newTargets = targetsInRange.empty() ? targets : targetsInRange;
-
-	int highPriority = 0;
-	int closestDist = 99999;
-	BWAPI::Unit bestTarget = nullptr;
+	const int distance = lurker->getDistance(target);
 
-	for (const auto target : newTargets)
-	{
-		int distance = lurker->getDistance(target);
-		int priority = getAttackPriority(target);
-
-		// BWAPI::Broodwar->drawTextMap(target->getPosition() + BWAPI::Position(20, -10), "%c%d", yellow, priority);
+	return (distance <= lurkerRange ? 10000000 : 0) + 100000 * getAttackPriority(target) - distance;
+}
 
-		if ((priority > highPriority) || (priority == highPriority && distance < closestDist))
+int MicroLurkers::getAttackPriority(BWAPI::Unit target) const
+{
+	return priorityMemo.Get(BWAPI::UnitTypes::Zerg_Lurker, target, false,
+		[this](BWAPI::UnitType lurkerType, BWAPI::Unit target, bool)
 		{
-			closestDist = distance;
-			highPriority = priority;
-			bestTarget = target;
-		}
-	}
-
-	return bestTarget;
+			return getTypeAttackPriority(target);
+		});
 }
 
 //  Only ground units are passed in as potential targets.
-int MicroLurkers::getAttackPriority(BWAPI::Unit target) const
+int MicroLurkers::getTypeAttackPriority(BWAPI::Unit target) const
 {
 	BWAPI::UnitType targetType = target->getType();
 
@@ -226,7 +206,7 @@ int MicroLurkers::getAttackPriority(BWAPI::Unit target) const
 		return 10;
 	}
 	// Something that can attack us or aid in combat
-	if (UnitUtil::CanAttackGround(target) && !target->getType().isWorker())
+	if (the.attack_table_.CanAttack(targetType, false) && !targetType.isWorker())
 	{
 		return 9;
 	}
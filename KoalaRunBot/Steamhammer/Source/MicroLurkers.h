@@ -13,7 +13,8 @@ namespace KoalaRunBot
 		MicroLurkers();
 
 		void executeMicro(const BWAPI::Unitset & targets, const UnitCluster & cluster);
-		BWAPI::Unit getTarget(BWAPI::Unit lurker, const BWAPI::Unitset & targets);
+		int getScore(BWAPI::Unit lurker, BWAPI::Unit target);
 		int getAttackPriority(BWAPI::Unit target) const;
+		int getTypeAttackPriority(BWAPI::Unit target) const;
 	};
 }
\ No newline at end of file
@@ -269,17 +269,10 @@ bool MicroManager::checkPositionWalkable(BWAPI::Position pos)
 	return true;
 }
 
+// getDistance() measured from the unit's edge. Allow for the unit's size.
 bool MicroManager::unitNearChokepoint(BWAPI::Unit unit) const
 {
-	for (BWTA::Chokepoint * choke : BWTA::getChokepoints())
-	{
-		if (unit->getDistance(choke->getCenter()) < 80)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	return MapTools::Instance().getChokeDistance(unit->getPosition()) < 80 + unit->getType().width() / 2;
 }
 
 // Dodge any incoming spider mine.
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AttackPriorityMemo.h"
 #include "SquadOrder.h"
 
 namespace KoalaRunBot
@@ -17,6 +18,9 @@ protected:
 
 	SquadOrder			order;
 
+	// Attack priorities computed this frame, by attacker type and target.
+	mutable AttackPriorityMemo	priorityMemo;
+
 	virtual void        executeMicro(const BWAPI::Unitset & targets, const UnitCluster & cluster) = 0;
 	void				destroyNeutralTargets(const BWAPI::Unitset & targets);
 	bool                checkPositionWalkable(BWAPI::Position pos);
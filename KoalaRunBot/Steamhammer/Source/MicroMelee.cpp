@@ -41,6 +41,9 @@ void MicroMelee::assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::U
 		}
 	}
 
+	// Units that are free to fight this frame.
+	BWAPI::Unitset fighters;
+
 	for (const auto meleeUnit : meleeUnits)
 	{
 		if (meleeUnit->isBurrowed())
@@ -83,29 +86,45 @@ void MicroMelee::assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::U
             }
 			else
 			{
-				BWAPI::Unit target = getTarget(meleeUnit, meleeUnitTargets);
-				if (target)
-				{
-					// CatchAndAttackUnit() does not work well in big melee battles.
-					// We still use it for worker targets, to catch the enemy scout.
-					if (true || target->getType().isWorker())	// TODO DISABLED - always use catch and attack
-					{
-						the.micro_.CatchAndAttackUnit(meleeUnit, target);
-					}
-					else
-					{
-						the.micro_.AttackUnit(meleeUnit, target);
-					}
-				}
-				else if (meleeUnit->getDistance(order.getPosition()) > 96)
-				{
-					// There are no targets. Move to the order position if not already close.
-					the.micro_.Move(meleeUnit, order.getPosition());
-				}
+				fighters.insert(meleeUnit);
 			}
 		}
+	}
+
+	std::map<BWAPI::Unit, BWAPI::Unit> targetOf;
+	if (!fighters.empty())
+	{
+		the.target_assigner_.Assign(fighters, meleeUnitTargets,
+			[this](BWAPI::Unit meleeUnit, BWAPI::Unit target) { return getScore(meleeUnit, target); },
+			targetOf);
+	}
+
+	for (const auto meleeUnit : fighters)
+	{
+		BWAPI::Unit target = targetOf[meleeUnit];
+		if (target)
+		{
+			// CatchAndAttackUnit() does not work well in big melee battles.
+			// We still use it for worker targets, to catch the enemy scout.
+			if (true || target->getType().isWorker())	// TODO DISABLED - always use catch and attack
+			{
+				the.micro_.CatchAndAttackUnit(meleeUnit, target);
+			}
+			else
+			{
+				the.micro_.AttackUnit(meleeUnit, target);
+			}
+		}
+		else if (meleeUnit->getDistance(order.getPosition()) > 96)
+		{
+			// There are no targets. Move to the order position if not already close.
+			the.micro_.Move(meleeUnit, order.getPosition());
+		}
+	}
 
-		if (Config::Debug::DrawUnitTargetInfo)
+	if (Config::Debug::DrawUnitTargetInfo)
+	{
+		for (const auto meleeUnit : meleeUnits)
 		{
 			BWAPI::Broodwar->drawLineMap(meleeUnit->getPosition(), meleeUnit->getTargetPosition(),
 				Config::Debug::ColorLineTarget);
@@ -113,118 +132,120 @@ void MicroMelee::assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::U
 	}
 }
 
-// Choose a target from the set.
-BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset & targets)
+// The score of attacking the target, or kNoTarget to skip it.
+int MicroMelee::getScore(BWAPI::Unit meleeUnit, BWAPI::Unit target)
 {
-	int bestScore = -999999;
-	BWAPI::Unit bestTarget = nullptr;
+	const int priority = getAttackPriority(meleeUnit, target);		// 0..12
+	const int range = meleeUnit->getDistance(target);				// 0..map size in pixels
+	const int closerToGoal =										// positive if target is closer than us to the goal
+		meleeUnit->getDistance(order.getPosition()) - target->getDistance(order.getPosition());
 
-	for (const auto target : targets)
+	// Skip targets that are too far away to worry about.
+	if (range >= 13 * 32)
 	{
-		const int priority = getAttackPriority(meleeUnit, target);		// 0..12
-		const int range = meleeUnit->getDistance(target);				// 0..map size in pixels
-		const int closerToGoal =										// positive if target is closer than us to the goal
-			meleeUnit->getDistance(order.getPosition()) - target->getDistance(order.getPosition());
-
-		// Skip targets that are too far away to worry about.
-		if (range >= 13 * 32)
-		{
-			continue;
-		}
+		return TargetAssigner::kNoTarget;
+	}
 
-		// TODO disabled - seems to be wrong, skips targets it should not
-		// Don't chase targets that we can't catch.
-		//if (!CanCatchUnit(meleeUnit, target))
-		//{
-		//	continue;
-		//}
+	// TODO disabled - seems to be wrong, skips targets it should not
+	// Don't chase targets that we can't catch.
+	//if (!CanCatchUnit(meleeUnit, target))
+	//{
+	//	return TargetAssigner::kNoTarget;
+	//}
 
-		// Let's say that 1 priority step is worth 64 pixels (2 tiles).
-		// We care about unit-target range and target-order position distance.
-		int score = 2 * 32 * priority - range;
+	// Let's say that 1 priority step is worth 64 pixels (2 tiles).
+	// We care about unit-target range and target-order position distance.
+	int score = 2 * 32 * priority - range;
 
-		// Adjust for special features.
+	// Adjust for special features.
 
-		// Prefer targets under dark swarm, on the expectation that then we'll be under it too.
-		// It doesn't matter whether the target is a building.
-		if (target->isUnderDarkSwarm())
+	// Prefer targets under dark swarm, on the expectation that then we'll be under it too.
+	// It doesn't matter whether the target is a building.
+	if (target->isUnderDarkSwarm())
+	{
+		if (meleeUnit->getType().isWorker())
 		{
-			if (meleeUnit->getType().isWorker())
-			{
-				// Workers can't hit under dark swarm. Skip this target.
-				continue;
-			}
-			score += 4 * 32;
+			// Workers can't hit under dark swarm. Skip this target.
+			return TargetAssigner::kNoTarget;
 		}
+		score += 4 * 32;
+	}
 
-		if (target->isUnderStorm())
-		{
-			score -= 6 * 32;
-		}
+	if (target->isUnderStorm())
+	{
+		score -= 6 * 32;
+	}
 
-		// A bonus for attacking enemies that are "in front".
-		// It helps reduce distractions from moving toward the goal, the order position.
-		if (closerToGoal > 0)
-		{
-			score += 2 * 32;
-		}
+	// A bonus for attacking enemies that are "in front".
+	// It helps reduce distractions from moving toward the goal, the order position.
+	if (closerToGoal > 0)
+	{
+		score += 2 * 32;
+	}
 
-		// This could adjust for relative speed and direction, so that we don't chase what we can't catch.
-		if (meleeUnit->isInWeaponRange(target))
+	// This could adjust for relative speed and direction, so that we don't chase what we can't catch.
+	if (meleeUnit->isInWeaponRange(target))
+	{
+		if (meleeUnit->getType() == BWAPI::UnitTypes::Zerg_Ultralisk)
 		{
-			if (meleeUnit->getType() == BWAPI::UnitTypes::Zerg_Ultralisk)
-			{
-				score += 12 * 32;   // because they're big and awkward
-			}
-			else
-			{
-				score += 4 * 32;
-			}
+			score += 12 * 32;   // because they're big and awkward
 		}
-		else if (!target->isMoving())
+		else
 		{
-			if (target->isSieged() ||
-				target->getOrder() == BWAPI::Orders::Sieging ||
-				target->getOrder() == BWAPI::Orders::Unsieging)
-			{
-				score += 48;
-			}
-			else
-			{
-				score += 32;
-			}
+			score += 4 * 32;
 		}
-		else if (target->isBraking())
+	}
+	else if (!target->isMoving())
+	{
+		if (target->isSieged() ||
+			target->getOrder() == BWAPI::Orders::Sieging ||
+			target->getOrder() == BWAPI::Orders::Unsieging)
 		{
-			score += 16;
+			score += 48;
 		}
-		else if (target->getPlayer()->topSpeed(target->getType()) >= meleeUnit->getPlayer()->topSpeed(meleeUnit->getType()))
-		{
-			score -= 2 * 32;
-		}
-
-		// Prefer targets that are already hurt.
-		if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() == 0)
+		else
 		{
 			score += 32;
 		}
-		else if (target->getHitPoints() < target->getType().maxHitPoints())
-		{
-			score += 24;
-		}
+	}
+	else if (target->isBraking())
+	{
+		score += 16;
+	}
+	else if (target->getPlayer()->topSpeed(target->getType()) >= meleeUnit->getPlayer()->topSpeed(meleeUnit->getType()))
+	{
+		score -= 2 * 32;
+	}
 
-		if (score > bestScore)
-		{
-			bestScore = score;
-			bestTarget = target;
-		}
+	// Prefer targets that are already hurt.
+	if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() == 0)
+	{
+		score += 32;
+	}
+	else if (target->getHitPoints() < target->getType().maxHitPoints())
+	{
+		score += 24;
 	}
 
-	return bestTarget;
+	return score;
 }
 
 // get the attack priority of a type
 int MicroMelee::getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit target) const
+{
+	// Whether the target is far enough outside its range, if it can attack us.
+	const int enemyRange = the.attack_table_.Range(target->getPlayer(), target->getType(), attacker->isFlying());
+	const bool farFromThreat = enemyRange && attacker->getDistance(target) > 32 + enemyRange;
+
+	return priorityMemo.Get(attacker->getType(), target, farFromThreat,
+		[this](BWAPI::UnitType attackerType, BWAPI::Unit target, bool farFromThreat)
+		{
+			return getTypeAttackPriority(attackerType, target, farFromThreat);
+		});
+}
+
+// The part of the attack priority that depends only on the attacker's type.
+int MicroMelee::getTypeAttackPriority(BWAPI::UnitType attackerType, BWAPI::Unit target, bool farFromThreat) const
 {
 	BWAPI::UnitType targetType = target->getType();
 
@@ -237,7 +258,7 @@ int MicroMelee::getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit target) cons
 	}
 
 	// Exceptions for dark templar.
-	if (attacker->getType() == BWAPI::UnitTypes::Protoss_Dark_Templar)
+	if (attackerType == BWAPI::UnitTypes::Protoss_Dark_Templar)
 	{
 		if (targetType == BWAPI::UnitTypes::Terran_Vulture_Spider_Mine)
 		{
@@ -259,10 +280,7 @@ int MicroMelee::getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit target) cons
 	}
 
 	// Short circuit: Enemy unit which is far enough outside its range is lower priority than a worker.
-	int enemyRange = UnitUtil::GetAttackRange(target, attacker);
-	if (enemyRange &&
-		!targetType.isWorker() &&
-		attacker->getDistance(target) > 32 + enemyRange)
+	if (farFromThreat && !targetType.isWorker())
 	{
 		return 8;
 	}
@@ -275,7 +293,7 @@ int MicroMelee::getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit target) cons
 	if (targetType == BWAPI::UnitTypes::Terran_Medic ||
 		targetType == BWAPI::UnitTypes::Protoss_High_Templar ||
 		targetType == BWAPI::UnitTypes::Zerg_Defiler ||
-		UnitUtil::CanAttackGround(target) && !targetType.isWorker())  // includes cannons and sunkens
+		the.attack_table_.CanAttack(targetType, false) && !targetType.isWorker())  // includes cannons and sunkens
 	{
 		return 12;
 	}
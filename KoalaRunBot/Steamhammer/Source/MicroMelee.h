@@ -15,7 +15,8 @@ public:
 	void assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::Unitset & targets);
 
 	int getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit unit) const;
-	BWAPI::Unit getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset & targets);
+	int getTypeAttackPriority(BWAPI::UnitType attackerType, BWAPI::Unit target, bool farFromThreat) const;
+	int getScore(BWAPI::Unit meleeUnit, BWAPI::Unit target);
 	bool meleeUnitShouldRetreat(BWAPI::Unit meleeUnit, const BWAPI::Unitset & targets);
 };
 }
\ No newline at end of file
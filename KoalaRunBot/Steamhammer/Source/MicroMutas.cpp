@@ -10,6 +10,8 @@ using namespace KoalaRunBot;
 const int groupingRange = 4 * 32;       // mutas this close are "not stragglers" and work together
 //const int destraggleRange = 8 * 32;   // if reinforcements are this close, join up first
 const int irradiateRange = 6 * 32;      // with safety factor
+const int heavyAirThreat = 60;          // volley damage on a tile that kills a muta in 2 volleys
+const int airThreatScale = 8;           // pixels of detour worth 1 point of volley damage
 
 int MicroMutas::hitsToKill(BWAPI::Unit target) const
 {
@@ -58,6 +60,13 @@ BWAPI::Position MicroMutas::getFleePosition(BWAPI::Unit muta, const BWAPI::Posit
 					score += 24;    // further bonus if it is an SCV or drone
 				}
 			}
+			// Avoid defended targets. The threat is volley damage, not pixels, so scale it.
+			const int threat = the.threat_map_.Air(target->getTilePosition());
+			if (threat >= heavyAirThreat)
+			{
+				continue;
+			}
+			score -= airThreatScale * threat;
 			if (score > bestScore)
 			{
 				bestTarget = target;
@@ -93,6 +102,12 @@ BWAPI::Position MicroMutas::getFleePosition(BWAPI::Unit muta, const BWAPI::Posit
 		destination.y = center.y + 2 * irradiateRange;
 	}
 
+	// Of the places near there, go to the one least covered by anti-air.
+	const BWAPI::TilePosition tile(
+		std::max(0, std::min(BWAPI::Broodwar->mapWidth() - 1, destination.x / 32)),
+		std::max(0, std::min(BWAPI::Broodwar->mapHeight() - 1, destination.y / 32)));
+	destination = BWAPI::Position(the.threat_map_.SafestTile(tile, 3, true)) + BWAPI::Position(16, 16);
+
 	BWAPI::Broodwar->printf("irradiated dest -> %d,%d", destination.x, destination.y);
 
 	return destination;
@@ -321,6 +336,15 @@ void MicroMutas::scoreTargets(const BWAPI::Position & center, const BWAPI::Units
 }
 
 int MicroMutas::getAttackPriority(BWAPI::Unit target)
+{
+	return priorityMemo.Get(BWAPI::UnitTypes::Zerg_Mutalisk, target, false,
+		[this](BWAPI::UnitType mutaType, BWAPI::Unit target, bool)
+		{
+			return getTypeAttackPriority(target);
+		});
+}
+
+int MicroMutas::getTypeAttackPriority(BWAPI::Unit target)
 {
 	const BWAPI::UnitType targetType = target->getType();
 
@@ -27,6 +27,7 @@ private:
 	void scoreTargets(const BWAPI::Position & center, const BWAPI::Unitset & targets, std::vector<unitScoreT> & bestTargets);
 	//BWAPI::Unit getTarget(const BWAPI::Position & center, const BWAPI::Unitset & targets);
 	int getAttackPriority(BWAPI::Unit target);
+	int getTypeAttackPriority(BWAPI::Unit target);
 
 	void attackAssignedTargets(const BWAPI::Position & center);
 public:
@@ -65,6 +65,9 @@ void MicroRanged::assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI:
 		}
 	}
 	
+	// Units that are free to fight this frame.
+	BWAPI::Unitset fighters;
+
 	for (const auto rangedUnit : rangedUnits)
 	{
 		if (buildScarabOrInterceptor(rangedUnit))
@@ -115,185 +118,198 @@ void MicroRanged::assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI:
 		}
 
 		if (order.isCombatOrder())
-        {
-			// If a target is found,
-			BWAPI::Unit target = getTarget(rangedUnit, rangedUnitTargets);
-			if (target)
-			{
-				if (Config::Debug::DrawUnitTargetInfo)
-				{
-					BWAPI::Broodwar->drawLineMap(rangedUnit->getPosition(), rangedUnit->getTargetPosition(), BWAPI::Colors::Purple);
-				}
-
-				bool kite = rangedUnit->isFlying() ? enemyHasAntiAir : enemyHasAntiGround;
-				if (Config::Micro::KiteWithRangedUnits && kite)
-				{
-					the.micro_.KiteTarget(rangedUnit, target);
-				}
-				else
-				{
-					the.micro_.CatchAndAttackUnit(rangedUnit, target);
-				}
-			}
-			else
-			{
-				// No target found. If we're not near the order position, go there.
-				if (rangedUnit->getDistance(order.getPosition()) > 100)
-				{
-					the.micro_.AttackMove(rangedUnit, order.getPosition());
-				}
-			}
+		{
+			fighters.insert(rangedUnit);
 		}
 	}
-}
-
-// This can return null if no target is worth attacking.
-BWAPI::Unit MicroRanged::getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets)
-{
-	int bestScore = -999999;
-	BWAPI::Unit bestTarget = nullptr;
-	int bestPriority = -1;   // TODO debug only
 
-	for (const auto target : targets)
+	if (fighters.empty())
 	{
-		// Skip targets under dark swarm that we can't hit.
-		if (target->isUnderDarkSwarm() && !target->getType().isBuilding() && !goodUnderDarkSwarm(rangedUnit->getType()))
-		{
-			continue;
-		}
-
-		const int priority = getAttackPriority(rangedUnit, target);		// 0..12
-		const int range = rangedUnit->getDistance(target);				// 0..map diameter in pixels
-		const int closerToGoal =										// positive if target is closer than us to the goal
-			rangedUnit->getDistance(order.getPosition()) - target->getDistance(order.getPosition());
-		
-		// Skip targets that are too far away to worry about--outside tank range.
-		if (range >= 13 * 32)
-		{
-			continue;
-		}
-
-		// TODO disabled - seems to be wrong, skips targets it should not
-		// Don't chase targets that we can't catch.
-		//if (!CanCatchUnit(meleeUnit, target))
-		//{
-		//	continue;
-		//}
-
-		// Let's say that 1 priority step is worth 160 pixels (5 tiles).
-		// We care about unit-target range and target-order position distance.
-		int score = 5 * 32 * priority - range;
-
-		// Adjust for special features.
-		// A bonus for attacking enemies that are "in front".
-		// It helps reduce distractions from moving toward the goal, the order position.
-		if (closerToGoal > 0)
-		{
-			score += 2 * 32;
-		}
+		return;
+	}
 
-		const bool isThreat = UnitUtil::CanAttack(target, rangedUnit);   // may include workers as threats
-		const bool canShootBack = isThreat && range <= 32 + UnitUtil::GetAttackRange(target, rangedUnit);
+	std::map<BWAPI::Unit, BWAPI::Unit> targetOf;
+	the.target_assigner_.Assign(fighters, rangedUnitTargets,
+		[this](BWAPI::Unit rangedUnit, BWAPI::Unit target) { return getScore(rangedUnit, target); },
+		targetOf);
 
-		if (isThreat)
+	for (const auto rangedUnit : fighters)
+	{
+		// If a target is found,
+		BWAPI::Unit target = targetOf[rangedUnit];
+		if (target)
 		{
-			if (canShootBack)
+			if (Config::Debug::DrawUnitTargetInfo)
 			{
-				score += 7 * 32;
+				BWAPI::Broodwar->drawLineMap(rangedUnit->getPosition(), rangedUnit->getTargetPosition(), BWAPI::Colors::Purple);
 			}
-			else if (rangedUnit->isInWeaponRange(target))
+
+			bool kite = rangedUnit->isFlying() ? enemyHasAntiAir : enemyHasAntiGround;
+			if (Config::Micro::KiteWithRangedUnits && kite)
 			{
-				score += 5 * 32;
+				the.micro_.KiteTarget(rangedUnit, target);
 			}
 			else
 			{
-				score += 5 * 32;
+				the.micro_.CatchAndAttackUnit(rangedUnit, target);
 			}
 		}
-		else if (!target->isMoving())
+		else
 		{
-			if (target->isSieged() ||
-				target->getOrder() == BWAPI::Orders::Sieging ||
-				target->getOrder() == BWAPI::Orders::Unsieging ||
-				target->isBurrowed())
+			// No target found. If we're not near the order position, go there.
+			if (rangedUnit->getDistance(order.getPosition()) > 100)
 			{
-				score += 48;
-			}
-			else
-			{
-				score += 24;
+				the.micro_.AttackMove(rangedUnit, order.getPosition());
 			}
 		}
-		else if (target->isBraking())
+	}
+}
+
+// The score of attacking the target, or kNoTarget if it is not worth attacking.
+int MicroRanged::getScore(BWAPI::Unit rangedUnit, BWAPI::Unit target)
+{
+	// Skip targets under dark swarm that we can't hit.
+	if (target->isUnderDarkSwarm() && !target->getType().isBuilding() && !goodUnderDarkSwarm(rangedUnit->getType()))
+	{
+		return TargetAssigner::kNoTarget;
+	}
+
+	const int priority = getAttackPriority(rangedUnit, target);		// 0..12
+	const int range = rangedUnit->getDistance(target);				// 0..map diameter in pixels
+	const int closerToGoal =										// positive if target is closer than us to the goal
+		rangedUnit->getDistance(order.getPosition()) - target->getDistance(order.getPosition());
+	
+	// Skip targets that are too far away to worry about--outside tank range.
+	if (range >= 13 * 32)
+	{
+		return TargetAssigner::kNoTarget;
+	}
+
+	// TODO disabled - seems to be wrong, skips targets it should not
+	// Don't chase targets that we can't catch.
+	//if (!CanCatchUnit(meleeUnit, target))
+	//{
+	//	return TargetAssigner::kNoTarget;
+	//}
+
+	// Let's say that 1 priority step is worth 160 pixels (5 tiles).
+	// We care about unit-target range and target-order position distance.
+	int score = 5 * 32 * priority - range;
+
+	// Adjust for special features.
+	// A bonus for attacking enemies that are "in front".
+	// It helps reduce distractions from moving toward the goal, the order position.
+	if (closerToGoal > 0)
+	{
+		score += 2 * 32;
+	}
+
+	const bool isThreat = the.attack_table_.CanAttack(target->getType(), rangedUnit->isFlying());   // may include workers as threats
+	const bool canShootBack = isThreat && range <= 32 + the.attack_table_.Range(target->getPlayer(), target->getType(), rangedUnit->isFlying());
+
+	if (isThreat)
+	{
+		if (canShootBack)
 		{
-			score += 16;
+			score += 7 * 32;
 		}
-		else if (target->getPlayer()->topSpeed(target->getType()) >= rangedUnit->getPlayer()->topSpeed(rangedUnit->getType()))
+		else if (rangedUnit->isInWeaponRange(target))
 		{
-			score -= 4 * 32;
+			score += 5 * 32;
 		}
-		
-		// Prefer targets that are already hurt.
-		if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() <= 5)
+		else
 		{
-			score += 32;
+			score += 5 * 32;
+		}
+	}
+	else if (!target->isMoving())
+	{
+		if (target->isSieged() ||
+			target->getOrder() == BWAPI::Orders::Sieging ||
+			target->getOrder() == BWAPI::Orders::Unsieging ||
+			target->isBurrowed())
+		{
+			score += 48;
 		}
-		if (target->getHitPoints() < target->getType().maxHitPoints())
+		else
 		{
 			score += 24;
 		}
+	}
+	else if (target->isBraking())
+	{
+		score += 16;
+	}
+	else if (target->getPlayer()->topSpeed(target->getType()) >= rangedUnit->getPlayer()->topSpeed(rangedUnit->getType()))
+	{
+		score -= 4 * 32;
+	}
+	
+	// Prefer targets that are already hurt.
+	if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() <= 5)
+	{
+		score += 32;
+	}
+	if (target->getHitPoints() < target->getType().maxHitPoints())
+	{
+		score += 24;
+	}
 
-		// Prefer to hit air units that have acid spores on them from devourers.
-		if (target->getAcidSporeCount() > 0)
+	// Prefer to hit air units that have acid spores on them from devourers.
+	if (target->getAcidSporeCount() > 0)
+	{
+		// Especially if we're a mutalisk with a bounce attack.
+		if (rangedUnit->getType() == BWAPI::UnitTypes::Zerg_Mutalisk)
 		{
-			// Especially if we're a mutalisk with a bounce attack.
-			if (rangedUnit->getType() == BWAPI::UnitTypes::Zerg_Mutalisk)
-			{
-				score += 16 * target->getAcidSporeCount();
-			}
-			else
-			{
-				score += 8 * target->getAcidSporeCount();
-			}
+			score += 16 * target->getAcidSporeCount();
 		}
+		else
+		{
+			score += 8 * target->getAcidSporeCount();
+		}
+	}
 
-		// Take the damage type into account.
-		BWAPI::DamageType damage = UnitUtil::GetWeapon(rangedUnit, target).damageType();
-		if (damage == BWAPI::DamageTypes::Explosive)
+	// Take the damage type into account.
+	BWAPI::DamageType damage = UnitUtil::GetWeapon(rangedUnit, target).damageType();
+	if (damage == BWAPI::DamageTypes::Explosive)
+	{
+		if (target->getType().size() == BWAPI::UnitSizeTypes::Large)
 		{
-			if (target->getType().size() == BWAPI::UnitSizeTypes::Large)
-			{
-				score += 32;
-			}
+			score += 32;
 		}
-		else if (damage == BWAPI::DamageTypes::Concussive)
+	}
+	else if (damage == BWAPI::DamageTypes::Concussive)
+	{
+		if (target->getType().size() == BWAPI::UnitSizeTypes::Small)
 		{
-			if (target->getType().size() == BWAPI::UnitSizeTypes::Small)
-			{
-				score += 32;
-			}
-			else if (target->getType().size() == BWAPI::UnitSizeTypes::Large)
-			{
-				score -= 32;
-			}
+			score += 32;
 		}
-
-		if (score > bestScore)
+		else if (target->getType().size() == BWAPI::UnitSizeTypes::Large)
 		{
-			bestScore = score;
-			bestTarget = target;
-
-			bestPriority = priority;
+			score -= 32;
 		}
 	}
 
-	return bestScore > 0 ? bestTarget : nullptr;
+	return score > 0 ? score : TargetAssigner::kNoTarget;
 }
 
 // get the attack priority of a target unit
-int MicroRanged::getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target) 
+int MicroRanged::getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target)
+{
+	// Whether the target is far enough outside its range, if it is a threat.
+	const bool farFromThreat =
+		rangedUnit->getDistance(target) > 48 + the.attack_table_.Range(target->getPlayer(), target->getType(), rangedUnit->isFlying());
+
+	return priorityMemo.Get(rangedUnit->getType(), target, farFromThreat,
+		[this](BWAPI::UnitType rangedType, BWAPI::Unit target, bool farFromThreat)
+		{
+			return getTypeAttackPriority(rangedType, target, farFromThreat);
+		});
+}
+
+// The part of the attack priority that depends only on the attacker's type.
+int MicroRanged::getTypeAttackPriority(BWAPI::UnitType rangedType, BWAPI::Unit target, bool farFromThreat)
 {
-	const BWAPI::UnitType rangedType = rangedUnit->getType();
 	const BWAPI::UnitType targetType = target->getType();
 
 	if (rangedType == BWAPI::UnitTypes::Zerg_Guardian && target->isFlying())
@@ -405,10 +421,10 @@ int MicroRanged::getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target)
 	}
 
 	// Threats can attack us. Exception: Workers are not threats.
-	if (UnitUtil::CanAttack(targetType, rangedType) && !targetType.isWorker())
+	if (the.attack_table_.CanAttack(targetType, rangedType.isFlyer()) && !targetType.isWorker())
 	{
 		// Enemy unit which is far enough outside its range is lower priority than a worker.
-		if (rangedUnit->getDistance(target) > 48 + UnitUtil::GetAttackRange(target, rangedUnit))
+		if (farFromThreat)
 		{
 			return 8;
 		}
@@ -430,7 +446,7 @@ int MicroRanged::getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target)
 	// Next are workers.
 	if (targetType.isWorker()) 
 	{
-        if (rangedUnit->getType() == BWAPI::UnitTypes::Terran_Vulture)
+        if (rangedType == BWAPI::UnitTypes::Terran_Vulture)
         {
             return 11;
         }
@@ -19,7 +19,8 @@ public:
 	void assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI::Unitset & targets);
 
 	int getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target);
-	BWAPI::Unit getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets);
+	int getTypeAttackPriority(BWAPI::UnitType rangedType, BWAPI::Unit target, bool farFromThreat);
+	int getScore(BWAPI::Unit rangedUnit, BWAPI::Unit target);
 
 	bool stayHomeUntilReady(const BWAPI::Unit u) const;
 };
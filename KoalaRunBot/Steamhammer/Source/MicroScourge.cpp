@@ -35,10 +35,16 @@ void MicroScourge::assignTargets(const BWAPI::Unitset & scourge, const BWAPI::Un
 			u->isFlying();
 	});
 
+	// Scourge die on impact, so the overkill bookkeeping matters most here.
+	std::map<BWAPI::Unit, BWAPI::Unit> targetOf;
+	the.target_assigner_.Assign(scourge, scourgeTargets,
+		[this](BWAPI::Unit scourgeUnit, BWAPI::Unit target) { return getScore(scourgeUnit, target); },
+		targetOf);
+
 	for (const auto scourgeUnit : scourge)
 	{
 		// If a target is found,
-		BWAPI::Unit target = getTarget(scourgeUnit, scourgeTargets);
+		BWAPI::Unit target = targetOf[scourgeUnit];
 		if (target)
 		{
 			if (Config::Debug::DrawUnitTargetInfo)
@@ -60,28 +66,16 @@ void MicroScourge::assignTargets(const BWAPI::Unitset & scourge, const BWAPI::Un
 	}
 }
 
-BWAPI::Unit MicroScourge::getTarget(BWAPI::Unit scourge, const BWAPI::Unitset & targets)
+int MicroScourge::getScore(BWAPI::Unit scourge, BWAPI::Unit target)
 {
-	int bestScore = -999999;
-	BWAPI::Unit bestTarget = nullptr;
-
-	for (const auto target : targets)
-	{
-		const int priority = getAttackPriority(target->getType());	// 0..12
-		const int range = scourge->getDistance(target);				// 0..map diameter in pixels
-
-		// Let's say that 1 priority step is worth 160 pixels (5 tiles).
-		// We care about unit-target range and target-order position distance.
-		int score = 5 * 32 * priority - range;
+	const int priority = getAttackPriority(target->getType());	// 0..12
+	const int range = scourge->getDistance(target);				// 0..map diameter in pixels
 
-		if (score > bestScore)
-		{
-			bestScore = score;
-			bestTarget = target;
-		}
-	}
+	// Let's say that 1 priority step is worth 160 pixels (5 tiles).
+	// We care about unit-target range and target-order position distance.
+	int score = 5 * 32 * priority - range;
 
-	return bestTarget;
+	return score;
 }
 
 int MicroScourge::getAttackPriority(BWAPI::UnitType targetType)
@@ -13,6 +13,6 @@ namespace KoalaRunBot
 		void assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI::Unitset & targets);
 
 		static int getAttackPriority(BWAPI::UnitType targetType);
-		BWAPI::Unit getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets);
+		int getScore(BWAPI::Unit rangedUnit, BWAPI::Unit target);
 	};
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #include "MicroTanks.h"
 
-#include "BWTA.h"
+#include "MapTools.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -25,23 +25,23 @@ void MicroTanks::executeMicro(const BWAPI::Unitset & targets, const UnitCluster
     
     const int siegeTankRange = BWAPI::UnitTypes::Terran_Siege_Tank_Siege_Mode.groundWeapon().maxRange() - 8;
 
+	std::map<BWAPI::Unit, BWAPI::Unit> targetOf;
+	if (order.isCombatOrder() && !tankTargets.empty())
+	{
+		the.target_assigner_.Assign(tanks, tankTargets,
+			[this](BWAPI::Unit tank, BWAPI::Unit target) { return getScore(tank, target); },
+			targetOf);
+	}
+
 	for (const auto tank : tanks)
 	{
-        bool tankNearChokepoint = false; 
-        for (auto & choke : BWTA::getChokepoints())
-        {
-            if (choke->getCenter().getDistance(tank->getPosition()) < 64)
-            {
-                tankNearChokepoint = true;
-                break;
-            }
-        }
+		const bool tankNearChokepoint = MapTools::Instance().getChokeDistance(tank->getPosition()) < 64;
 
 		if (order.isCombatOrder())
 		{
 			if (!tankTargets.empty())
 			{
-				BWAPI::Unit target = getTarget(tank, tankTargets);
+				BWAPI::Unit target = targetOf[tank];
 
 				if (target && Config::Debug::DrawUnitTargetInfo)
 				{
@@ -124,44 +124,29 @@ void MicroTanks::executeMicro(const BWAPI::Unitset & targets, const UnitCluster
 	}
 }
 
-BWAPI::Unit MicroTanks::getTarget(BWAPI::Unit tank, const BWAPI::Unitset & targets)
+// Targets in siege range come first, then higher priority, then closer.
+int MicroTanks::getScore(BWAPI::Unit tank, BWAPI::Unit target)
 {
-    int highPriority = 0;
-	int closestDist = 99999;
-	BWAPI::Unit closestTarget = nullptr;
-
     const int siegeTankRange = BWAPI::UnitTypes::Terran_Siege_Tank_Siege_Mode.groundWeapon().maxRange() - 8;
-    BWAPI::Unitset targetsInSiegeRange;
-    for (const auto target : targets)
-    {
-        if (target->getDistance(tank) < siegeTankRange && !target->isFlying())
-        {
-            targetsInSiegeRange.insert(target);
-        }
-    }
-
-    const BWAPI::Unitset & newTargets = targetsInSiegeRange.empty() ? targets : targetsInSiegeRange;
 
-    // check first for units that are in range of our attack that can cause damage
-    // choose the highest priority one from them at the lowest health
-    for (const auto target : newTargets)
-    {
-        int distance = tank->getDistance(target);
-        int priority = getAttackPriority(tank, target);
+    const int distance = tank->getDistance(target);
+    const bool inSiegeRange = distance < siegeTankRange && !target->isFlying();
 
-		if (!closestTarget || (priority > highPriority) || (priority == highPriority && distance < closestDist))
-		{
-			closestDist = distance;
-			highPriority = priority;
-			closestTarget = target;
-		}       
-    }
-
-    return closestTarget;
+    return (inSiegeRange ? 10000000 : 0) + 100000 * getAttackPriority(tank, target) - distance;
 }
 
 // Only targets that the tank can potentially attack go into the target set.
 int MicroTanks::getAttackPriority(BWAPI::Unit tank, BWAPI::Unit target)
+{
+	return priorityMemo.Get(tank->getType(), target, tank->isSieged(),
+		[this](BWAPI::UnitType tankType, BWAPI::Unit target, bool sieged)
+		{
+			return getTypeAttackPriority(target, sieged);
+		});
+}
+
+// The part of the attack priority that depends only on the tank's type, and whether it is sieged.
+int MicroTanks::getTypeAttackPriority(BWAPI::Unit target, bool sieged)
 {
 	BWAPI::UnitType targetType = target->getType();
 
@@ -171,7 +156,7 @@ int MicroTanks::getAttackPriority(BWAPI::Unit tank, BWAPI::Unit target)
 	}
 
 	// If it's under dark swarm, we can't hurt it unless we're sieged.
-	if (target->isUnderDarkSwarm() && !tank->isSieged())
+	if (target->isUnderDarkSwarm() && !sieged)
 	{
 		return 0;
 	}
@@ -196,7 +181,7 @@ int MicroTanks::getAttackPriority(BWAPI::Unit tank, BWAPI::Unit target)
 		return 12;
 	}
 
-	bool isThreat = UnitUtil::TypeCanAttackGround(targetType);    // includes bunkers
+	bool isThreat = the.attack_table_.CanAttack(targetType, false);    // includes bunkers
 	if (target->getType().isWorker())
 	{
 		isThreat = false;
@@ -14,6 +14,7 @@ public:
 	BWAPI::Unit chooseTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets, std::map<BWAPI::Unit, int> & numTargeting);
 
 	int getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target);
-	BWAPI::Unit getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets);
+	int getTypeAttackPriority(BWAPI::Unit target, bool sieged);
+	int getScore(BWAPI::Unit rangedUnit, BWAPI::Unit target);
 };
 }
\ No newline at end of file
@@ -237,7 +237,7 @@ void MicroTransports::followPerimeter()
 	{
 		// The target might be far from the edge of the map, although
 		// our path around the edge of the map makes sense only if it is close.
-		the.micro_.Move(_transportShip, _target);
+		the.micro_.MoveSafely(_transportShip, _target);
 	}
 	else
 	{
@@ -255,7 +255,7 @@ void MicroTransports::followPerimeter()
 			BWAPI::Broodwar->drawCircleMap(destination, 5, BWAPI::Colors::Yellow, true);
 		}
 
-		the.micro_.Move(_transportShip, destination);
+		the.micro_.MoveSafely(_transportShip, destination);
 	}
 }
 
@@ -0,0 +1,134 @@
+#include "MiningModel.h"
+
+#include "Bases.h"
+
+using namespace KoalaRunBot;
+
+// Minerals farther than this from a depot that is not at a known base are not mined from it.
+// Same radius that WorkerData used for counting patches near a depot.
+static const int kLooseMineralRadius = 200;
+
+MiningModel::MiningModel(const BWAPI::Unit depot)
+	: depot_(depot)
+	, base_(FindBase(depot)) {
+	BWAPI::Unitset minerals;
+	if (base_) {
+		minerals = base_->getMinerals();
+	}
+	else {
+		for (const auto unit : BWAPI::Broodwar->getAllUnits()) {
+			if (unit->getType() == BWAPI::UnitTypes::Resource_Mineral_Field &&
+				unit->getDistance(depot) < kLooseMineralRadius) {
+				minerals.insert(unit);
+			}
+		}
+	}
+
+	const double speed = depot->getPlayer()->getRace().getWorker().topSpeed();
+
+	for (const auto patch : minerals) {
+		if (!patch->exists()) {
+			continue;
+		}
+		const int dist = std::max(EdgeDistance(depot, patch), DetourDistance(base_, depot, patch));
+		const int trip_frames = int(2.0 * dist / speed + 0.5) + kMiningFrames + kTurnaroundFrames;
+		patches_.push_back(PatchModel(patch, trip_frames));
+	}
+
+	std::sort(patches_.begin(), patches_.end(), [](const PatchModel& a, const PatchModel& b) {
+		return a.trip_frames_ < b.trip_frames_;
+	});
+}
+
+// The base whose depot spot the depot sits on, if any.
+const Base* MiningModel::FindBase(const BWAPI::Unit depot) {
+	for (const Base* base : Bases::Instance().getBases()) {
+		if (base->getTilePosition() == depot->getTilePosition()) {
+			return base;
+		}
+	}
+	return nullptr;
+}
+
+// The gap between the depot's and the patch's bounding boxes, which is what a worker walks.
+int MiningModel::EdgeDistance(const BWAPI::Unit depot, const BWAPI::Unit patch) {
+	const BWAPI::UnitType depot_type = depot->getType();
+	const BWAPI::UnitType patch_type = patch->getInitialType();
+	const BWAPI::Position d = depot->getPosition();
+	const BWAPI::Position p = patch->getInitialPosition();
+
+	const int dx = std::max(0, std::max(
+		(p.x - patch_type.dimensionLeft()) - (d.x + depot_type.dimensionRight()),
+		(d.x - depot_type.dimensionLeft()) - (p.x + patch_type.dimensionRight())));
+	const int dy = std::max(0, std::max(
+		(p.y - patch_type.dimensionUp()) - (d.y + depot_type.dimensionDown()),
+		(d.y - depot_type.dimensionUp()) - (p.y + patch_type.dimensionDown())));
+
+	return int(std::sqrt(double(dx * dx + dy * dy)));
+}
+
+// The patch tiles themselves are unwalkable, so look at the ring of tiles around the patch.
+// A result larger than the edge distance means the workers have to walk around something.
+// With walk distances, measured from the depot center, it is the edge distance plus however
+// much the walk to the nearest ring tile is longer than a straight line.
+// Otherwise the base's tile distances are measured from the upper left tile of the 4x3
+// depot spot, so take off the depot's width.
+int MiningModel::DetourDistance(const Base* base, const BWAPI::Unit depot, const BWAPI::Unit patch) {
+	if (!base) {
+		return 0;
+	}
+
+	const BWAPI::TilePosition top_left = patch->getInitialTilePosition();
+	const BWAPI::UnitType type = patch->getInitialType();
+	const bool walk = base->hasWalkDistances();
+
+	int best = -1;
+	BWAPI::Position best_center;
+	for (int x = top_left.x - 1; x <= top_left.x + type.tileWidth(); ++x) {
+		for (int y = top_left.y - 1; y <= top_left.y + type.tileHeight(); ++y) {
+			const BWAPI::TilePosition tile(x, y);
+			if (tile.isValid()) {
+				const BWAPI::Position center = BWAPI::Position(tile) + BWAPI::Position(16, 16);
+				const int dist = walk ? base->getDistance(center) : base->getTileDistance(tile);
+				if (dist >= 0 && (best < 0 || dist < best)) {
+					best = dist;
+					best_center = center;
+				}
+			}
+		}
+	}
+
+	if (best < 0) {
+		return 0;
+	}
+	if (walk) {
+		return EdgeDistance(depot, patch) + std::max(0, best - depot->getPosition().getApproxDistance(best_center));
+	}
+	return 32 * std::max(0, best - 4);
+}
+
+const MiningModel::PatchModel* MiningModel::FindPatch(const BWAPI::Unit patch) const {
+	for (const PatchModel& model : patches_) {
+		if (model.patch_ == patch) {
+			return &model;
+		}
+	}
+	return nullptr;
+}
+
+void MiningModel::RemovePatch(const BWAPI::Unit patch) {
+	patches_.erase(std::remove_if(patches_.begin(), patches_.end(), [patch](const PatchModel& model) {
+		return model.patch_ == patch;
+	}), patches_.end());
+}
+
+double MiningModel::PatchIncome(const PatchModel& patch, const int workers) {
+	if (workers <= 0) {
+		return 0.0;
+	}
+	return kMineralsPerTrip * std::min(double(workers) / patch.trip_frames_, 1.0 / kMiningFrames);
+}
+
+double MiningModel::MarginalIncome(const PatchModel& patch, const int workers) {
+	return PatchIncome(patch, workers + 1) - PatchIncome(patch, workers);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Common.h"
+
+namespace KoalaRunBot {
+  class Base;
+
+  // A model of mineral income at one resource depot, built once when the depot is complete.
+  // Each patch gets a predicted worker round trip time. A patch's income rises linearly
+  // with its workers until the patch is being mined all the time, then stays flat.
+  // The saturation curve is concave, so assigning workers greedily by marginal income
+  // maximizes the predicted total.
+  class MiningModel {
+  public:
+    struct PatchModel {
+      BWAPI::Unit patch_;
+      int trip_frames_; // travel both ways, plus mining and turnaround
+
+      PatchModel(const BWAPI::Unit patch, const int trip_frames)
+        : patch_(patch)
+          , trip_frames_(trip_frames) { }
+    };
+
+    static const int kMineralsPerTrip = 8;
+    static const int kMiningFrames = 80; // frames a patch is busy per trip; only one worker mines at a time
+    static const int kTurnaroundFrames = 80; // acceleration, turning and cargo handling at both ends
+
+  private:
+    BWAPI::Unit depot_;
+    const Base* base_; // null for a depot that is not at a base, e.g. a macro hatchery
+    std::vector<PatchModel> patches_; // shortest trip first
+
+    static const Base* FindBase(BWAPI::Unit depot);
+    static int EdgeDistance(BWAPI::Unit depot, BWAPI::Unit patch);
+    static int DetourDistance(const Base* base, BWAPI::Unit depot, BWAPI::Unit patch);
+
+  public:
+    explicit MiningModel(BWAPI::Unit depot);
+
+    BWAPI::Unit GetDepot() const { return depot_; }
+    const Base* GetBase() const { return base_; }
+    const std::vector<PatchModel>& GetPatches() const { return patches_; }
+    int GetPatchNum() const { return int(patches_.size()); }
+
+    const PatchModel* FindPatch(BWAPI::Unit patch) const;
+    void RemovePatch(BWAPI::Unit patch);
+
+    // Predicted minerals per frame from one patch with the given number of workers.
+    static double PatchIncome(const PatchModel& patch, int workers);
+
+    // Predicted gain from adding one worker to a patch that already has the given number.
+    static double MarginalIncome(const PatchModel& patch, int workers);
+  };
+}
@@ -1,10 +1,15 @@
 #include "OpponentModel.h"
 
+#include "AsyncWriter.h"
 #include "Bases.h"
 #include "Random.h"
 
 using namespace KoalaRunBot;
 
+// Starts the binary file. Change the version number if the record format changes.
+static const char binaryMagic[] = "om binary 1\n";
+static const size_t binaryMagicSize = sizeof(binaryMagic) - 1;
+
 OpeningPlan OpponentModel::predictEnemyPlan() const
 {
 	// Don't bother to predict on island maps.
@@ -457,22 +462,11 @@ void OpponentModel::considerGasSteal()
 }
 
 // Find the past game record which best matches the current game and remember it.
+// The matcher keeps its work from one call to the next.
 void OpponentModel::setBestMatch()
 {
-	int bestScore = -1;
-	GameRecord * bestRecord = nullptr;
-
-	for (GameRecord * record : _pastGameRecords)
-	{
-		int score = _gameRecord.distance(*record);
-		if (score != -1 && (!bestRecord || score < bestScore))
-		{
-			bestScore = score;
-			bestRecord = record;
-		}
-	}
-
-	_bestMatch = bestRecord;
+	_matcher.Update(_gameRecord, _pastGameRecords);
+	_bestMatch = _matcher.GetBestMatch();
 }
 
 // We have decided to explore openings. Return an appropriate opening name.
@@ -515,7 +509,9 @@ std::string OpponentModel::getOpeningForEnemyPlan(OpeningPlan enemyPlan)
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
 OpponentModel::OpponentModel()
-	: _bestMatch(nullptr)
+	: _storedRecords(0)
+	, _canAppend(false)
+	, _bestMatch(nullptr)
 	, _singleStrategy(false)
 	, _initialExpectedEnemyPlan(OpeningPlan::Unknown)
 	, _expectedEnemyPlan(OpeningPlan::Unknown)
@@ -528,37 +524,104 @@ OpponentModel::OpponentModel()
 	std::replace(name.begin(), name.end(), ' ', '_');
 
 	_filename = "om_" + name + ".txt";
+	_binaryFilename = "om_" + name + ".dat";
 }
 
-// Read past game records from the opponent model file, and do initial analysis.
-void OpponentModel::read()
+// Read game records from the old text format.
+// This happens only until the first binary file is written, which converts the records.
+void OpponentModel::readText()
 {
-	if (Config::IO::ReadOpponentModel)
+	std::ifstream inFile(Config::IO::ReadDir + _filename);
+
+	// There may not be a file to read. That's OK.
+	if (inFile.bad())
 	{
-		std::ifstream inFile(Config::IO::ReadDir + _filename);
+		return;
+	}
 
-		// There may not be a file to read. That's OK.
-		if (inFile.bad())
+	while (inFile.good())
+	{
+		// NOTE We allocate records here and never free them if valid.
+		//      Their lifetime is the whole game.
+		GameRecord * record = new GameRecord(inFile);
+		if (record->isValid())
 		{
-			return;
+			_pastGameRecords.push_back(record);
 		}
+		else
+		{
+			delete record;
+		}
+	}
 
-		while (inFile.good())
+	inFile.close();
+}
+
+// Read game records from the binary file. Return false if there is no usable binary file.
+// The whole file is read with one call and parsed in place.
+// Binary file format: the magic string, then the records one after another (see GameRecord::writeBinary()).
+bool OpponentModel::readBinary()
+{
+	std::ifstream inFile(Config::IO::ReadDir + _binaryFilename, std::ios::binary | std::ios::ate);
+	if (!inFile.is_open())
+	{
+		return false;
+	}
+
+	const std::streamoff size = inFile.tellg();
+	std::vector<char> buffer(size_t(std::max(std::streamoff(0), size)));
+	inFile.seekg(0);
+	if (buffer.size() < binaryMagicSize ||
+		!inFile.read(buffer.data(), buffer.size()) ||
+		std::string(buffer.data(), binaryMagicSize) != binaryMagic)
+	{
+		return false;
+	}
+	inFile.close();
+
+	const char * p = buffer.data() + binaryMagicSize;
+	const char * end = buffer.data() + buffer.size();
+	bool truncated = false;
+	while (p < end)
+	{
+		// NOTE We allocate records here and never free them if valid.
+		//      Their lifetime is the whole game.
+		GameRecord * record = new GameRecord(p, end);
+		truncated = truncated || record->isTruncated();
+		if (record->isValid())
 		{
-			// NOTE We allocate records here and never free them if valid.
-			//      Their lifetime is the whole game.
-			GameRecord * record = new GameRecord(inFile);
-			if (record->isValid())
-			{
-				_pastGameRecords.push_back(record);
-			}
-			else
-			{
-				delete record;
-			}
+			_pastGameRecords.push_back(record);
 		}
+		else
+		{
+			delete record;
+		}
+		++_storedRecords;
+	}
+
+	// The last record may have been cut short, e.g. by a crash while writing. Appending after
+	// it would misalign every later record, so the file must be rewritten.
+	// If the read and write directories differ, the write directory needs the whole file.
+	_canAppend = !truncated && Config::IO::ReadDir == Config::IO::WriteDir;
 
-		inFile.close();
+	// The file may hold up to twice the limit between compactions. Use only the most recent records.
+	if (int(_pastGameRecords.size()) > Config::IO::MaxGameRecords)
+	{
+		_pastGameRecords.erase(_pastGameRecords.begin(), _pastGameRecords.end() - Config::IO::MaxGameRecords);
+	}
+
+	return true;
+}
+
+// Read past game records from the opponent model file, and do initial analysis.
+void OpponentModel::read()
+{
+	if (Config::IO::ReadOpponentModel)
+	{
+		if (!readBinary())
+		{
+			readText();
+		}
 	}
 
 	// Make immediate decisions that may take into account the game records.
@@ -570,45 +633,56 @@ void OpponentModel::read()
 	considerGasSteal();
 }
 
-// Write the game records to the opponent model file.
-void OpponentModel::write()
+// Rewrite the whole binary file: the most recent past records, then the record of this game.
+// This also converts records that were read from the text format.
+void OpponentModel::writeBinary()
 {
-	if (Config::IO::WriteOpponentModel)
+	std::ostringstream output;
+
+	output.write(binaryMagic, binaryMagicSize);
+
+	// The number of initial game records to skip over without rewriting.
+	int nToSkip = 0;
+	if (int(_pastGameRecords.size()) >= Config::IO::MaxGameRecords)
 	{
-		std::ofstream outFile(Config::IO::WriteDir + _filename, std::ios::trunc);
+		nToSkip = _pastGameRecords.size() - Config::IO::MaxGameRecords + 1;
+	}
 
-		// If it fails, there's not much we can do about it.
-		if (outFile.bad())
+	for (auto record : _pastGameRecords)
+	{
+		if (nToSkip > 0)
 		{
-			return;
+			--nToSkip;
 		}
-
-		// The number of initial game records to skip over without rewriting.
-		// In normal operation, nToSkip is 0 or 1.
-		int nToSkip = 0;
-		if (int(_pastGameRecords.size()) >= Config::IO::MaxGameRecords)
+		else
 		{
-			nToSkip = _pastGameRecords.size() - Config::IO::MaxGameRecords + 1;
+			record->writeBinary(output);
 		}
+	}
 
-		// Rewrite any old records that were read in.
-		// Not needed for local testing or for SSCAIT, necessary for other competitions.
-		for (auto record : _pastGameRecords)
-		{
-			if (nToSkip > 0)
-			{
-				--nToSkip;
-			}
-			else
-			{
-				record->write(outFile);
-			}
-		}
+	_gameRecord.writeBinary(output);
 
-		// And write the record of this game.
-		_gameRecord.write(outFile);
+	AsyncWriter::Instance().Overwrite(Config::IO::WriteDir + _binaryFilename, output.str(), true);
+}
 
-		outFile.close();
+// Write the record of this game to the opponent model file.
+// Usually we append one record. Once the file reaches twice the record limit,
+// or if it can't be appended to, rewrite it with only the most recent records.
+// The record is serialized here and written to disk in the background.
+void OpponentModel::write()
+{
+	if (Config::IO::WriteOpponentModel)
+	{
+		if (_canAppend && _storedRecords < 2 * Config::IO::MaxGameRecords)
+		{
+			std::ostringstream output;
+			_gameRecord.writeBinary(output);
+			AsyncWriter::Instance().Append(Config::IO::WriteDir + _binaryFilename, output.str(), true);
+		}
+		else
+		{
+			writeBinary();
+		}
 	}
 }
 
@@ -624,7 +698,8 @@ void OpponentModel::update()
 		// TODO the rest is turned off for now, not currently useful
 		return;
 
-		if (BWAPI::Broodwar->getFrameCount() % 32 == 31)
+		// Rematch once after each snapshot is taken.
+		if (BWAPI::Broodwar->getFrameCount() % _gameRecord.getSnapshotInterval() == 1)
 		{
 			setBestMatch();
 		}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include "GameMatcher.h"
 #include "GameRecord.h"
 #include "OpponentPlan.h"
 
@@ -48,11 +49,15 @@ namespace KoalaRunBot
 
 		OpponentPlan _planRecognizer;
 
-		std::string _filename;
+		std::string _filename;					// text format, read only to convert it
+		std::string _binaryFilename;			// binary format, appended to each game
+		int _storedRecords;						// records in the binary file, valid or not
+		bool _canAppend;						// the binary file in the write directory is intact
 		GameRecord _gameRecord;
 		std::vector<GameRecord *> _pastGameRecords;
 
-		GameRecord * _bestMatch;
+		GameMatcher _matcher;
+		const GameRecord * _bestMatch;
 
 		// Advice for the rest of the bot.
 		OpponentSummary _summary;
@@ -74,6 +79,10 @@ namespace KoalaRunBot
 		void considerGasSteal();
 		void setBestMatch();
 
+		void readText();
+		bool readBinary();
+		void writeBinary();
+
 		std::string getExploreOpening(const OpponentSummary & opponentSummary);
 		std::string getOpeningForEnemyPlan(OpeningPlan enemyPlan);
 
@@ -174,14 +174,9 @@ void OpsBoss::Cluster(const BWAPI::Unitset& units, std::vector<UnitCluster>& clu
   ClusterUnits(unitsCopy, clusters); // NOTE modifies unitsCopy
 }
 
+// The frame scheduler calls this every few frames, while DrawClusters is on.
 void OpsBoss::Update() {
-  const int phase = BWAPI::Broodwar->getFrameCount() % 5;
-
-  if (phase == 0) {
-    Cluster(BWAPI::Broodwar->enemy(), your_clusters_);
-  }
-
-  DrawClusters();
+  Cluster(BWAPI::Broodwar->enemy(), your_clusters_);
 }
 
 // Draw enemy clusters.
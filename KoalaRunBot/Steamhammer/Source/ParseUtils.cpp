@@ -3,6 +3,7 @@
 
 #include "Bases.h"
 #include "BuildOrder.h"
+#include "EventLog.h"
 #include "OpponentModel.h"
 #include "Random.h"
 #include "StrategyManager.h"
@@ -90,6 +91,7 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
     {
         const rapidjson::Value & macro = doc["Macro"];
         JSONTools::ReadInt("BOSSFrameLimit", macro, Config::Macro::BOSSFrameLimit);
+        JSONTools::ReadInt("FrameBudget", macro, Config::Macro::FrameBudget);
         JSONTools::ReadInt("PylonSpacing", macro, Config::Macro::PylonSpacing);
 
 		Config::Macro::ProductionJamFrameLimit = GetIntByRace("ProductionJamFrameLimit", macro);
@@ -120,6 +122,7 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
         JSONTools::ReadBool("DrawEnemyUnitInfo", debug, Config::Debug::DrawEnemyUnitInfo);
         JSONTools::ReadBool("DrawMapInfo", debug, Config::Debug::DrawMapInfo);
         JSONTools::ReadBool("DrawMapGrid", debug, Config::Debug::DrawMapGrid);
+        JSONTools::ReadBool("DrawThreatMap", debug, Config::Debug::DrawThreatMap);
 		JSONTools::ReadBool("DrawMapDistances", debug, Config::Debug::DrawMapDistances);
 		JSONTools::ReadBool("DrawBaseInfo", debug, Config::Debug::DrawBaseInfo);
 		JSONTools::ReadBool("DrawStrategyBossInfo", debug, Config::Debug::DrawStrategyBossInfo);
@@ -135,6 +138,7 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
         const rapidjson::Value & tool = doc["Tools"];
 
         JSONTools::ReadInt("MapGridSize", tool, Config::Tools::MAP_GRID_SIZE);
+        JSONTools::ReadBool("WalkDistances", tool, Config::Tools::WalkDistances);
     }
 
 	// Parse the IO options.
@@ -144,11 +148,21 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
 
 		JSONTools::ReadString("ErrorLogFilename", io, Config::IO::ErrorLogFilename);
 		JSONTools::ReadBool("LogAssertToErrorFile", io, Config::IO::LogAssertToErrorFile);
+		JSONTools::ReadString("EventLogFilename", io, Config::IO::EventLogFilename);
+		JSONTools::ReadString("EventLogLevel", io, Config::IO::EventLogLevel);
+		JSONTools::ReadString("EventLogSubsystems", io, Config::IO::EventLogSubsystems);
+		EventLog::Instance().Configure(Config::IO::EventLogLevel, Config::IO::EventLogSubsystems);
+		JSONTools::ReadString("ProfileFilename", io, Config::IO::ProfileFilename);
+		JSONTools::ReadString("ProfileTraceFilename", io, Config::IO::ProfileTraceFilename);
+		JSONTools::ReadString("CombatSimRecordFilename", io, Config::IO::CombatSimRecordFilename);
+		JSONTools::ReadString("BOSSCorpusFilename", io, Config::IO::BOSSCorpusFilename);
+		JSONTools::ReadString("BuildOrderTableFilename", io, Config::IO::BuildOrderTableFilename);
 
 		JSONTools::ReadString("ReadDirectory", io, Config::IO::ReadDir);
 		JSONTools::ReadString("WriteDirectory", io, Config::IO::WriteDir);
 
 		JSONTools::ReadInt("MaxGameRecords", io, Config::IO::MaxGameRecords);
+		JSONTools::ReadInt("EndWriteTimeout", io, Config::IO::EndWriteTimeout);
 
 		Config::IO::ReadOpponentModel = GetBoolByRace("ReadOpponentModel", io);
 		Config::IO::WriteOpponentModel = GetBoolByRace("WriteOpponentModel", io);
@@ -433,6 +447,7 @@ void ParseUtils::ParseTextCommand(const std::string & commandString)
 		else if (variableName == "drawunitorders") { Config::Debug::DrawUnitOrders = GetBoolFromString(val); }
 		else if (variableName == "drawmapinfo") { Config::Debug::DrawMapInfo = GetBoolFromString(val); }
         else if (variableName == "drawmapgrid") { Config::Debug::DrawMapGrid = GetBoolFromString(val); }
+        else if (variableName == "drawthreatmap") { Config::Debug::DrawThreatMap = GetBoolFromString(val); }
 		else if (variableName == "drawmapdistances") { Config::Debug::DrawMapDistances = GetBoolFromString(val); }
 		else if (variableName == "drawbaseinfo") { Config::Debug::DrawBaseInfo = GetBoolFromString(val); }
 		else if (variableName == "drawstrategybossinfo") { Config::Debug::DrawStrategyBossInfo = GetBoolFromString(val); }
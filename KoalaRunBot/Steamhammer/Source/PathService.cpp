@@ -0,0 +1,372 @@
+#include "PathService.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#include "MapTools.h"
+#include "Profiler.h"
+#include "The.h"
+
+using namespace KoalaRunBot;
+
+// Search a corridor in use again after this long, since the threats may have changed.
+static const int kReplanFrames = 2 * 24;
+
+// A unit this far from all of a corridor's waypoints does not use it.
+static const int kOffPathDistance = 8 * 32;
+
+// Corridors to the same goal, at most. Past this, a unit far from all of them gets no path.
+static const int kMaxCorridorsPerGoal = 4;
+
+// Forget a corridor not used for this long.
+static const int kForgetFrames = 10 * 24;
+
+// Tiles between waypoints.
+static const int kWaypointSpacing = 4;
+
+// A step onto a tile with this much threat costs twice as much as a safe step.
+static const int kThreatScale = 16;
+
+// Expansions between looks at the clock.
+static const int kExpansionsPerCheck = 64;
+
+PathService::PathService()
+	: width_(0)
+	, height_(0)
+	, next_id_(0)
+	, searching_(false)
+	, goal_index_(-1)
+	, search_mark_(0)
+{
+}
+
+void PathService::Initialize()
+{
+	width_ = BWAPI::Broodwar->mapWidth();
+	height_ = BWAPI::Broodwar->mapHeight();
+	mark_.assign(width_ * height_, 0);
+	cost_.assign(width_ * height_, 0);
+	parent_.assign(width_ * height_, -1);
+	corridors_.clear();
+	requests_.clear();
+	searching_ = false;
+}
+
+// The index of the waypoint nearest to from, and its distance. The waypoints must not be empty.
+size_t PathService::Nearest(const std::vector<BWAPI::Position>& waypoints, const BWAPI::Position& from, int& dist)
+{
+	size_t nearest = 0;
+	dist = INT_MAX;
+	for (size_t i = 0; i < waypoints.size(); ++i)
+	{
+		const int d = from.getApproxDistance(waypoints[i]);
+		if (d < dist)
+		{
+			nearest = i;
+			dist = d;
+		}
+	}
+	return nearest;
+}
+
+// Octile distance to the goal in the step units of 10 straight and 14 diagonal,
+// weighted by 5/4 to find a good path sooner at the cost of a slightly longer one.
+int PathService::Heuristic(int x, int y) const
+{
+	const int dx = std::abs(x - current_.goal_.x);
+	const int dy = std::abs(y - current_.goal_.y);
+	return 5 * (10 * std::max(dx, dy) + 4 * std::min(dx, dy)) / 4;
+}
+
+bool PathService::Passable(int x, int y) const
+{
+	return current_.air_ || MapTools::Instance().isWalkable(BWAPI::TilePosition(x, y));
+}
+
+// How far a unit at from is from the corridor: from its nearest waypoint, or from its start
+// if there are no waypoints yet.
+int PathService::Distance(const Corridor& corridor, const BWAPI::Position& from)
+{
+	if (corridor.waypoints_.empty())
+	{
+		return from.getApproxDistance(BWAPI::Position(corridor.start_) + BWAPI::Position(16, 16));
+	}
+	int dist;
+	Nearest(corridor.waypoints_, from, dist);
+	return dist;
+}
+
+void PathService::Queue(int id, Corridor& corridor)
+{
+	Request request;
+	request.id_ = id;
+	request.start_ = corridor.start_;
+	request.goal_ = corridor.goal_;
+	request.air_ = corridor.air_;
+	corridor.queued_ = true;
+	requests_.push_back(request);
+}
+
+// Return the nearest corridor to the goal if a path has been searched for, or null if not yet.
+// Start a new corridor from here if none is near enough, unless the goal has enough already;
+// then return null, since another unit's path would lead this one astray.
+// Queue a search of the corridor if it is due to be searched again. It is searched from its
+// own start, so that units using it from different places don't take turns moving it.
+const PathService::Corridor* PathService::FindCorridor(const BWAPI::Position& from, const BWAPI::Position& to, bool air)
+{
+	if (width_ == 0 || !from.isValid() || !to.isValid())
+	{
+		return nullptr;
+	}
+
+	const int now = BWAPI::Broodwar->getFrameCount();
+	const BWAPI::TilePosition goal(to);
+
+	int count = 0;
+	int bestDist = INT_MAX;
+	auto best = corridors_.end();
+	for (auto it = corridors_.begin(); it != corridors_.end(); ++it)
+	{
+		if (it->second.goal_ == goal && it->second.air_ == air)
+		{
+			++count;
+			const int dist = Distance(it->second, from);
+			if (dist < bestDist)
+			{
+				best = it;
+				bestDist = dist;
+			}
+		}
+	}
+
+	if (best == corridors_.end() || (bestDist > kOffPathDistance && count < kMaxCorridorsPerGoal))
+	{
+		const int id = next_id_++;
+		Corridor& corridor = corridors_[id];
+		corridor.start_ = BWAPI::TilePosition(from);
+		corridor.goal_ = goal;
+		corridor.air_ = air;
+		corridor.found_frame_ = -1;
+		corridor.used_frame_ = now;
+		Queue(id, corridor);
+		return nullptr;
+	}
+	if (bestDist > kOffPathDistance)
+	{
+		return nullptr;
+	}
+
+	Corridor& corridor = best->second;
+	corridor.used_frame_ = now;
+	if (!corridor.queued_ && now - corridor.found_frame_ > kReplanFrames)
+	{
+		Queue(best->first, corridor);
+	}
+	return corridor.found_frame_ >= 0 ? &corridor : nullptr;
+}
+
+void PathService::StartSearch(const Request& request)
+{
+	current_ = request;
+	searching_ = true;
+
+	// Reset the marks if they are about to wrap.
+	if (++search_mark_ == INT_MAX)
+	{
+		std::fill(mark_.begin(), mark_.end(), 0);
+		search_mark_ = 1;
+	}
+	open_ = std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>>();
+
+	goal_index_ = Index(current_.goal_.x, current_.goal_.y);
+	if (!Passable(current_.goal_.x, current_.goal_.y))
+	{
+		FinishSearch(false);
+		return;
+	}
+
+	const int start = Index(current_.start_.x, current_.start_.y);
+	mark_[start] = search_mark_;
+	cost_[start] = 0;
+	parent_[start] = -1;
+	open_.push(OpenNode(Heuristic(current_.start_.x, current_.start_.y), start));
+}
+
+// Expand one node, or finish the search.
+void PathService::Expand()
+{
+	if (open_.empty())
+	{
+		FinishSearch(false);
+		return;
+	}
+
+	const OpenNode node = open_.top();
+	open_.pop();
+
+	const int index = node.second;
+	const int x = index / height_;
+	const int y = index % height_;
+
+	// Skip a node that was reached more cheaply after it was pushed.
+	if (node.first != cost_[index] + Heuristic(x, y))
+	{
+		return;
+	}
+
+	if (index == goal_index_)
+	{
+		FinishSearch(true);
+		return;
+	}
+
+	const ThreatMap& threats = The::Root().threat_map_;
+	for (int dx = -1; dx <= 1; ++dx)
+	{
+		for (int dy = -1; dy <= 1; ++dy)
+		{
+			const int nx = x + dx;
+			const int ny = y + dy;
+			if ((dx == 0 && dy == 0) ||
+				nx < 0 || nx >= width_ || ny < 0 || ny >= height_ ||
+				!Passable(nx, ny) ||
+				(dx != 0 && dy != 0 && !(Passable(nx, y) && Passable(x, ny))))
+			{
+				continue;
+			}
+
+			const int step = dx != 0 && dy != 0 ? 14 : 10;
+			const int threat = threats.At(BWAPI::TilePosition(nx, ny), current_.air_);
+			const int cost = cost_[index] + step * (kThreatScale + threat) / kThreatScale;
+
+			const int next = Index(nx, ny);
+			if (mark_[next] != search_mark_ || cost < cost_[next])
+			{
+				mark_[next] = search_mark_;
+				cost_[next] = cost;
+				parent_[next] = index;
+				open_.push(OpenNode(cost + Heuristic(nx, ny), next));
+			}
+		}
+	}
+}
+
+// Store the path in the corridor, unless the corridor was forgotten in the meantime.
+void PathService::FinishSearch(bool found)
+{
+	searching_ = false;
+
+	auto it = corridors_.find(current_.id_);
+	if (it == corridors_.end())
+	{
+		return;
+	}
+
+	Corridor& corridor = it->second;
+	corridor.queued_ = false;
+	corridor.found_frame_ = BWAPI::Broodwar->getFrameCount();
+	corridor.waypoints_.clear();
+
+	if (found)
+	{
+		std::vector<int> tiles;
+		for (int i = goal_index_; i != -1; i = parent_[i])
+		{
+			tiles.push_back(i);
+		}
+		std::reverse(tiles.begin(), tiles.end());
+
+		for (size_t i = kWaypointSpacing; i + 1 < tiles.size(); i += kWaypointSpacing)
+		{
+			const BWAPI::TilePosition tile(tiles[i] / height_, tiles[i] % height_);
+			corridor.waypoints_.push_back(BWAPI::Position(tile) + BWAPI::Position(16, 16));
+		}
+		corridor.waypoints_.push_back(BWAPI::Position(current_.goal_) + BWAPI::Position(16, 16));
+	}
+}
+
+void PathService::Forget()
+{
+	const int now = BWAPI::Broodwar->getFrameCount();
+	for (auto it = corridors_.begin(); it != corridors_.end(); )
+	{
+		if (now - it->second.used_frame_ > kForgetFrames)
+		{
+			it = corridors_.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void PathService::Update(double ms)
+{
+	if (width_ == 0)
+	{
+		return;
+	}
+
+	Forget();
+
+	const double deadline = Profiler::Instance().FrameMilliseconds() + ms;
+	int expansions = 0;
+	for (;;)
+	{
+		if (!searching_)
+		{
+			if (requests_.empty())
+			{
+				return;
+			}
+			const Request request = requests_.front();
+			requests_.pop_front();
+			if (corridors_.find(request.id_) != corridors_.end())
+			{
+				StartSearch(request);
+			}
+			continue;
+		}
+
+		Expand();
+
+		if (++expansions % kExpansionsPerCheck == 0 &&
+			Profiler::Instance().FrameMilliseconds() >= deadline)
+		{
+			return;
+		}
+	}
+}
+
+bool PathService::GetPath(const BWAPI::Position& from, const BWAPI::Position& to, bool air, std::vector<BWAPI::Position>& waypoints)
+{
+	const Corridor* corridor = FindCorridor(from, to, air);
+	if (!corridor || corridor->waypoints_.empty())
+	{
+		return false;
+	}
+	waypoints = corridor->waypoints_;
+	return true;
+}
+
+// A unit which is not close to its nearest waypoint goes there first, to get onto the path.
+BWAPI::Position PathService::NextWaypoint(const BWAPI::Position& from, const BWAPI::Position& to, bool air)
+{
+	const Corridor* corridor = FindCorridor(from, to, air);
+	if (!corridor || corridor->waypoints_.empty())
+	{
+		return to;
+	}
+
+	const std::vector<BWAPI::Position>& waypoints = corridor->waypoints_;
+	int nearestDist;
+	const size_t nearest = Nearest(waypoints, from, nearestDist);
+
+	if (nearestDist > 3 * 32)
+	{
+		return waypoints[nearest];
+	}
+	return nearest + 1 < waypoints.size() ? waypoints[nearest + 1] : to;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace KoalaRunBot {
+  // Threat-aware paths over the tile grid, for air or ground units.
+  // A path is found by weighted A*. A step costs its length times a factor that grows with
+  // the ThreatMap's threat on the tile it enters, so paths bend around defenses when the
+  // detour is worth it. Ground paths keep to walkable tiles and don't cut corners.
+  // Paths are cached as corridors of waypoints between a start tile and a goal tile. A unit
+  // uses the nearest corridor to its goal if it is close to one of its waypoints, and joins
+  // it there, so units coming the same way share one search. Units coming from elsewhere get
+  // a corridor of their own, up to a few per goal, or else no path. A corridor that is in
+  // use is searched again from its own start every couple of seconds, as the threats change.
+  // One that is not used is forgotten.
+  // Searches are queued and time-sliced: Update() continues the search in progress for as
+  // long as it is given, and picks it up again on a later frame.
+  class PathService {
+    struct Corridor {
+      BWAPI::TilePosition start_;
+      BWAPI::TilePosition goal_;
+      bool air_;
+      std::vector<BWAPI::Position> waypoints_; // empty if no path was found
+      int found_frame_;                        // -1 until the first search finishes
+      int used_frame_;
+      bool queued_;
+    };
+
+    struct Request {
+      int id_;
+      BWAPI::TilePosition start_;
+      BWAPI::TilePosition goal_;
+      bool air_;
+    };
+
+    // An open node: estimated total cost, tile index.
+    typedef std::pair<int, int> OpenNode;
+
+    int width_;
+    int height_;
+    std::map<int, Corridor> corridors_; // by id
+    int next_id_;
+    std::deque<Request> requests_;
+
+    // The search in progress, kept across frames.
+    bool searching_;
+    Request current_;
+    int goal_index_;
+    int search_mark_;
+    std::vector<int> mark_;   // tile index -> search_mark_ if cost_ and parent_ are valid
+    std::vector<int> cost_;
+    std::vector<int> parent_;
+    std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> open_;
+
+    static size_t Nearest(const std::vector<BWAPI::Position>& waypoints, const BWAPI::Position& from, int& dist);
+    int Index(int x, int y) const { return x * height_ + y; }
+    int Heuristic(int x, int y) const;
+    bool Passable(int x, int y) const;
+
+    static int Distance(const Corridor& corridor, const BWAPI::Position& from);
+    void Queue(int id, Corridor& corridor);
+    const Corridor* FindCorridor(const BWAPI::Position& from, const BWAPI::Position& to, bool air);
+    void StartSearch(const Request& request);
+    void Expand();
+    void FinishSearch(bool found);
+    void Forget();
+
+  public:
+    PathService();
+
+    void Initialize();
+
+    // Continue searching for up to this many milliseconds.
+    void Update(double ms);
+
+    // Fill in the corridor's waypoints to the goal and return true if a path is known.
+    // Otherwise queue a search and return false. The corridor may start elsewhere; a unit
+    // joins it at the nearest waypoint.
+    bool GetPath(const BWAPI::Position& from, const BWAPI::Position& to, bool air, std::vector<BWAPI::Position>& waypoints);
+
+    // Where a unit at from should head next on the way to to: the waypoint after the nearest
+    // one on a known path, or else to itself.
+    BWAPI::Position NextWaypoint(const BWAPI::Position& from, const BWAPI::Position& to, bool air);
+  };
+}
@@ -2,17 +2,30 @@
 
 #include "Common.h"
 
+#include <array>
+#include <cstdint>
+
 namespace KoalaRunBot
 {
+// Unit counts are kept in a small fixed array, with one slot per unit type of one race.
+// The race is the player's race, or else the race of the first unit type counted.
+// The rare unit type of another race (say, a mind controlled unit) goes into a short side list.
 class PlayerSnapshot
 {
+public:
+	static const int MaxSlots = 64;			// more than the unit types of any race
+
+private:
+	int race;								// slot layout: 0 Zerg, 1 Terran, 2 Protoss, -1 not yet decided
+	std::array<uint16_t, MaxSlots> counts;
+	std::vector< std::pair<BWAPI::UnitType, int> > otherCounts;
+
 	bool excludeType(BWAPI::UnitType type);
 
+	void setRace(BWAPI::Race r);
+
 public:
 	int numBases;
-	std::map<BWAPI::UnitType, int> unitCounts;
-
-	const std::map<BWAPI::UnitType, int> & getCounts() const { return unitCounts; };
 
 	PlayerSnapshot();
 	PlayerSnapshot(BWAPI::Player);
@@ -21,6 +34,19 @@ public:
 	void takeEnemy();
 
 	int getCount(BWAPI::UnitType type) const;
+	void setCount(BWAPI::UnitType type, int n);
+
+	// The nonzero counts.
+	std::vector< std::pair<BWAPI::UnitType, int> > getCounts() const;
+
+	// The counts by index, read in place: the race's slots in their fixed order, then the side
+	// list. A slot counts 0 if the player has none of its unit type.
+	int numIndexes() const;
+	BWAPI::UnitType typeAt(int i) const;
+	int countAt(int i) const;
+
+	// The sum of the differences in unit counts.
+	static int distance(const PlayerSnapshot & a, const PlayerSnapshot & b);
 
 	std::string debugString() const;
 };
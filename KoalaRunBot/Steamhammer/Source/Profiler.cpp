@@ -0,0 +1,337 @@
+#include "Profiler.h"
+
+#include "AsyncWriter.h"
+#include "Common.h"
+#include "EventLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+using namespace KoalaRunBot;
+
+// The tournament limits: 320 frames over 55ms (we aim lower), 10 frames over 1s, 1 frame over 10s.
+const double Profiler::kLimitMs[kLimitNum] = { 42.0, 1000.0, 10000.0 };
+
+// Event log id for a slow frame: frame milliseconds, limit index.
+static const int kEventSlowFrame = 1;
+
+Profiler::Profiler()
+	: records_(kMaxRecordsPerFrame)
+	, record_num_(0)
+	, depth_(0)
+	, in_frame_(false)
+	, last_frame_ms_(0.0)
+	, traced_frames_(0)
+	, first_tick_(0) {
+	for (int i = 0; i < kLimitNum; ++i) {
+		limit_counts_[i] = 0;
+	}
+	root_zone_ = ZoneId("Total");
+}
+
+int64_t Profiler::Now() {
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	return count.QuadPart;
+}
+
+double Profiler::TicksToMs(const int64_t ticks) {
+	static double ms_per_tick = 0.0;
+	if (ms_per_tick == 0.0) {
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		ms_per_tick = 1000.0 / double(frequency.QuadPart);
+	}
+	return ticks * ms_per_tick;
+}
+
+// Bucket b holds times up to 1.05^b - 1 microseconds.
+int Profiler::Bucket(const double ms) {
+	const int bucket = int(std::ceil(std::log(1.0 + 1000.0 * ms) / std::log(1.05)));
+	return std::min(std::max(bucket, 0), kBuckets - 1);
+}
+
+double Profiler::BucketMs(const int bucket) {
+	return (std::pow(1.05, bucket) - 1.0) / 1000.0;
+}
+
+int Profiler::ZoneId(const char* name) {
+	const auto it = zone_ids_.find(name);
+	if (it != zone_ids_.end()) {
+		return it->second;
+	}
+
+	ZoneStats stats;
+	stats.name_ = name;
+	stats.histogram_.assign(kBuckets, 0);
+	stats.frames_ = 0;
+	stats.total_ms_ = 0.0;
+	stats.max_ms_ = 0.0;
+	stats.frame_ms_ = 0.0;
+	zones_.push_back(stats);
+
+	const int id = int(zones_.size()) - 1;
+	zone_ids_[name] = id;
+	return id;
+}
+
+// Zones outside a frame, or past the buffer or depth limits, are not recorded.
+// Begin() and End() still pair up, so the tree stays consistent.
+void Profiler::Begin(const int zone) {
+	if (!in_frame_ || depth_ >= kMaxDepth) {
+		++depth_;
+		return;
+	}
+	if (record_num_ >= kMaxRecordsPerFrame) {
+		stack_[depth_++] = -1;
+		return;
+	}
+	Record& record = records_[record_num_];
+	record.zone_ = zone;
+	record.depth_ = depth_;
+	record.start_ = Now();
+	record.end_ = record.start_;
+	stack_[depth_++] = record_num_++;
+}
+
+void Profiler::End() {
+	--depth_;
+	if (!in_frame_ || depth_ >= kMaxDepth || stack_[depth_] < 0) {
+		return;
+	}
+	Record& record = records_[stack_[depth_]];
+	record.end_ = Now();
+
+	// A zone that runs more than once in a frame counts its total time, but a recursive run is
+	// already inside the time of the outer run.
+	for (int d = 0; d < depth_; ++d) {
+		if (stack_[d] >= 0 && records_[stack_[d]].zone_ == record.zone_) {
+			return;
+		}
+	}
+	ZoneStats& stats = zones_[record.zone_];
+	if (stats.frame_ms_ == 0.0) {
+		touched_zones_.push_back(record.zone_);
+	}
+	stats.frame_ms_ += std::max(TicksToMs(record.end_ - record.start_), 1e-6);
+}
+
+void Profiler::BeginFrame() {
+	record_num_ = 0;
+	depth_ = 0;
+	in_frame_ = true;
+	if (first_tick_ == 0) {
+		first_tick_ = Now();
+	}
+	Begin(root_zone_);
+}
+
+void Profiler::FinishFrame() {
+	End();
+	EndFrame();
+	in_frame_ = false;
+}
+
+// Fold the frame into the statistics, and flag it if it was slow.
+void Profiler::EndFrame() {
+	last_frame_top_.clear();
+	for (int i = 0; i < record_num_; ++i) {
+		const Record& record = records_[i];
+		if (record.depth_ == 1) {
+			const double ms = TicksToMs(record.end_ - record.start_);
+			auto it = std::find_if(last_frame_top_.begin(), last_frame_top_.end(),
+				[&record](const std::pair<int, double>& zone_ms) { return zone_ms.first == record.zone_; });
+			if (it == last_frame_top_.end()) {
+				last_frame_top_.push_back(std::make_pair(record.zone_, ms));
+			}
+			else {
+				it->second += ms;
+			}
+		}
+	}
+
+	for (const int zone : touched_zones_) {
+		ZoneStats& stats = zones_[zone];
+		++stats.histogram_[Bucket(stats.frame_ms_)];
+		++stats.frames_;
+		stats.total_ms_ += stats.frame_ms_;
+		stats.max_ms_ = std::max(stats.max_ms_, stats.frame_ms_);
+		stats.frame_ms_ = 0.0;
+	}
+	touched_zones_.clear();
+
+	const double frame_ms = TicksToMs(records_[0].end_ - records_[0].start_);
+	last_frame_ms_ = frame_ms;
+	int limit = -1;
+	for (int i = 0; i < kLimitNum; ++i) {
+		if (frame_ms > kLimitMs[i]) {
+			++limit_counts_[i];
+			limit = i;
+		}
+	}
+	if (limit < 0) {
+		return;
+	}
+
+	const int frame = BWAPI::Broodwar->getFrameCount();
+	EventLog::Instance().Log(EventSubsystem::General, EventSeverity::Warning, kEventSlowFrame, int(frame_ms), limit);
+
+	if (int(slow_frames_.size()) < kMaxSlowFrames) {
+		SlowFrame slow;
+		slow.frame_ = frame;
+		slow.ms_ = frame_ms;
+		slow.limit_ = limit;
+		slow.path_ = SlowPath();
+		slow_frames_.push_back(slow);
+	}
+
+	if (traced_frames_ < kMaxTracedFrames) {
+		++traced_frames_;
+		for (int i = 0; i < record_num_; ++i) {
+			TraceRecord trace;
+			trace.frame_ = frame;
+			trace.record_ = records_[i];
+			trace_.push_back(trace);
+		}
+	}
+}
+
+// From the root, follow the child that took the most time, as long as it took most of its parent's time.
+// The records are in preorder, so a record's children follow it.
+std::string Profiler::SlowPath() const {
+	std::string path = zones_[records_[0].zone_].name_;
+	int node = 0;
+	for (;;) {
+		const int depth = records_[node].depth_;
+		const int64_t node_ticks = records_[node].end_ - records_[node].start_;
+		int heaviest = -1;
+		for (int i = node + 1; i < record_num_ && records_[i].depth_ > depth; ++i) {
+			if (records_[i].depth_ == depth + 1 &&
+				(heaviest < 0 || records_[i].end_ - records_[i].start_ > records_[heaviest].end_ - records_[heaviest].start_)) {
+				heaviest = i;
+			}
+		}
+		if (heaviest < 0 || 2 * (records_[heaviest].end_ - records_[heaviest].start_) < node_ticks) {
+			return path;
+		}
+		node = heaviest;
+		path += " > " + zones_[records_[node].zone_].name_;
+	}
+}
+
+double Profiler::FrameMilliseconds() const {
+	return in_frame_ && record_num_ > 0 ? TicksToMs(Now() - records_[0].start_) : 0.0;
+}
+
+double Profiler::GetMeanMilliseconds() const {
+	const ZoneStats& stats = zones_[root_zone_];
+	return stats.frames_ ? stats.total_ms_ / stats.frames_ : 0.0;
+}
+
+double Profiler::GetMaxMilliseconds() const {
+	return zones_[root_zone_].max_ms_;
+}
+
+// The upper edge of the bucket where the fraction of frames is reached.
+double Profiler::Percentile(const ZoneStats& stats, const double fraction) const {
+	const int target = std::max(1, int(std::ceil(fraction * stats.frames_)));
+	int seen = 0;
+	for (int b = 0; b < kBuckets; ++b) {
+		seen += stats.histogram_[b];
+		if (seen >= target) {
+			return std::min(BucketMs(b), stats.max_ms_);
+		}
+	}
+	return stats.max_ms_;
+}
+
+// Bars scaled to the frame time.
+void Profiler::DrawZoneTimers(const int x, const int y) const {
+	if (!Config::Debug::DrawModuleTimers) {
+		return;
+	}
+
+	const int bar_width = 40;
+	const double total = last_frame_ms_;
+
+	BWAPI::Broodwar->drawBoxScreen(x - 5, y - 5, x + 110 + bar_width, y + 5 + 10 * (1 + int(last_frame_top_.size())),
+	                               BWAPI::Colors::Black, true);
+
+	int yskip = 0;
+	auto draw_bar = [&](const std::string& name, const double elapsed) {
+		if (elapsed > 55) {
+			BWAPI::Broodwar->printf("Timer Debug: %s %lf", name.c_str(), elapsed);
+		}
+		const int width = total == 0.0 ? 0 : int(bar_width * (elapsed / total));
+		BWAPI::Broodwar->drawTextScreen(x, y + yskip - 3, "\x04 %s", name.c_str());
+		BWAPI::Broodwar->drawBoxScreen(x + 60, y + yskip, x + 60 + width + 1, y + yskip + 8, BWAPI::Colors::White);
+		BWAPI::Broodwar->drawTextScreen(x + 70 + bar_width, y + yskip - 3, "%.4lf", elapsed);
+		yskip += 10;
+	};
+
+	draw_bar(zones_[root_zone_].name_, total);
+	for (const auto& zone_ms : last_frame_top_) {
+		draw_bar(zones_[zone_ms.first].name_, zone_ms.second);
+	}
+}
+
+// An empty filename skips that file.
+void Profiler::WriteReport(const std::string& summary_file, const std::string& trace_file) const {
+	if (!summary_file.empty()) {
+		WriteSummary(summary_file);
+	}
+	if (!trace_file.empty()) {
+		WriteTrace(trace_file);
+	}
+}
+
+void Profiler::WriteSummary(const std::string& filename) const {
+	std::ostringstream summary;
+	summary << "zone frames mean p50 p95 p99 max (ms)\n";
+	for (const ZoneStats& stats : zones_) {
+		if (stats.frames_ == 0) {
+			continue;
+		}
+		summary << stats.name_ << ' ' << stats.frames_ << ' '
+			<< stats.total_ms_ / stats.frames_ << ' '
+			<< Percentile(stats, 0.50) << ' '
+			<< Percentile(stats, 0.95) << ' '
+			<< Percentile(stats, 0.99) << ' '
+			<< stats.max_ms_ << '\n';
+	}
+	summary << '\n';
+	for (int i = 0; i < kLimitNum; ++i) {
+		summary << "frames over " << kLimitMs[i] << "ms: " << limit_counts_[i] << '\n';
+	}
+	summary << '\n';
+	for (const SlowFrame& slow : slow_frames_) {
+		summary << "frame " << slow.frame_ << ' ' << slow.ms_ << "ms over " << kLimitMs[slow.limit_] << "ms: " << slow.path_ << '\n';
+	}
+	AsyncWriter::Instance().Overwrite(filename, summary.str());
+}
+
+// Timestamps in microseconds since the first frame.
+void Profiler::WriteTrace(const std::string& filename) const {
+	std::ostringstream trace;
+	trace << "{\"traceEvents\":[";
+	for (size_t i = 0; i < trace_.size(); ++i) {
+		const TraceRecord& t = trace_[i];
+		trace << (i ? ",\n" : "\n")
+			<< "{\"name\":\"" << zones_[t.record_.zone_].name_ << "\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+			<< ",\"ts\":" << int64_t(1000.0 * TicksToMs(t.record_.start_ - first_tick_))
+			<< ",\"dur\":" << int64_t(1000.0 * TicksToMs(t.record_.end_ - t.record_.start_))
+			<< ",\"args\":{\"frame\":" << t.frame_ << "}}";
+	}
+	trace << "\n]}\n";
+	AsyncWriter::Instance().Overwrite(filename, trace.str());
+}
+
+Profiler& Profiler::Instance() {
+	static Profiler instance;
+	return instance;
+}
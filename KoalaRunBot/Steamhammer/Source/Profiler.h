@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Time the rest of the enclosing block as a zone with the given name, which must be a string literal.
+// Zones nest. The zone's id is looked up once per call site.
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) \
+  static const int PROFILE_CONCAT(profile_zone_id_, __LINE__) = KoalaRunBot::Profiler::Instance().ZoneId(name); \
+  KoalaRunBot::ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(PROFILE_CONCAT(profile_zone_id_, __LINE__))
+
+namespace KoalaRunBot {
+  // A hierarchical frame profiler.
+  // Each frame is a tree of zones, recorded into a preallocated buffer. At the end of the frame,
+  // each zone's time for the frame goes into a log-scale histogram, for percentiles over the game.
+  // A frame over one of the tournament time limits is flagged, along with the zone that made it slow:
+  // the end of the path from the root that keeps following the child that took most of its parent's time.
+  // The zone trees of the first slow frames are kept for a Chrome trace (chrome://tracing) at game end.
+  class Profiler {
+  public:
+    static const int kMaxRecordsPerFrame = 4096;
+    static const int kMaxDepth = 64;
+    static const int kMaxTracedFrames = 100;
+    static const int kMaxSlowFrames = 200;
+    static const int kLimitNum = 3;
+
+  private:
+    static const int kBuckets = 400; // 5% wide, up to about 5 minutes
+
+    struct Record {
+      int zone_;
+      int depth_;
+      int64_t start_;
+      int64_t end_;
+    };
+
+    struct TraceRecord {
+      int frame_;
+      Record record_;
+    };
+
+    struct ZoneStats {
+      std::string name_;
+      std::vector<int> histogram_; // frames by the zone's time in the frame
+      int frames_; // frames the zone ran in
+      double total_ms_;
+      double max_ms_;
+      double frame_ms_; // so far in the current frame
+    };
+
+    struct SlowFrame {
+      int frame_;
+      double ms_;
+      int limit_; // index of the largest limit exceeded
+      std::string path_;
+    };
+
+    std::vector<ZoneStats> zones_;
+    std::map<std::string, int> zone_ids_;
+
+    std::vector<Record> records_; // the current frame, in the order the zones started
+    int record_num_;
+    int stack_[kMaxDepth];
+    int depth_;
+    bool in_frame_;
+
+    std::vector<int> touched_zones_; // zones that ran in the current frame
+    double last_frame_ms_;
+    std::vector<std::pair<int, double>> last_frame_top_; // the last frame's zones just under the root
+
+    int limit_counts_[kLimitNum];
+    std::vector<SlowFrame> slow_frames_;
+    std::vector<TraceRecord> trace_;
+    int traced_frames_;
+    int64_t first_tick_;
+
+    int root_zone_;
+
+    static int64_t Now();
+    static double TicksToMs(int64_t ticks);
+    static int Bucket(double ms);
+    static double BucketMs(int bucket);
+
+    double Percentile(const ZoneStats& stats, double fraction) const;
+    std::string SlowPath() const;
+    void WriteSummary(const std::string& filename) const;
+    void WriteTrace(const std::string& filename) const;
+    void EndFrame();
+
+  public:
+    static const double kLimitMs[kLimitNum];
+
+    Profiler();
+
+    int ZoneId(const char* name);
+
+    void Begin(int zone);
+    void End();
+
+    // The frame is the root zone. ProfileFrame calls these.
+    void BeginFrame();
+    void FinishFrame();
+
+    // Time since the current frame started.
+    double FrameMilliseconds() const;
+
+    double GetMeanMilliseconds() const;
+    double GetMaxMilliseconds() const;
+
+    // The last finished frame: its total and the zones just under the root.
+    void DrawZoneTimers(int x, int y) const;
+
+    // Percentiles, limit counts and slow frames as text, and the Chrome trace of the slow frames.
+    void WriteReport(const std::string& summary_file, const std::string& trace_file) const;
+
+    static Profiler& Instance();
+  };
+
+  class ProfileZone {
+  public:
+    explicit ProfileZone(const int zone) { Profiler::Instance().Begin(zone); }
+    ~ProfileZone() { Profiler::Instance().End(); }
+  };
+
+  class ProfileFrame {
+  public:
+    ProfileFrame() { Profiler::Instance().BeginFrame(); }
+    ~ProfileFrame() { Profiler::Instance().FinishFrame(); }
+  };
+}
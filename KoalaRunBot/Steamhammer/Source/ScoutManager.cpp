@@ -393,7 +393,7 @@ void ScoutManager::followPerimeter() {
     }
   }
 
-  the.micro_.Move(_workerScout, fleeTo);
+  the.micro_.MoveSafely(_workerScout, fleeTo);
 }
 
 // Called only when a gas steal is requested.
@@ -21,6 +21,7 @@ Squad::Squad()
     , _meatgrinder(false)
     , _hasAir(false)
     , _hasGround(false)
+    , _groundSize(BWAPI::UnitSizeTypes::Small)
     , _canAttackAir(false)
     , _canAttackGround(false)
     , _attackAtMax(false)
@@ -44,6 +45,7 @@ Squad::Squad(const std::string& name, SquadOrder order, size_t priority)
     , _meatgrinder(false)
     , _hasAir(false)
     , _hasGround(false)
+    , _groundSize(BWAPI::UnitSizeTypes::Small)
     , _canAttackAir(false)
     , _canAttackGround(false)
     , _attackAtMax(false)
@@ -275,7 +277,7 @@ bool Squad::joinUp(const UnitCluster& cluster) {
 void Squad::moveCluster(const UnitCluster& cluster, const BWAPI::Position& destination) {
   for (BWAPI::Unit unit : cluster.units_) {
     if (!UnitUtil::MobilizeUnit(unit)) {
-      the.micro_.Move(unit, destination);
+      the.micro_.MoveSafely(unit, destination);
     }
   }
 }
@@ -305,6 +307,7 @@ void Squad::updateUnits() {
 void Squad::setAllUnits() {
   _hasAir = false;
   _hasGround = false;
+  _groundSize = BWAPI::UnitSizeTypes::Small;
   _canAttackAir = false;
   _canAttackGround = false;
 
@@ -321,6 +324,11 @@ void Squad::setAllUnits() {
       }
       else {
         _hasGround = true;
+        const BWAPI::UnitSizeType size = unit->getType().size();
+        if (size == BWAPI::UnitSizeTypes::Large ||
+          (size == BWAPI::UnitSizeTypes::Medium && _groundSize != BWAPI::UnitSizeTypes::Large)) {
+          _groundSize = size;
+        }
       }
       if (UnitUtil::CanAttackAir(unit)) {
         _canAttackAir = true;
@@ -651,6 +659,13 @@ BWAPI::Position Squad::calcRegroupPosition(const UnitCluster& cluster) const {
     }
   }
   if (regroup != BWAPI::Positions::Origin) {
+    // That unit may be standing in range of enemies we can't see now. Shift to the nearby
+    // tile with the least known threat, if it is any better.
+    const BWAPI::TilePosition start(regroup);
+    const BWAPI::TilePosition safest = the.threat_map_.SafestTile(start, 4, cluster.air_);
+    if (safest != start) {
+      return BWAPI::Position(safest) + BWAPI::Position(16, 16);
+    }
     return regroup;
   }
 
@@ -930,8 +945,7 @@ void Squad::stimIfNeeded() {
       continue;
     }
 
-    BWAPI::Unitset nearbyEnemies;
-    MapGrid::Instance().GetUnits(nearbyEnemies, firebat->getPosition(), 64, false, true);
+    const std::vector<BWAPI::Unit>& nearbyEnemies = MapGrid::Instance().GetUnits(firebat->getPosition(), 64, false, true);
 
     // NOTE We don't check whether the enemy is attackable or worth attacking.
     if (!nearbyEnemies.empty()) {
@@ -951,8 +965,7 @@ void Squad::stimIfNeeded() {
       continue;
     }
 
-    BWAPI::Unitset nearbyEnemies;
-    MapGrid::Instance().GetUnits(nearbyEnemies, marine->getPosition(), 5 * 32, false, true);
+    const std::vector<BWAPI::Unit>& nearbyEnemies = MapGrid::Instance().GetUnits(marine->getPosition(), 5 * 32, false, true);
 
     if (!nearbyEnemies.empty()) {
       the.micro_.Stim(marine);
@@ -32,6 +32,7 @@ namespace KoalaRunBot {
     bool _meatgrinder; // combat sim says "win" even if you do only modest damage
     bool _hasAir;
     bool _hasGround;
+    BWAPI::UnitSizeType _groundSize; // of the largest ground unit
     bool _canAttackAir;
     bool _canAttackGround;
     std::string _regroupStatus;
@@ -124,6 +125,7 @@ namespace KoalaRunBot {
 
     const bool hasAir() const { return _hasAir; };
     const bool hasGround() const { return _hasGround; };
+    BWAPI::UnitSizeType groundSize() const { return _groundSize; };
     const bool canAttackAir() const { return _canAttackAir; };
     const bool canAttackGround() const { return _canAttackGround; };
     const bool hasDetector() const { return !_microDetectors.getUnits().empty(); };
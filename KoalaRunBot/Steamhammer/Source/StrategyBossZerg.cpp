@@ -226,10 +226,14 @@ void StrategyBossZerg::updateArmySizes()
 	PlayerSnapshot me(_self);
 
 	myArmySize = 0;
-	for (const std::pair<BWAPI::UnitType, int> & unitCount : me.getCounts())
+	for (int i = 0; i < me.numIndexes(); ++i)
 	{
-		BWAPI::UnitType type = unitCount.first;
-		int n = unitCount.second;
+		const int n = me.countAt(i);
+		if (n == 0)
+		{
+			continue;
+		}
+		BWAPI::UnitType type = me.typeAt(i);
 
 		if (!type.isBuilding() && !type.isWorker() && type.canAttack())
 		{
@@ -245,10 +249,14 @@ void StrategyBossZerg::updateArmySizes()
 	PlayerSnapshot you(_enemy);
 
 	enemyAntigroundArmySize = 0;
-	for (const std::pair<BWAPI::UnitType, int> & unitCount : you.getCounts())
+	for (int i = 0; i < you.numIndexes(); ++i)
 	{
-		BWAPI::UnitType type = unitCount.first;
-		int n = unitCount.second;
+		const int n = you.countAt(i);
+		if (n == 0)
+		{
+			continue;
+		}
+		BWAPI::UnitType type = you.typeAt(i);
 
 		if (!type.isBuilding() && !type.isWorker() && UnitUtil::TypeCanAttackGround(type))
 		{
@@ -1830,10 +1838,14 @@ void StrategyBossZerg::vProtossTechScores(const PlayerSnapshot & snap)
 		}
 	}
 
-	for (const std::pair<BWAPI::UnitType, int> & unitCount : snap.getCounts())
+	for (int i = 0; i < snap.numIndexes(); ++i)
 	{
-		BWAPI::UnitType type = unitCount.first;
-		int count = unitCount.second;
+		const int count = snap.countAt(i);
+		if (count == 0)
+		{
+			continue;
+		}
+		BWAPI::UnitType type = snap.typeAt(i);
 
 		if (!type.isWorker() && !type.isBuilding() && type != BWAPI::UnitTypes::Protoss_Interceptor)
 		{
@@ -1955,10 +1967,14 @@ void StrategyBossZerg::vTerranTechScores(const PlayerSnapshot & snap)
 		techScores[int(_techTarget)] += 13;
 	}
 
-	for (const std::pair<BWAPI::UnitType, int> & unitCount : snap.getCounts())
+	for (int i = 0; i < snap.numIndexes(); ++i)
 	{
-		BWAPI::UnitType type = unitCount.first;
-		int count = unitCount.second;
+		const int count = snap.countAt(i);
+		if (count == 0)
+		{
+			continue;
+		}
+		BWAPI::UnitType type = snap.typeAt(i);
 
 		if (type == BWAPI::UnitTypes::Terran_Marine ||
 			type == BWAPI::UnitTypes::Terran_Medic ||
@@ -2088,10 +2104,14 @@ void StrategyBossZerg::vZergTechScores(const PlayerSnapshot & snap)
 	// NOTE Nothing decreases the zergling score or increases the hydra score.
 	//      We never go hydra in ZvZ.
 	//      But after getting hive we may go lurkers.
-	for (const std::pair<BWAPI::UnitType, int> & unitCount : snap.getCounts())
+	for (int i = 0; i < snap.numIndexes(); ++i)
 	{
-		BWAPI::UnitType type = unitCount.first;
-		int count = unitCount.second;
+		const int count = snap.countAt(i);
+		if (count == 0)
+		{
+			continue;
+		}
+		BWAPI::UnitType type = snap.typeAt(i);
 
 		if (type == BWAPI::UnitTypes::Zerg_Sunken_Colony)
 		{
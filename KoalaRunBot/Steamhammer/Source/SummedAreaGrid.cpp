@@ -0,0 +1,83 @@
+#include "SummedAreaGrid.h"
+
+#include <algorithm>
+
+using namespace KoalaRunBot;
+
+SummedAreaGrid::SummedAreaGrid()
+	: origin_x_(0)
+	, origin_y_(0)
+	, width_(0)
+	, height_(0)
+{
+}
+
+void SummedAreaGrid::Reset(int origin_x, int origin_y, int width, int height)
+{
+	origin_x_ = origin_x;
+	origin_y_ = origin_y;
+	width_ = std::max(0, width);
+	height_ = std::max(0, height);
+	values_.assign(width_ * height_, 0.0);
+	sums_.assign((width_ + 1) * (height_ + 1), 0.0);
+}
+
+// Convert to window coordinates and clip to the window. Return false if nothing is left.
+bool SummedAreaGrid::ClipRect(int& x1, int& y1, int& x2, int& y2) const
+{
+	x1 = std::max(x1 - origin_x_, 0);
+	y1 = std::max(y1 - origin_y_, 0);
+	x2 = std::min(x2 - origin_x_, width_);
+	y2 = std::min(y2 - origin_y_, height_);
+	return x1 < x2 && y1 < y2;
+}
+
+void SummedAreaGrid::Add(int x, int y, double value)
+{
+	x -= origin_x_;
+	y -= origin_y_;
+	if (x >= 0 && x < width_ && y >= 0 && y < height_)
+	{
+		values_[y * width_ + x] += value;
+	}
+}
+
+void SummedAreaGrid::AddRect(int x1, int y1, int x2, int y2, double value)
+{
+	if (!ClipRect(x1, y1, x2, y2))
+	{
+		return;
+	}
+	for (int y = y1; y < y2; ++y)
+	{
+		for (int x = x1; x < x2; ++x)
+		{
+			values_[y * width_ + x] += value;
+		}
+	}
+}
+
+// sums_ at (x,y) is the total of all values above and to the left of tile (x,y).
+void SummedAreaGrid::Build()
+{
+	const int stride = width_ + 1;
+	for (int y = 0; y < height_; ++y)
+	{
+		double row = 0.0;
+		for (int x = 0; x < width_; ++x)
+		{
+			row += values_[y * width_ + x];
+			sums_[(y + 1) * stride + x + 1] = sums_[y * stride + x + 1] + row;
+		}
+	}
+}
+
+double SummedAreaGrid::Sum(int x1, int y1, int x2, int y2) const
+{
+	if (!ClipRect(x1, y1, x2, y2))
+	{
+		return 0.0;
+	}
+	const int stride = width_ + 1;
+	return sums_[y2 * stride + x2] - sums_[y1 * stride + x2] - sums_[y2 * stride + x1] + sums_[y1 * stride + x1];
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+// Values added into tiles, then summed over any rectangle in constant time, for scoring
+// area of effect spells at every candidate spot.
+// The grid covers a window of the map starting at an origin tile, so that a caller can
+// size it to the area it searches. Coordinates are map tile coordinates; rectangles are
+// half-open [x1,x2) x [y1,y2), and the parts outside the window count as 0.
+// Add values, call Build(), then take sums. Adding after Build() needs another Build().
+
+namespace KoalaRunBot {
+  class SummedAreaGrid {
+    int origin_x_;
+    int origin_y_;
+    int width_;
+    int height_;
+    std::vector<double> values_;
+    std::vector<double> sums_; // (width_+1) x (height_+1), row-major, with a zero row and column
+
+    bool ClipRect(int& x1, int& y1, int& x2, int& y2) const;
+
+  public:
+    SummedAreaGrid();
+
+    // Clear to 0 over the given window. Keeps the storage for reuse.
+    void Reset(int origin_x, int origin_y, int width, int height);
+
+    // Tiles outside the window are ignored.
+    void Add(int x, int y, double value);
+    void AddRect(int x1, int y1, int x2, int y2, double value);
+
+    void Build();
+
+    double Sum(int x1, int y1, int x2, int y2) const;
+  };
+}
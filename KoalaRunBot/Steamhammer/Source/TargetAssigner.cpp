@@ -0,0 +1,168 @@
+#include "TargetAssigner.h"
+
+#include <algorithm>
+
+#include "AttackTable.h"
+#include "UnitUtil.h"
+
+using namespace KoalaRunBot;
+
+const int TargetAssigner::kNoTarget;
+
+// An attacker this close to being in range will fire soon, so its damage counts.
+static const int kImminentRange = 32;
+
+TargetAssigner::TargetAssigner()
+	: frame_(-1)
+{
+}
+
+void TargetAssigner::StartFrame()
+{
+	const int frame = BWAPI::Broodwar->getFrameCount();
+	if (frame != frame_)
+	{
+		frame_ = frame;
+		incoming_.clear();
+	}
+}
+
+void TargetAssigner::Assign(const BWAPI::Unitset& attackers, const BWAPI::Unitset& targets, const ScoreFunction& score,
+                            std::map<BWAPI::Unit, BWAPI::Unit>& assignment)
+{
+	StartFrame();
+
+	attackers_.assign(attackers.begin(), attackers.end());
+	targets_.assign(targets.begin(), targets.end());
+	const size_t nTargets = targets_.size();
+
+	// The damage table depends only on the attacker type, so attackers of a type share a row.
+	types_.clear();
+	attacker_type_.clear();
+	for (BWAPI::Unit attacker : attackers_)
+	{
+		const auto it = std::find(types_.begin(), types_.end(), attacker->getType());
+		attacker_type_.push_back(int(it - types_.begin()));
+		if (it == types_.end())
+		{
+			types_.push_back(attacker->getType());
+		}
+	}
+
+	damage_.resize(types_.size() * nTargets);
+	for (size_t i = 0; i < types_.size(); ++i)
+	{
+		for (size_t t = 0; t < nTargets; ++t)
+		{
+			damage_[i * nTargets + t] = VolleyDamage(BWAPI::Broodwar->self(), types_[i], targets_[t]);
+		}
+	}
+
+	// Score every pair once.
+	scores_.resize(attackers_.size() * nTargets);
+	best_score_.assign(attackers_.size(), kNoTarget);
+	in_range_.assign(attackers_.size(), false);
+	order_.clear();
+	for (size_t a = 0; a < attackers_.size(); ++a)
+	{
+		BWAPI::Unit best = nullptr;
+		for (size_t t = 0; t < nTargets; ++t)
+		{
+			const int s = score(attackers_[a], targets_[t]);
+			scores_[a * nTargets + t] = s;
+			if (s > best_score_[a])
+			{
+				best_score_[a] = s;
+				best = targets_[t];
+			}
+		}
+		in_range_[a] = best && attackers_[a]->isInWeaponRange(best);
+		order_.push_back(int(a));
+	}
+
+	// Attackers whose damage lands first choose first.
+	std::stable_sort(order_.begin(), order_.end(), [this](int a, int b)
+	{
+		if (in_range_[a] != in_range_[b])
+		{
+			return bool(in_range_[a]);
+		}
+		return best_score_[a] > best_score_[b];
+	});
+
+	for (int a : order_)
+	{
+		BWAPI::Unit attacker = attackers_[a];
+
+		// The best target that is not already covered, or failing that the best target.
+		int bestScore = kNoTarget;
+		int bestFreeScore = kNoTarget;
+		int bestTarget = -1;
+		int bestFreeTarget = -1;
+		for (size_t t = 0; t < nTargets; ++t)
+		{
+			const int s = scores_[a * nTargets + t];
+			if (s == kNoTarget)
+			{
+				continue;
+			}
+			if (s > bestScore)
+			{
+				bestScore = s;
+				bestTarget = int(t);
+			}
+			if (s > bestFreeScore && damage_[attacker_type_[a] * nTargets + t] > 0)
+			{
+				BWAPI::Unit target = targets_[t];
+				const int life = target->getHitPoints() + target->getShields();
+				if (life <= 0 || IncomingDamage(target) < life)
+				{
+					bestFreeScore = s;
+					bestFreeTarget = int(t);
+				}
+			}
+		}
+
+		const int choice = bestFreeTarget >= 0 ? bestFreeTarget : bestTarget;
+		if (choice < 0)
+		{
+			assignment[attacker] = nullptr;
+			continue;
+		}
+
+		BWAPI::Unit target = targets_[choice];
+		assignment[attacker] = target;
+		if (attacker->getDistance(target) <= UnitUtil::GetAttackRange(attacker, target) + kImminentRange)
+		{
+			incoming_[target] += damage_[attacker_type_[a] * nTargets + choice];
+		}
+	}
+}
+
+int TargetAssigner::IncomingDamage(BWAPI::Unit target) const
+{
+	if (frame_ != BWAPI::Broodwar->getFrameCount())
+	{
+		return 0;
+	}
+	const auto it = incoming_.find(target);
+	return it == incoming_.end() ? 0 : it->second;
+}
+
+// Shields take full damage, so this slightly underestimates damage to protoss.
+int TargetAssigner::VolleyDamage(BWAPI::Player player, BWAPI::UnitType attacker, BWAPI::Unit target)
+{
+	const BWAPI::WeaponType weapon = UnitUtil::GetWeapon(attacker, target);
+	if (weapon == BWAPI::WeaponTypes::None)
+	{
+		return 0;
+	}
+
+	// player->damage() includes upgrades and the number of hits.
+	int damage = player->damage(weapon) * AttackTable::DamagePercent(weapon.damageType(), target->getType().size()) / 100;
+
+	// Armor applies to each hit, and every hit does at least a little.
+	const int hits = std::max(1, weapon.damageFactor());
+	damage -= hits * target->getPlayer()->armor(target->getType());
+	return std::max(hits, damage);
+}
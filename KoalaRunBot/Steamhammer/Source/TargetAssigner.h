@@ -0,0 +1,55 @@
+#pragma once
+
+#include <climits>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace KoalaRunBot {
+  // Assigns targets to all the attackers of a cluster in one pass.
+  // The micro manager scores each (attacker, target) pair once into a table. Then attackers
+  // choose in order, those already in range first, and each one adds the damage of its next
+  // volley to its target. A target whose hit points and shields are covered by damage on the
+  // way is passed over for the next best one, unless the attacker has no other choice.
+  // The damage bookkeeping lasts for the frame and is shared by all micro managers, so
+  // that the melee units and the ranged units of a squad don't overkill the same target either.
+  class TargetAssigner {
+  public:
+    // Score of the attacker attacking the target, higher is better.
+    // kNoTarget means the attacker should not attack it.
+    typedef std::function<int(BWAPI::Unit attacker, BWAPI::Unit target)> ScoreFunction;
+    static const int kNoTarget = INT_MIN;
+
+  private:
+    int frame_;
+    std::map<BWAPI::Unit, int> incoming_; // expected damage this frame
+
+    // Scratch space, kept to save allocations.
+    std::vector<BWAPI::Unit> attackers_;
+    std::vector<BWAPI::Unit> targets_;
+    std::vector<BWAPI::UnitType> types_;
+    std::vector<int> attacker_type_;      // index into types_
+    std::vector<int> scores_;             // attackers_ x targets_
+    std::vector<int> damage_;             // types_ x targets_
+    std::vector<int> best_score_;         // per attacker
+    std::vector<bool> in_range_;          // per attacker, of its best scoring target
+    std::vector<int> order_;
+
+    void StartFrame();
+
+  public:
+    TargetAssigner();
+
+    // Map each attacker to its target, or to nullptr if it has none.
+    void Assign(const BWAPI::Unitset& attackers, const BWAPI::Unitset& targets, const ScoreFunction& score,
+                std::map<BWAPI::Unit, BWAPI::Unit>& assignment);
+
+    // Damage expected to land on the target soon from attackers assigned this frame.
+    int IncomingDamage(BWAPI::Unit target) const;
+
+    // Damage of one attack against the target, after upgrades, size and armor.
+    static int VolleyDamage(BWAPI::Player player, BWAPI::UnitType attacker, BWAPI::Unit target);
+  };
+}
@@ -7,6 +7,14 @@ void The::Initialize()
     map_partitions_.initialize();
 
     ops_boss_.Initialize();
+
+    attack_table_.Initialize();
+
+    threat_map_.Initialize();
+
+    path_service_.Initialize();
+
+    distance_fields_.Initialize();
 }
 
 The& The::Root()
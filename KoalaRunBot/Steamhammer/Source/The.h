@@ -1,8 +1,13 @@
 #pragma once
 
+#include "AttackTable.h"
+#include "DistanceFields.h"
 #include "MapPartitions.h"
 #include "Micro.h"
 #include "OpsBoss.h"
+#include "PathService.h"
+#include "TargetAssigner.h"
+#include "ThreatMap.h"
 
 namespace KoalaRunBot
 {
@@ -18,6 +23,16 @@ namespace KoalaRunBot
 
         Micro micro_;
 
+        TargetAssigner target_assigner_;
+
+        AttackTable attack_table_;
+
+        ThreatMap threat_map_;
+
+        PathService path_service_;
+
+        DistanceFields distance_fields_;
+
         static The& Root();
     };
 }
@@ -0,0 +1,267 @@
+#include "ThreatMap.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#include "Common.h"
+#include "InformationManager.h"
+#include "MapTools.h"
+#include "The.h"
+#include "UnitUtil.h"
+
+using namespace KoalaRunBot;
+
+// A mobile unit not seen for this long has probably moved on.
+static const int kForgetFrames = 10 * 24;
+
+// Reach beyond weapon range, to allow for the sizes of the attacker and the target.
+static const int kReachMargin = 32;
+
+ThreatMap::ThreatMap()
+	: width_(0)
+	, height_(0)
+	, visit_mark_(0)
+{
+}
+
+void ThreatMap::Initialize()
+{
+	width_ = BWAPI::Broodwar->mapWidth();
+	height_ = BWAPI::Broodwar->mapHeight();
+	air_.assign(width_ * height_, 0);
+	ground_.assign(width_ * height_, 0);
+	visited_.assign(width_ * height_, 0);
+	footprints_.clear();
+}
+
+// The damage of one volley at air or ground targets. Like FAP, count the weapons of the
+// carrier's interceptors, the bunker's marines, and the reaver's scarabs.
+static int VolleyDamage(BWAPI::Player player, BWAPI::UnitType type, bool air)
+{
+	if (type == BWAPI::UnitTypes::Protoss_Carrier)
+	{
+		return 8 * player->damage(BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon());
+	}
+	if (type == BWAPI::UnitTypes::Terran_Bunker)
+	{
+		return 4 * player->damage(BWAPI::WeaponTypes::Gauss_Rifle);
+	}
+	if (type == BWAPI::UnitTypes::Protoss_Reaver)
+	{
+		return air ? 0 : player->damage(BWAPI::WeaponTypes::Scarab);
+	}
+
+	const BWAPI::WeaponType weapon = air ? UnitUtil::GetAirWeapon(type) : UnitUtil::GetGroundWeapon(type);
+	return weapon == BWAPI::WeaponTypes::None ? 0 : player->damage(weapon);
+}
+
+// Return false if the unit poses no threat that we know of.
+// Workers are left out, since they rarely fight, and so are interceptors, which count as
+// part of their carrier.
+bool ThreatMap::MakeFootprint(const UnitInfo& ui, Footprint& footprint) const
+{
+	if (!ui.lastPosition.isValid() ||
+		ui.type.isWorker() ||
+		ui.type == BWAPI::UnitTypes::Protoss_Interceptor ||
+		(!ui.completed && ui.type.isBuilding()))
+	{
+		return false;
+	}
+
+	if (!ui.type.isBuilding() &&
+		(ui.goneFromLastPosition || BWAPI::Broodwar->getFrameCount() - ui.updateFrame > kForgetFrames))
+	{
+		return false;
+	}
+
+	// GameCommander updates the table earlier in the frame, so range upgrades are already counted.
+	const AttackTable& attacks = The::Root().attack_table_;
+	const int airRange = attacks.Range(ui.player, ui.type, true);
+	const int groundRange = attacks.Range(ui.player, ui.type, false);
+	if (airRange == 0 && groundRange == 0)
+	{
+		return false;
+	}
+
+	footprint.center_ = ui.lastPosition;
+	footprint.air_reach_ = airRange ? airRange + kReachMargin : 0;
+	footprint.ground_reach_ = groundRange ? groundRange + kReachMargin : 0;
+	footprint.air_damage_ = airRange ? VolleyDamage(ui.player, ui.type, true) : 0;
+	footprint.ground_damage_ = groundRange ? VolleyDamage(ui.player, ui.type, false) : 0;
+	footprint.current_ = true;
+	return true;
+}
+
+// Add or subtract the value on every tile whose center is within reach of the center.
+void ThreatMap::StampDisk(std::vector<int>& raster, const BWAPI::Position& center, int reach, int value)
+{
+	if (reach <= 0 || value == 0)
+	{
+		return;
+	}
+
+	const int left = std::max(0, (center.x - reach) / 32);
+	const int right = std::min(width_ - 1, (center.x + reach) / 32);
+	const int top = std::max(0, (center.y - reach) / 32);
+	const int bottom = std::min(height_ - 1, (center.y + reach) / 32);
+	const int reach2 = reach * reach;
+
+	for (int x = left; x <= right; ++x)
+	{
+		const int dx = x * 32 + 16 - center.x;
+		for (int y = top; y <= bottom; ++y)
+		{
+			const int dy = y * 32 + 16 - center.y;
+			if (dx * dx + dy * dy <= reach2)
+			{
+				raster[x * height_ + y] += value;
+			}
+		}
+	}
+}
+
+void ThreatMap::Stamp(const Footprint& footprint, int sign)
+{
+	StampDisk(air_, footprint.center_, footprint.air_reach_, sign * footprint.air_damage_);
+	StampDisk(ground_, footprint.center_, footprint.ground_reach_, sign * footprint.ground_damage_);
+}
+
+void ThreatMap::Update()
+{
+	if (width_ == 0 || !BWAPI::Broodwar->enemy())
+	{
+		return;
+	}
+
+	for (auto& kv : footprints_)
+	{
+		kv.second.current_ = false;
+	}
+
+	for (const auto& kv : InformationManager::Instance().getUnitData(BWAPI::Broodwar->enemy()).getUnits())
+	{
+		const UnitInfo& ui = kv.second;
+
+		Footprint wanted;
+		if (!MakeFootprint(ui, wanted))
+		{
+			continue;
+		}
+
+		auto it = footprints_.find(ui.unitID);
+		if (it == footprints_.end())
+		{
+			footprints_[ui.unitID] = wanted;
+			Stamp(wanted, 1);
+			continue;
+		}
+
+		Footprint& old = it->second;
+		if (BWAPI::TilePosition(old.center_) != BWAPI::TilePosition(wanted.center_) ||
+			old.air_reach_ != wanted.air_reach_ ||
+			old.ground_reach_ != wanted.ground_reach_ ||
+			old.air_damage_ != wanted.air_damage_ ||
+			old.ground_damage_ != wanted.ground_damage_)
+		{
+			Stamp(old, -1);
+			old = wanted;
+			Stamp(old, 1);
+		}
+		old.current_ = true;
+	}
+
+	// Erase the units that died or were forgotten.
+	for (auto it = footprints_.begin(); it != footprints_.end(); )
+	{
+		if (it->second.current_)
+		{
+			++it;
+		}
+		else
+		{
+			Stamp(it->second, -1);
+			it = footprints_.erase(it);
+		}
+	}
+}
+
+// Breadth-first search, so the first tile found with the least threat is the nearest.
+// Air units fly, so every tile in the square counts as reachable.
+BWAPI::TilePosition ThreatMap::SafestTile(const BWAPI::TilePosition& start, int radius, bool air) const
+{
+	if (!start.isValid() || width_ == 0)
+	{
+		return start;
+	}
+
+	// Start a new search. Reset the marks if they are about to wrap.
+	if (++visit_mark_ == INT_MAX)
+	{
+		std::fill(visited_.begin(), visited_.end(), 0);
+		visit_mark_ = 1;
+	}
+
+	BWAPI::TilePosition best = start;
+	int bestThreat = At(start, air);
+
+	queue_.clear();
+	queue_.push_back(start);
+	visited_[start.x * height_ + start.y] = visit_mark_;
+
+	for (size_t head = 0; head < queue_.size() && bestThreat > 0; ++head)
+	{
+		const BWAPI::TilePosition tile = queue_[head];
+		for (int dx = -1; dx <= 1; ++dx)
+		{
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				const BWAPI::TilePosition next(tile.x + dx, tile.y + dy);
+				if (!next.isValid() ||
+					std::abs(next.x - start.x) > radius ||
+					std::abs(next.y - start.y) > radius ||
+					visited_[next.x * height_ + next.y] == visit_mark_ ||
+					(!air && !MapTools::Instance().isWalkable(next)))
+				{
+					continue;
+				}
+				visited_[next.x * height_ + next.y] = visit_mark_;
+				queue_.push_back(next);
+
+				const int threat = At(next, air);
+				if (threat < bestThreat)
+				{
+					bestThreat = threat;
+					best = next;
+				}
+			}
+		}
+	}
+
+	return best;
+}
+
+// Ground threat in red above air threat in cyan.
+void ThreatMap::Draw() const
+{
+	if (!Config::Debug::DrawThreatMap)
+	{
+		return;
+	}
+
+	for (int x = 0; x < width_; ++x)
+	{
+		for (int y = 0; y < height_; ++y)
+		{
+			const BWAPI::Position topLeft(BWAPI::TilePosition(x, y));
+			if (ground_[x * height_ + y] > 0)
+			{
+				BWAPI::Broodwar->drawTextMap(topLeft + BWAPI::Position(2, 2), "%c%d", kRed, ground_[x * height_ + y]);
+			}
+			if (air_[x * height_ + y] > 0)
+			{
+				BWAPI::Broodwar->drawTextMap(topLeft + BWAPI::Position(2, 16), "%c%d", kCyan, air_[x * height_ + y]);
+			}
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace KoalaRunBot {
+  struct UnitInfo;
+
+  // Enemy threat to our air units and to our ground units on each tile: the summed damage of
+  // one volley from every enemy that can hit the tile. Enemies are taken from the
+  // InformationManager at their last known positions. A mobile unit drops out when it has not
+  // been seen for a while, or when we look at its last position and it is gone.
+  // Updates are incremental. Each unit's footprint is remembered, and only units that appear,
+  // move to another tile, change range or damage, or disappear are redrawn.
+  // Ranges come from the AttackTable, which must be updated first. Damage is read from the
+  // player's upgrades directly.
+  class ThreatMap {
+    struct Footprint {
+      BWAPI::Position center_;
+      int air_reach_;      // pixels from center_, 0 if it can't hit air
+      int ground_reach_;
+      int air_damage_;
+      int ground_damage_;
+      bool current_;       // still wanted, during an update
+    };
+
+    int width_;
+    int height_;
+    std::vector<int> air_;     // width_ x height_, column-major like Grid
+    std::vector<int> ground_;
+    std::map<int, Footprint> footprints_; // by unit id
+
+    // Scratch space for SafestTile().
+    mutable std::vector<int> visited_;
+    mutable int visit_mark_;
+    mutable std::vector<BWAPI::TilePosition> queue_;
+
+    bool MakeFootprint(const UnitInfo& ui, Footprint& footprint) const;
+    void Stamp(const Footprint& footprint, int sign);
+    void StampDisk(std::vector<int>& raster, const BWAPI::Position& center, int reach, int value);
+
+  public:
+    ThreatMap();
+
+    void Initialize();
+    void Update();
+
+    int Air(const BWAPI::TilePosition& tile) const { return air_[tile.x * height_ + tile.y]; }
+    int Ground(const BWAPI::TilePosition& tile) const { return ground_[tile.x * height_ + tile.y]; }
+    int At(const BWAPI::TilePosition& tile, bool air) const { return air ? Air(tile) : Ground(tile); }
+    int At(const BWAPI::Position& pos, bool air) const { return At(BWAPI::TilePosition(pos), air); }
+
+    // The tile with the least threat within radius tiles of the start that a unit at the start
+    // can get to, by walking for ground units. Of equally safe tiles, the nearest.
+    BWAPI::TilePosition SafestTile(const BWAPI::TilePosition& start, int radius, bool air) const;
+
+    void Draw() const;
+  };
+}
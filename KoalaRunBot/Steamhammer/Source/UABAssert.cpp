@@ -1,5 +1,6 @@
 #include "UABAssert.h"
 #include "Config.h"
+#include "EventLog.h"
 
 using namespace KoalaRunBot;
 
@@ -50,6 +51,10 @@ namespace Assert
         {
             Logger::LogAppendToFile(Config::IO::ErrorLogFilename, ss.str());
         }
+
+        // Record the failure with the events that led up to it.
+        EventLog::Instance().Log(EventSubsystem::General, EventSeverity::Error, 0, line);
+        EventLog::Instance().Dump(std::string("assert ") + file + ":" + std::to_string(line));
     }
 }
 }
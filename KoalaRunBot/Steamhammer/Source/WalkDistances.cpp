@@ -0,0 +1,99 @@
+#include "WalkDistances.h"
+
+#include "The.h"
+
+using namespace KoalaRunBot;
+
+const uint16_t WalkDistances::kUnreachable;
+
+// Step costs, and the pixel length of a straight step.
+static const int kStraightCost = 5;
+static const int kDiagonalCost = 7;
+static const int kStraightPixels = 8;
+
+// More than the largest step cost.
+static const int kBuckets = 8;
+
+WalkDistances::WalkDistances()
+	: width_(0)
+	, height_(0)
+{
+}
+
+WalkDistances::WalkDistances(const BWAPI::WalkPosition& start, BWAPI::UnitSizeType size)
+	: width_(4 * BWAPI::Broodwar->mapWidth())
+	, height_(4 * BWAPI::Broodwar->mapHeight())
+{
+	Compute(start, size);
+}
+
+// The start itself need not be passable. A base's start is inside its resource depot.
+// Costs that would overflow count as unreachable; they are far beyond any real path.
+void WalkDistances::Compute(const BWAPI::WalkPosition& start, BWAPI::UnitSizeType size)
+{
+	cost_.assign(width_ * height_, kUnreachable);
+	if (!start.isValid())
+	{
+		return;
+	}
+
+	const MapPartitions& partitions = The::Root().map_partitions_;
+	const auto open = [&](int x, int y) {
+		return x >= 0 && y >= 0 && x < width_ && y < height_ && partitions.passable(x, y, size);
+	};
+
+	std::vector<int> buckets[kBuckets];
+	cost_[start.y * width_ + start.x] = 0;
+	buckets[0].push_back(start.y * width_ + start.x);
+	size_t pending = 1;
+
+	for (int cost = 0; pending > 0; ++cost)
+	{
+		std::vector<int>& bucket = buckets[cost % kBuckets];
+
+		// Steps cost at least 5, so nothing is added to this bucket while we empty it.
+		for (const int index : bucket)
+		{
+			--pending;
+			if (cost_[index] != cost)
+			{
+				continue;      // reached more cheaply after it was pushed
+			}
+
+			const int x = index % width_;
+			const int y = index / width_;
+			for (int dy = -1; dy <= 1; ++dy)
+			{
+				for (int dx = -1; dx <= 1; ++dx)
+				{
+					if ((dx == 0 && dy == 0) ||
+						!open(x + dx, y + dy) ||
+						(dx != 0 && dy != 0 && !(open(x + dx, y) && open(x, y + dy))))
+					{
+						continue;
+					}
+
+					const int next = cost + (dx != 0 && dy != 0 ? kDiagonalCost : kStraightCost);
+					const int nextIndex = (y + dy) * width_ + x + dx;
+					if (next < cost_[nextIndex])
+					{
+						cost_[nextIndex] = uint16_t(next);
+						buckets[next % kBuckets].push_back(nextIndex);
+						++pending;
+					}
+				}
+			}
+		}
+		bucket.clear();
+	}
+}
+
+int WalkDistances::GetDistance(const BWAPI::WalkPosition& pos) const
+{
+	if (!pos.isValid() || cost_.empty())
+	{
+		return -1;
+	}
+	const int cost = cost_[pos.y * width_ + pos.x];
+	return cost == kUnreachable ? -1 : cost * kStraightPixels / kStraightCost;
+}
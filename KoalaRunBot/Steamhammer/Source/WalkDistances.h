@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace KoalaRunBot {
+  // Ground distances at walk tile resolution (8x8 pixels) from one start, for one unit size.
+  // A closer match to walking distance than GridDistances, which counts Manhattan steps
+  // between whole tiles.
+  // Steps go to all 8 neighbors and cost 5 straight or 7 diagonal, so 5 is 8 pixels. A step
+  // must land on a walk tile that MapPartitions says is passable for the size, and a diagonal
+  // step may not cut a corner.
+  // The search is Dijkstra with a bucket queue. Step costs are at most 7, so a ring of 8
+  // buckets indexed by cost mod 8 does the job of the heap, and each walk tile is handled a
+  // bounded number of times, like BFS. Costs are kept in a flat uint16 array.
+  class WalkDistances {
+    int width_;   // in walk tiles
+    int height_;
+    std::vector<uint16_t> cost_;
+
+    void Compute(const BWAPI::WalkPosition& start, BWAPI::UnitSizeType size);
+
+  public:
+    static const uint16_t kUnreachable = 0xFFFF;
+
+    WalkDistances();
+    WalkDistances(const BWAPI::WalkPosition& start, BWAPI::UnitSizeType size);
+
+    // In pixels, -1 if unreachable.
+    int GetDistance(const BWAPI::WalkPosition& pos) const;
+    int GetDistance(const BWAPI::Position& pos) const { return GetDistance(BWAPI::WalkPosition(pos)); }
+  };
+}
@@ -1,9 +1,15 @@
 #include "WorkerData.h"
+#include "Bases.h"
+#include "EventLog.h"
 #include "Micro.h"
 #include "The.h"
+#include "UnitUtil.h"
 
 using namespace KoalaRunBot;
 
+// Event log ids for the workers subsystem.
+static const int kEventMineralMove = 1; // worker, from depot, to depot, loss, benefit
+
 WorkerData::WorkerData()
 	: the_(The::Root()) {
 	for (const auto unit : BWAPI::Broodwar->getAllUnits()) {
@@ -57,6 +63,7 @@ void WorkerData::DepotDestroyed(const BWAPI::Unit unit) {
 
 	depots_.erase(unit);
 	depot_2_worker_num_.erase(unit);
+	depot_2_mining_model_.erase(unit);
 
 	// re-balance workers in here
 	for (auto& worker : workers_) {
@@ -76,6 +83,12 @@ void WorkerData::AddWorkerNumOfMineralPatch(const BWAPI::Unit mineral_unit, cons
 	}
 }
 
+// A patch we have no entry for has no workers. Don't add an entry by looking.
+int WorkerData::GetMineralPatchWorkerNum(const BWAPI::Unit mineral_unit) const {
+	const auto it = mineral_patch_2_worker_num_.find(mineral_unit);
+	return it == mineral_patch_2_worker_num_.end() ? 0 : it->second;
+}
+
 void WorkerData::SetWorkerJob(const BWAPI::Unit unit, const WorkerJob job, const BWAPI::Unit job_unit) {
 	if (!unit || !unit->exists()) { return; }
 
@@ -265,16 +278,13 @@ bool WorkerData::IsDepotFull(const BWAPI::Unit depot) {
 	return assignedWorkers >= int(Config::Macro::WorkersPerPatch * mineralsNearDepot + 0.5);
 }
 
-//todo use a map to store the minerals near depot, to avoid search every time.
 BWAPI::Unitset WorkerData::FindMineralPatchesNearDepot(const BWAPI::Unit depot) {
-	// if there are minerals near the depot, add them to the set
 	BWAPI::Unitset minerals_near_depot;
 
-	const int radius = 300;
-
-	for (auto& unit : BWAPI::Broodwar->getAllUnits()) {
-		if ((unit->getType() == BWAPI::UnitTypes::Resource_Mineral_Field) && unit->getDistance(depot) < radius) {
-			minerals_near_depot.insert(unit);
+	const MiningModel* model = GetMiningModel(depot);
+	if (model) {
+		for (const MiningModel::PatchModel& patch : model->GetPatches()) {
+			minerals_near_depot.insert(patch.patch_);
 		}
 	}
 
@@ -291,17 +301,64 @@ BWAPI::Unitset WorkerData::FindMineralPatchesNearDepot(const BWAPI::Unit depot)
 }
 
 int WorkerData::ComputeMineralNumNearDepot(const BWAPI::Unit depot) {
-	if (!depot) { return 0; }
+	const MiningModel* model = GetMiningModel(depot);
+
+	return model ? model->GetPatchNum() : 0;
+}
+
+// The mining model is built the first time it is asked for after the depot completes,
+// and kept until the depot is destroyed. Patches are removed as they mine out.
+const MiningModel* WorkerData::GetMiningModel(const BWAPI::Unit depot) {
+	if (!depot) { return nullptr; }
+
+	const auto it = depot_2_mining_model_.find(depot);
+	if (it != depot_2_mining_model_.end()) {
+		return &it->second;
+	}
+
+	if (!depot->exists() || !depot->isCompleted() || !depot->getType().isResourceDepot()) {
+		return nullptr;
+	}
 
-	int mineralsNearDepot = 0;
+	return &depot_2_mining_model_.insert(std::make_pair(depot, MiningModel(depot))).first->second;
+}
+
+void WorkerData::MineralPatchDestroyed(const BWAPI::Unit patch) {
+	for (auto& kv : depot_2_mining_model_) {
+		kv.second.RemovePatch(patch);
+	}
+}
+
+// The predicted income from sending one more worker to the depot, and the patch it should mine.
+// Among patches that gain equally (usually because all are saturated), prefer the least busy,
+// then the shortest trip.
+double WorkerData::ComputeDepotMarginalIncome(const BWAPI::Unit depot, const MiningModel::PatchModel** best_patch) {
+	*best_patch = nullptr;
+
+	const MiningModel* model = GetMiningModel(depot);
+	if (!model) { return 0.0; }
 
-	for (auto& unit : BWAPI::Broodwar->getAllUnits()) {
-		if ((unit->getType() == BWAPI::UnitTypes::Resource_Mineral_Field) && unit->getDistance(depot) < 200) {
-			mineralsNearDepot++;
+	const double epsilon = 1e-9;
+	double best_gain = -1.0;
+	int best_num_assigned = 0;
+
+	for (const MiningModel::PatchModel& patch : model->GetPatches()) {
+		if (!patch.patch_->exists()) {
+			continue;
+		}
+
+		const int num_assigned = GetMineralPatchWorkerNum(patch.patch_);
+		const double gain = MiningModel::MarginalIncome(patch, num_assigned);
+
+		if (gain > best_gain + epsilon ||
+			(gain > best_gain - epsilon && num_assigned < best_num_assigned)) {
+			*best_patch = &patch;
+			best_gain = gain;
+			best_num_assigned = num_assigned;
 		}
 	}
 
-	return mineralsNearDepot;
+	return std::max(0.0, best_gain);
 }
 
 BWAPI::Unit WorkerData::GetWorkerResource(const BWAPI::Unit worker) {
@@ -327,7 +384,8 @@ BWAPI::Unit WorkerData::GetWorkerResource(const BWAPI::Unit worker) {
 	return nullptr;
 }
 
-//two condition:
+// Choose the patch at the worker's depot where it adds the most predicted income.
+// If the depot has no mining model, fall back on two conditions:
 //1.lease workers are assigned to the mineral 
 //2.the mineral is nearest to the worker
 BWAPI::Unit WorkerData::GetOptimalMineralForWorker(const BWAPI::Unit worker) {
@@ -339,15 +397,21 @@ BWAPI::Unit WorkerData::GetOptimalMineralForWorker(const BWAPI::Unit worker) {
 	auto best_dist = 100000;
 	auto best_num_assigned = 10000;
 
+	const MiningModel::PatchModel* best_patch = nullptr;
+	ComputeDepotMarginalIncome(depot, &best_patch);
+	if (best_patch) {
+		return best_patch->patch_;
+	}
+
 	if (depot) {
 		BWAPI::Unitset mineral_patches = FindMineralPatchesNearDepot(depot);
 
 		for (const auto mineral : mineral_patches) {
 			const auto dist = mineral->getDistance(depot);
-			const auto num_assigned = mineral_patch_2_worker_num_[mineral];
+			const auto num_assigned = GetMineralPatchWorkerNum(mineral);
 
 			if (num_assigned < best_num_assigned ||
-				num_assigned == best_num_assigned && dist < best_dist) {
+				(num_assigned == best_num_assigned && dist < best_dist)) {
 				best_mineral = mineral;
 				best_dist = dist;
 				best_num_assigned = num_assigned;
@@ -358,6 +422,83 @@ BWAPI::Unit WorkerData::GetOptimalMineralForWorker(const BWAPI::Unit worker) {
 	return best_mineral;
 }
 
+// A mineral worker can be moved to another patch without losing anything it has already mined.
+bool WorkerData::CanMoveMineralWorker(const BWAPI::Unit worker) const {
+	return
+		worker->isCompleted() &&
+		!worker->isCarryingMinerals() &&
+		(worker->getOrder() == BWAPI::Orders::MoveToMinerals || worker->getOrder() == BWAPI::Orders::WaitForMinerals);
+}
+
+// Move mineral workers from where they add the least predicted income to where they would
+// add the most, within a base or between bases. Predicted income is a sum of concave patch
+// curves, so repeated single moves converge on the best assignment of the current workers.
+// A move must pay back the income lost while the worker walks over.
+// Return the number of workers moved.
+int WorkerData::OptimizeMineralAssignment(const int max_moves) {
+	const int payback_frames = 24 * 60;
+	const double speed = BWAPI::Broodwar->self()->getRace().getWorker().topSpeed();
+
+	int moves = 0;
+	while (moves < max_moves) {
+		// The movable worker whose departure loses the least.
+		BWAPI::Unit donor = nullptr;
+		double donor_loss = 0.0;
+		for (const auto worker : workers_) {
+			if (GetWorkerJob(worker) != kMinerals || !CanMoveMineralWorker(worker)) {
+				continue;
+			}
+			const MiningModel* model = GetMiningModel(GetWorkerDepot(worker));
+			const MiningModel::PatchModel* patch = model ? model->FindPatch(GetWorkerResource(worker)) : nullptr;
+			if (!patch) {
+				continue;
+			}
+			const double loss = MiningModel::MarginalIncome(*patch, GetMineralPatchWorkerNum(patch->patch_) - 1);
+			if (!donor || loss < donor_loss) {
+				donor = worker;
+				donor_loss = loss;
+			}
+		}
+		if (!donor) {
+			break;
+		}
+
+		// The place where it adds the most, after paying for the walk.
+		const BWAPI::Unit donor_depot = GetWorkerDepot(donor);
+		BWAPI::Unit best_depot = nullptr;
+		double best_benefit = 0.0;
+		for (const auto depot : depots_) {
+			const MiningModel* model = GetMiningModel(depot);
+			if (!model ||
+				!UnitUtil::IsCompletedResourceDepot(depot) ||
+				(depot != donor_depot && model->GetBase() && model->GetBase()->inWorkerDanger())) {
+				continue;
+			}
+			const MiningModel::PatchModel* patch = nullptr;
+			const double gain = ComputeDepotMarginalIncome(depot, &patch);
+			if (!patch || patch->patch_ == GetWorkerResource(donor)) {
+				continue;
+			}
+			const double walk_frames = donor->getDistance(patch->patch_) / speed;
+			const double benefit = (gain - donor_loss) * payback_frames - gain * walk_frames;
+			if (benefit > best_benefit) {
+				best_depot = depot;
+				best_benefit = benefit;
+			}
+		}
+		if (!best_depot) {
+			break;
+		}
+
+		EventLog::Instance().Log(EventSubsystem::Workers, EventSeverity::Info, kEventMineralMove,
+			donor->getID(), donor_depot ? donor_depot->getID() : -1, best_depot->getID(), float(donor_loss), float(best_benefit));
+		SetWorkerJob(donor, kMinerals, best_depot);
+		++moves;
+	}
+
+	return moves;
+}
+
 BWAPI::Unit WorkerData::GetWorkerRepairUnit(const BWAPI::Unit unit) {
 	if (!unit) { return nullptr; }
 
@@ -472,15 +613,13 @@ void WorkerData::DrawDepotDebugInfo() {
 			BWAPI::Broodwar->drawTextMap(x, y, "\x04 Workers: %d",
 			                             ComputeAssignedWorkersNum(depot));
 
-		BWAPI::Unitset minerals = FindMineralPatchesNearDepot(depot);
-
-		for (const auto mineral : minerals) {
-			int x = mineral->getPosition().x;
-			int y = mineral->getPosition().y;
-
-			if (mineral_patch_2_worker_num_.find(mineral) != mineral_patch_2_worker_num_.end()) {
-				//if (Config::Debug::DRAW_UALBERTABOT_DEBUG) BWAPI::Broodwar->drawBoxMap(x-2, y-1, x+75, y+14, BWAPI::Colors::Black, true);
-				//if (Config::Debug::DRAW_UALBERTABOT_DEBUG) BWAPI::Broodwar->drawTextMap(x, y, "\x04 Workers: %d", workersOnMineralPatch[mineral]);
+		// Workers and predicted round trip frames for each patch.
+		const MiningModel* model = GetMiningModel(depot);
+		if (model && Config::Debug::DrawWorkerInfo) {
+			for (const MiningModel::PatchModel& patch : model->GetPatches()) {
+				BWAPI::Broodwar->drawTextMap(patch.patch_->getInitialPosition() + BWAPI::Position(-16, 4),
+				                             "%c%d %c%df", kWhite, GetMineralPatchWorkerNum(patch.patch_),
+				                             kGray, patch.trip_frames_);
 			}
 		}
 	}
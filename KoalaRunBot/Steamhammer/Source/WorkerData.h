@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include "MiningModel.h"
 
 namespace KoalaRunBot {
   class The;
@@ -41,9 +42,15 @@ namespace KoalaRunBot {
     std::map<BWAPI::Unit, int> depot_2_worker_num_; // mineral workers per depot
     std::map<BWAPI::Unit, int> refinery_2_worker_num_; // gas workers per refinery
     std::map<BWAPI::Unit, int> mineral_patch_2_worker_num_; // workers per mineral patch
+    std::map<BWAPI::Unit, MiningModel> depot_2_mining_model_; // resource depot -> its patches and trip times
     
     void ClearPreviousJob(BWAPI::Unit unit);
 
+    const MiningModel* GetMiningModel(BWAPI::Unit depot);
+    double ComputeDepotMarginalIncome(BWAPI::Unit depot, const MiningModel::PatchModel** best_patch);
+    bool CanMoveMineralWorker(BWAPI::Unit worker) const;
+    int GetMineralPatchWorkerNum(BWAPI::Unit mineral_unit) const;
+
   public:
 
     WorkerData();
@@ -79,6 +86,8 @@ namespace KoalaRunBot {
 
     int ComputeAssignedWorkersNum(BWAPI::Unit unit);
     BWAPI::Unit GetOptimalMineralForWorker(BWAPI::Unit worker);
+    int OptimizeMineralAssignment(int max_moves);
+    void MineralPatchDestroyed(BWAPI::Unit patch);
 
     enum WorkerJob GetWorkerJob(BWAPI::Unit unit);
     BWAPI::Unit GetWorkerResource(BWAPI::Unit worker);
@@ -39,6 +39,13 @@ void WorkerManager::update()
 	worker_data_.DrawDepotDebugInfo();
 }
 
+// Shift a couple of mineral workers toward higher predicted income.
+// The frame scheduler calls this about every 2 seconds.
+void WorkerManager::rebalanceMineralWorkers()
+{
+	worker_data_.OptimizeMineralAssignment(2);
+}
+
 // Adjust worker jobs. This is done first, before handling each job.
 // NOTE A mineral worker may go briefly idle after collecting minerals.
 // That's OK; we don't change its status then.
@@ -889,6 +896,7 @@ void WorkerManager::onUnitDestroy(BWAPI::Unit unit)
 
 	if (unit->getType() == BWAPI::UnitTypes::Resource_Mineral_Field)
 	{
+		worker_data_.MineralPatchDestroyed(unit);
 		rebalanceWorkers();
 	}
 }
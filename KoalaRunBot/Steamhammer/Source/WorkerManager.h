@@ -37,6 +37,7 @@ namespace KoalaRunBot {
   public:
 
     void update();
+    void rebalanceMineralWorkers();
     void onUnitDestroy(BWAPI::Unit unit);
     void onUnitMorph(BWAPI::Unit unit);
     void onUnitShow(BWAPI::Unit unit);